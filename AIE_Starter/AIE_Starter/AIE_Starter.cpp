@@ -33,23 +33,47 @@ Creating a Pathing Agent
 */
 
 
+#ifndef AIFG_HEADLESS
 #include "raylib.h"
 
 #define RAYGUI_IMPLEMENTATION
 #define RAYGUI_SUPPORT_ICONS
 #include "raygui.h"
+#endif
 #include "Pathfinding.h"
-#include <string>;
-//#include "memory.h"
+#include <string>
 #include "NodeMap.h"
 #include <iostream>
 #include "PathAgent.h"
+#include "Benchmark.h"
+#include "Simulation.h"
+#include "JumpPointSearch.h"
+#include "AnyAngleSearch.h"
+#include "PathScheduler.h"
+#include "MapLoader.h"
+#include "DStarLite.h"
+#include "TraceReplay.h"
+// Last, so only this file's own allocations are tagged with their call sites
+#include "memory.h"
 
 using namespace std;
 using namespace AIForGames;
 
 int main(int argc, char* argv[])
 {
+	// Run the pathfinding benchmarks in the console instead of the demo if asked to on the command line
+	if (argc > 1 && string(argv[1]) == "--benchmark") {
+		return RunBenchmarks(argc, argv);
+	}
+
+	// Headless builds have no window to open, so they always run the simulation; windowed builds run it when asked to with --headless
+#ifdef AIFG_HEADLESS
+	return RunSimulation(argc, argv);
+#else
+	if (argc > 1 && string(argv[1]) == "--headless") {
+		return RunSimulation(argc, argv);
+	}
+
 	// Initialization
 	//--------------------------------------------------------------------------------------
 	int screenWidth = 800;
@@ -94,15 +118,82 @@ int main(int argc, char* argv[])
 	Node* start = map->GetNode(1, 1);
 	// Set the target point (the end destination) equal to the Node* in column index 10, row index 2
 	Node* end = map->GetNode(10, 2);
+
+	// "--map <file>" loads an ascii or Moving AI map file instead, with the search running from its first open cell to its last
+	if (argc > 2 && string(argv[1]) == "--map") {
+		MapLoader loader;
+		if (loader.Load(argv[2], *map, 50)) {
+			cout << "Loaded " << argv[2] << " (" << map->GetWidth() << "x" << map->GetHeight() << ") in " << loader.GetMilliseconds() << " ms, " << loader.GetMalformedRowCount() << " malformed rows." << endl;
+			start = nullptr;
+			end = nullptr;
+			for (int id = 0; id < map->GetNodeCount(); id++) {
+				if (map->GetNodeById(id) != nullptr) {
+					start = start != nullptr ? start : map->GetNodeById(id);
+					end = map->GetNodeById(id);
+				}
+			}
+			if (start == nullptr) {
+				cout << "The map has no open cells for the agent to stand on." << endl;
+				CloseWindow();
+				delete map;
+				return 1;
+			}
+		}
+		else {
+			cout << loader.GetError() << endl;
+		}
+	}
 	// Find the vector of nodes that constitute the Dijkstra path between (1, 1) and (10, 2)
-	vector<Node*> nodeMapPath = map->DijkstraSearch(start, end);
+	SearchContext searchContext(map->GetNodeCount());
+	vector<Node*> nodeMapPath = map->DijkstraSearch(start, end, searchContext);
 	cout << "The Dijkstra path consists of " << nodeMapPath.size() << " nodes." << endl;
+	cout << "Dijkstra expanded " << searchContext.GetStats().nodesExpanded << " nodes in " << searchContext.GetStats().milliseconds << " ms." << endl;
+
+	// The same query with A* and a Manhattan distance heuristic, for comparison
+	map->AStarSearch<ManhattanHeuristic>(start, end, searchContext);
+	cout << "A* (Manhattan) expanded " << searchContext.GetStats().nodesExpanded << " nodes in " << searchContext.GetStats().milliseconds << " ms." << endl;
+
+	// And searching from both ends at once, which needs a second context for the backward half
+	SearchContext backwardContext(map->GetNodeCount());
+	vector<Node*> bidirectionalPath = map->BidirectionalSearch<ZeroHeuristic>(start, end, searchContext, backwardContext);
+	cout << "Bidirectional Dijkstra expanded " << searchContext.GetStats().nodesExpanded << " nodes in " << searchContext.GetStats().milliseconds << " ms, for a path of " << bidirectionalPath.size() << " nodes." << endl;
+
+	// And with Jump Point Search, which returns only the corners of the path
+	JumpPointSearch jumpPointSearch(*map);
+	vector<Node*> jumpPath = jumpPointSearch.FindPath(start, end, searchContext);
+	cout << "Jump Point Search expanded " << searchContext.GetStats().nodesExpanded << " nodes in " << searchContext.GetStats().milliseconds << " ms, for a path of " << jumpPath.size() << " waypoints." << endl;
+
+	// And with Lazy Theta*, whose paths cut across open ground at any angle
+	AnyAngleSearch anyAngleSearch(*map);
+	vector<Node*> anyAnglePath = anyAngleSearch.FindPath(start, end, searchContext);
+	cout << "Lazy Theta* expanded " << searchContext.GetStats().nodesExpanded << " nodes in " << searchContext.GetStats().milliseconds << " ms, for a path of " << anyAnglePath.size() << " waypoints." << endl;
 
 	PathAgent agent;
+	agent.SetMap(map);
 	agent.SetNode(start);
 	agent.SetSpeed(64);
 
+	// Repairs the agent's path when the map is edited during the demo, instead of searching again from nothing
+	DStarLite planner(*map);
+
+	// Clicks are searched a slice at a time, at most this many nodes a frame, so a long search on a big map never holds a frame up.
+	// The agent keeps walking its old path until the new one is ready.
+	PathScheduler scheduler(*map);
+	const int searchBudgetPerFrame = 5000;
+
 	// map->Print(nodeMapPath);
+
+	// Replays of recorded search traces: "--replay <file>" plays back a trace file from the start, and pressing T during the demo replays the last search
+	TraceReplay replay;
+	if (argc > 2 && string(argv[1]) == "--replay") {
+		vector<TraceEvent> events;
+		if (SearchTrace::Load(argv[2], events)) {
+			replay.Start(events, map->GetNodeCount());
+		}
+		else {
+			cout << "Could not read the trace file " << argv[2] << endl;
+		}
+	}
 	
 	// Time at commencement of pathfinding
 	float time = (float)GetTime();
@@ -131,8 +222,8 @@ int main(int argc, char* argv[])
 		if (IsMouseButtonPressed(0)) {
 			Vector2 mousePos = GetMousePosition();
 			end = map->GetClosestNode(glm::vec2(mousePos.x, mousePos.y));
-			// On mouse click, set the agent's current node = the nearest node to its current world position
-			agent.GoToNode(end);
+			// On mouse click, ask for a path from the agent's current node to the clicked one
+			agent.GoToNode(end, scheduler);
 		}
 
 		// ----- This code is just for demonstrating moving the path's origin -----
@@ -153,10 +244,38 @@ int main(int argc, char* argv[])
 		//	nodeMapPath = NodeMap::DijkstraSearch(start, end);
 		//}
 
+		// Right click opens or closes the clicked cell, like a door, and the agent's path to its destination is repaired around it
+		if (IsMouseButtonPressed(1)) {
+			Vector2 mousePos = GetMousePosition();
+			int cellX = (int)(mousePos.x / map->GetCellSize());
+			int cellY = (int)(mousePos.y / map->GetCellSize());
+			map->SetTileWalkable(cellX, cellY, !map->IsWalkable(cellX, cellY));
+
+			Node* agentNode = map->GetClosestNode(agent.GetAgentPosition());
+			if (agentNode != nullptr && end != nullptr) {
+				// The repaired path replaces anything the scheduler was still searching for
+				scheduler.Cancel(&agent);
+				agent.SetPath(planner.FindPath(agentNode, end));
+			}
+		}
+
+		scheduler.Update(searchBudgetPerFrame);
 		map->DrawPath(agent.GetPath());
 		agent.Update(deltaTime);
 		agent.Draw();
 
+		// Searches only record trace events when tracing is compiled in (AIFG_TRACE_LEVEL), otherwise there is nothing to replay
+		if (IsKeyPressed(KEY_T)) {
+			vector<TraceEvent> events = SearchTrace::Global().Snapshot();
+			SearchTrace::Save("search_trace.bin", events);
+			replay.Start(events, map->GetNodeCount());
+		}
+
+		if (replay.IsPlaying()) {
+			replay.Update(deltaTime);
+			replay.Draw(*map);
+		}
+
 		EndDrawing();
 
 		//----------------------------------------------------------------------------------
@@ -171,4 +290,5 @@ int main(int argc, char* argv[])
 	map = nullptr;	
 
 	return 0;
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,273 @@
+#include "AgentSystem.h"
+#include "ThreadPool.h"
+#ifndef AIFG_HEADLESS
+#include "raylib.h"
+#endif
+#include <cmath>
+
+// The widest instruction set the compiler has been allowed to use (/arch:AVX or /arch:AVX2 on MSVC, -mavx on gcc and clang). 64-bit builds always have SSE2.
+#if defined(__AVX__)
+#include <immintrin.h>
+#define AIFG_AGENT_SIMD_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AIFG_AGENT_SIMD_SSE2
+#endif
+
+namespace AIForGames {
+	namespace {
+		// Distances are never divided by anything smaller than this, so an agent already standing on its waypoint doesn't make a NaN
+		const float minimumDistance = 1e-6f;
+
+		// Agents per task when the update is split across a thread pool (a multiple of eight, so no chunk splits a SIMD block)
+		const int agentsPerTask = 8192;
+	}
+
+	AgentSystem::AgentSystem() {};
+
+	AgentSystem::~AgentSystem() {};
+
+	int AgentSystem::AddAgent(glm::vec2 position, float speed) {
+		m_positionX.push_back(position.x);
+		m_positionY.push_back(position.y);
+		m_velocityX.push_back(0.0f);
+		m_velocityY.push_back(0.0f);
+		m_speeds.push_back(speed);
+		m_targetX.push_back(position.x);
+		m_targetY.push_back(position.y);
+		m_leftover.push_back(-1.0f);
+		m_paths.push_back(std::vector<glm::vec2>());
+		m_waypointIndices.push_back(0);
+		return (int)m_positionX.size() - 1;
+	};
+
+	int AgentSystem::GetAgentCount() const {
+		return (int)m_positionX.size();
+	};
+
+	void AgentSystem::SetPath(int agent, const std::vector<Node*>& path) {
+		std::vector<glm::vec2> waypoints;
+		waypoints.reserve(path.size());
+		for (Node* node : path) {
+			if (node != nullptr) {
+				waypoints.push_back(node->position);
+			}
+		}
+		SetPath(agent, waypoints);
+	};
+
+	void AgentSystem::SetPath(int agent, const std::vector<glm::vec2>& waypoints) {
+		m_paths[agent] = waypoints;
+		m_waypointIndices[agent] = 0;
+		SetTarget(agent);
+	};
+
+	void AgentSystem::SetTarget(int agent) {
+		const std::vector<glm::vec2>& path = m_paths[agent];
+		int index = m_waypointIndices[agent];
+		if (index < (int)path.size()) {
+			m_targetX[agent] = path[index].x;
+			m_targetY[agent] = path[index].y;
+		}
+		else {
+			m_targetX[agent] = m_positionX[agent];
+			m_targetY[agent] = m_positionY[agent];
+		}
+	};
+
+	void AgentSystem::MoveScalar(int first, int last, float deltaTime) {
+		// Every operation here is done in the same order as the SIMD version, so the two give exactly the same floats
+		for (int i = first; i < last; i++) {
+			float dx = m_targetX[i] - m_positionX[i];
+			float dy = m_targetY[i] - m_positionY[i];
+			float distance = std::sqrt(dx * dx + dy * dy);
+			float step = m_speeds[i] * deltaTime;
+			float inverseDistance = 1.0f / (distance > minimumDistance ? distance : minimumDistance);
+			float directionX = dx * inverseDistance;
+			float directionY = dy * inverseDistance;
+
+			m_velocityX[i] = directionX * m_speeds[i];
+			m_velocityY[i] = directionY * m_speeds[i];
+
+			// Either this tick's step reaches the waypoint, and the agent stops on it with some movement left over, or it just moves the step towards it
+			if (step >= distance) {
+				m_positionX[i] = m_targetX[i];
+				m_positionY[i] = m_targetY[i];
+				m_leftover[i] = step - distance;
+			}
+			else {
+				m_positionX[i] = m_positionX[i] + directionX * step;
+				m_positionY[i] = m_positionY[i] + directionY * step;
+				m_leftover[i] = -1.0f;
+			}
+		}
+	};
+
+	void AgentSystem::MoveSimd(int first, int last, float deltaTime) {
+		int i = first;
+
+#if defined(AIFG_AGENT_SIMD_AVX)
+		const __m256 minimum = _mm256_set1_ps(minimumDistance);
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 minusOne = _mm256_set1_ps(-1.0f);
+		const __m256 time = _mm256_set1_ps(deltaTime);
+		for (; i + 8 <= last; i += 8) {
+			__m256 positionX = _mm256_loadu_ps(&m_positionX[i]);
+			__m256 positionY = _mm256_loadu_ps(&m_positionY[i]);
+			__m256 targetX = _mm256_loadu_ps(&m_targetX[i]);
+			__m256 targetY = _mm256_loadu_ps(&m_targetY[i]);
+			__m256 speed = _mm256_loadu_ps(&m_speeds[i]);
+
+			__m256 dx = _mm256_sub_ps(targetX, positionX);
+			__m256 dy = _mm256_sub_ps(targetY, positionY);
+			__m256 distance = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+			__m256 step = _mm256_mul_ps(speed, time);
+			__m256 inverseDistance = _mm256_div_ps(one, _mm256_max_ps(distance, minimum));
+			__m256 directionX = _mm256_mul_ps(dx, inverseDistance);
+			__m256 directionY = _mm256_mul_ps(dy, inverseDistance);
+
+			_mm256_storeu_ps(&m_velocityX[i], _mm256_mul_ps(directionX, speed));
+			_mm256_storeu_ps(&m_velocityY[i], _mm256_mul_ps(directionY, speed));
+
+			// Work out both outcomes for every lane, then pick each lane's with the mask of agents that reached their waypoint
+			__m256 arrived = _mm256_cmp_ps(step, distance, _CMP_GE_OQ);
+			__m256 movedX = _mm256_add_ps(positionX, _mm256_mul_ps(directionX, step));
+			__m256 movedY = _mm256_add_ps(positionY, _mm256_mul_ps(directionY, step));
+			_mm256_storeu_ps(&m_positionX[i], _mm256_blendv_ps(movedX, targetX, arrived));
+			_mm256_storeu_ps(&m_positionY[i], _mm256_blendv_ps(movedY, targetY, arrived));
+			_mm256_storeu_ps(&m_leftover[i], _mm256_blendv_ps(minusOne, _mm256_sub_ps(step, distance), arrived));
+		}
+#elif defined(AIFG_AGENT_SIMD_SSE2)
+		const __m128 minimum = _mm_set1_ps(minimumDistance);
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 minusOne = _mm_set1_ps(-1.0f);
+		const __m128 time = _mm_set1_ps(deltaTime);
+		for (; i + 4 <= last; i += 4) {
+			__m128 positionX = _mm_loadu_ps(&m_positionX[i]);
+			__m128 positionY = _mm_loadu_ps(&m_positionY[i]);
+			__m128 targetX = _mm_loadu_ps(&m_targetX[i]);
+			__m128 targetY = _mm_loadu_ps(&m_targetY[i]);
+			__m128 speed = _mm_loadu_ps(&m_speeds[i]);
+
+			__m128 dx = _mm_sub_ps(targetX, positionX);
+			__m128 dy = _mm_sub_ps(targetY, positionY);
+			__m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+			__m128 step = _mm_mul_ps(speed, time);
+			__m128 inverseDistance = _mm_div_ps(one, _mm_max_ps(distance, minimum));
+			__m128 directionX = _mm_mul_ps(dx, inverseDistance);
+			__m128 directionY = _mm_mul_ps(dy, inverseDistance);
+
+			_mm_storeu_ps(&m_velocityX[i], _mm_mul_ps(directionX, speed));
+			_mm_storeu_ps(&m_velocityY[i], _mm_mul_ps(directionY, speed));
+
+			// SSE2 has no blend instruction, so each lane's outcome is picked with and / andnot / or against the mask
+			__m128 arrived = _mm_cmpge_ps(step, distance);
+			__m128 movedX = _mm_add_ps(positionX, _mm_mul_ps(directionX, step));
+			__m128 movedY = _mm_add_ps(positionY, _mm_mul_ps(directionY, step));
+			_mm_storeu_ps(&m_positionX[i], _mm_or_ps(_mm_and_ps(arrived, targetX), _mm_andnot_ps(arrived, movedX)));
+			_mm_storeu_ps(&m_positionY[i], _mm_or_ps(_mm_and_ps(arrived, targetY), _mm_andnot_ps(arrived, movedY)));
+			_mm_storeu_ps(&m_leftover[i], _mm_or_ps(_mm_and_ps(arrived, _mm_sub_ps(step, distance)), _mm_andnot_ps(arrived, minusOne)));
+		}
+#endif
+
+		// Whatever doesn't fill a whole SIMD block (or everything, without SIMD)
+		MoveScalar(i, last, deltaTime);
+	};
+
+	void AgentSystem::AdvanceWaypoints(int first, int last) {
+		for (int i = first; i < last; i++) {
+			// Most agents are still on their way to their waypoint, and agents that have finished their path stand still
+			if (m_leftover[i] < 0.0f || m_waypointIndices[i] >= (int)m_paths[i].size()) {
+				continue;
+			}
+
+			// Carry the movement left over on towards the following waypoints, the way PathAgent carries its overshoot
+			const std::vector<glm::vec2>& path = m_paths[i];
+			float leftover = m_leftover[i];
+			float x = m_positionX[i];
+			float y = m_positionY[i];
+			int index = m_waypointIndices[i] + 1;
+			while (index < (int)path.size()) {
+				float dx = path[index].x - x;
+				float dy = path[index].y - y;
+				float distance = std::sqrt(dx * dx + dy * dy);
+				if (leftover < distance) {
+					x += dx / distance * leftover;
+					y += dy / distance * leftover;
+					break;
+				}
+				x = path[index].x;
+				y = path[index].y;
+				leftover -= distance;
+				index++;
+			}
+
+			m_positionX[i] = x;
+			m_positionY[i] = y;
+			m_waypointIndices[i] = index;
+			SetTarget(i);
+		}
+	};
+
+	void AgentSystem::Update(float deltaTime, ThreadPool* pool) {
+		const int agentCount = GetAgentCount();
+		if (pool == nullptr || pool->GetThreadCount() <= 1 || agentCount <= agentsPerTask) {
+			MoveSimd(0, agentCount, deltaTime);
+			AdvanceWaypoints(0, agentCount);
+			return;
+		}
+
+		// Each chunk only touches its own agents' entries in the arrays, so the chunks need no locking
+		std::vector<ThreadPool::Task> tasks;
+		for (int first = 0; first < agentCount; first += agentsPerTask) {
+			int last = first + agentsPerTask < agentCount ? first + agentsPerTask : agentCount;
+			tasks.push_back([this, first, last, deltaTime](int worker) {
+				MoveSimd(first, last, deltaTime);
+				AdvanceWaypoints(first, last);
+			});
+		}
+		pool->Submit(tasks);
+		pool->Wait();
+	};
+
+	void AgentSystem::UpdateScalar(float deltaTime) {
+		MoveScalar(0, GetAgentCount(), deltaTime);
+		AdvanceWaypoints(0, GetAgentCount());
+	};
+
+	glm::vec2 AgentSystem::GetPosition(int agent) const {
+		return glm::vec2(m_positionX[agent], m_positionY[agent]);
+	};
+
+	glm::vec2 AgentSystem::GetVelocity(int agent) const {
+		return glm::vec2(m_velocityX[agent], m_velocityY[agent]);
+	};
+
+	bool AgentSystem::IsMoving(int agent) const {
+		return m_waypointIndices[agent] < (int)m_paths[agent].size();
+	};
+
+	const char* AgentSystem::GetSimdName() {
+#if defined(AIFG_AGENT_SIMD_AVX)
+		return "AVX";
+#elif defined(AIFG_AGENT_SIMD_SSE2)
+		return "SSE2";
+#else
+		return "scalar";
+#endif
+	};
+
+#ifndef AIFG_HEADLESS
+	void AgentSystem::Draw() const {
+		Color agentColour;
+		agentColour.a = 255;
+		agentColour.r = 255;
+		agentColour.g = 0;
+		agentColour.b = 255;
+
+		for (int i = 0; i < GetAgentCount(); i++) {
+			DrawCircle((int)m_positionX[i], (int)m_positionY[i], 8, agentColour);
+		}
+	};
+#endif
+}
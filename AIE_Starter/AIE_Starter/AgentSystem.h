@@ -0,0 +1,76 @@
+#pragma once
+#include "Pathfinding.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace AIForGames {
+	class ThreadPool;
+
+	// Moves a large number of path-following agents at once, for crowds far bigger than one PathAgent object per agent can keep up with.
+	// The agents are kept as a structure of arrays: one array of x positions, one of y positions, one of speeds and so on, indexed by agent number.
+	// The step that moves every agent towards its current waypoint then reads the arrays straight through, several agents per SIMD instruction
+	// (eight with AVX, four with SSE2), and only the few agents that reach a waypoint this tick go on to the scalar code that picks their next one.
+	// Waypoints are copied out of the Nodes when a path is set, so moving never touches a Node.
+	class AgentSystem
+	{
+		// Where each agent is, and the velocity it moved at on the last tick
+		std::vector<float> m_positionX;
+		std::vector<float> m_positionY;
+		std::vector<float> m_velocityX;
+		std::vector<float> m_velocityY;
+		std::vector<float> m_speeds;
+
+		// The waypoint each agent is heading for, copied from its path so the movement step doesn't have to look the path up
+		std::vector<float> m_targetX;
+		std::vector<float> m_targetY;
+
+		// Written by the movement step: how much of this tick's movement was left over when the agent reached its waypoint (-1 if it didn't)
+		std::vector<float> m_leftover;
+
+		// Each agent's path, and the index of the waypoint it's heading for (the path's length once it has arrived)
+		std::vector<std::vector<glm::vec2>> m_paths;
+		std::vector<int> m_waypointIndices;
+
+		// Move agents [first, last) towards their targets: the vectorised step, and the plain one the vectorised step has to match exactly
+		void MoveSimd(int first, int last, float deltaTime);
+		void MoveScalar(int first, int last, float deltaTime);
+
+		// Send agents [first, last) that reached their waypoint on to the next one, spending what's left of their movement on the way
+		void AdvanceWaypoints(int first, int last);
+
+		// Aim the agent at the waypoint it's up to, or at where it's standing if it has finished its path
+		void SetTarget(int agent);
+
+	public:
+		AgentSystem();
+		~AgentSystem();
+
+		// Add an agent standing at the position, with the speed it moves at in units per second. Returns its agent number.
+		int AddAgent(glm::vec2 position, float speed);
+		int GetAgentCount() const;
+
+		// Give the agent a path to follow, from its first node (the agent moves there first if it isn't already on it)
+		void SetPath(int agent, const std::vector<Node*>& path);
+		void SetPath(int agent, const std::vector<glm::vec2>& waypoints);
+
+		// Move every agent along its path. With a pool the agents are split into chunks that move on all of its threads at once.
+		void Update(float deltaTime, ThreadPool* pool = nullptr);
+
+		// The same tick one agent at a time without SIMD, as the reference the vectorised Update is checked against
+		void UpdateScalar(float deltaTime);
+
+		glm::vec2 GetPosition(int agent) const;
+		glm::vec2 GetVelocity(int agent) const;
+
+		// True until the agent reaches the end of its path
+		bool IsMoving(int agent) const;
+
+		// The name of the instruction set the movement step was compiled for
+		static const char* GetSimdName();
+
+#ifndef AIFG_HEADLESS
+		// Draw every agent as a dot, the same colour as PathAgent
+		void Draw() const;
+#endif
+	};
+}
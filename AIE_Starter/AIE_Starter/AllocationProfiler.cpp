@@ -0,0 +1,440 @@
+#include "AllocationProfiler.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <cstdio>
+#include <new>
+#include <string>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__) || defined(__APPLE__)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#endif
+
+// The address the current function will return to, for telling untagged call sites apart
+#if defined(_MSC_VER)
+#include <intrin.h>
+#pragma intrinsic(_ReturnAddress)
+#define AIFG_RETURN_ADDRESS() _ReturnAddress()
+#elif defined(__GNUC__)
+#define AIFG_RETURN_ADDRESS() __builtin_return_address(0)
+#else
+#define AIFG_RETURN_ADDRESS() nullptr
+#endif
+
+namespace AIForGames {
+	namespace {
+		// The first two sites are kept for allocations that don't have a site of their own: ones past the end of the table, and ones the compiler couldn't give a caller for
+		const int otherSitesIndex = 0;
+		const int untaggedIndex = 1;
+
+		// How many slots a shard's table starts with (it doubles whenever it gets half full)
+		const size_t initialShardCapacity = 256;
+
+		// Mix the bits of an address or a site, so neighbouring blocks land in different shards and slots
+		unsigned long long Mix(unsigned long long value) {
+			value ^= value >> 33;
+			value *= 0xff51afd7ed558ccdull;
+			value ^= value >> 33;
+			value *= 0xc4ceb9fe1a85ec53ull;
+			value ^= value >> 33;
+			return value;
+		};
+
+		// Just the file's name, without the folders
+		const char* FileName(const char* path) {
+			const char* name = path;
+			for (const char* c = path; *c != '\0'; c++) {
+				if (*c == '/' || *c == '\\') {
+					name = c + 1;
+				}
+			}
+			return name;
+		};
+
+		// Where an untagged site's caller is, as the module it's in and how far into it (addr2line -f -C -e <module> <offset>, or the debugger, turns that into a function and line).
+		// If the module exports the function, its name is put in 'function' too.
+		std::string CallerName(const void* caller, std::string& function) {
+			char offset[32];
+#ifdef _WIN32
+			HMODULE module = nullptr;
+			char path[MAX_PATH];
+			if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, (LPCSTR)caller, &module) && GetModuleFileNameA(module, path, MAX_PATH) > 0) {
+				std::snprintf(offset, sizeof(offset), "+0x%llx", (unsigned long long)((size_t)caller - (size_t)module));
+				return std::string(FileName(path)) + offset;
+			}
+#elif defined(__linux__) || defined(__APPLE__)
+			Dl_info info;
+			if (dladdr(caller, &info) != 0 && info.dli_fname != nullptr) {
+				if (info.dli_sname != nullptr) {
+					int status = 0;
+					char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+					function = status == 0 ? demangled : info.dli_sname;
+					std::free(demangled);
+				}
+				std::snprintf(offset, sizeof(offset), "+0x%llx", (unsigned long long)((size_t)caller - (size_t)info.dli_fbase));
+				return std::string(FileName(info.dli_fname)) + offset;
+			}
+#endif
+			std::snprintf(offset, sizeof(offset), "0x%llx", (unsigned long long)(size_t)caller);
+			return offset;
+		};
+
+		// The calling thread's counters. A plain pointer, so reading it never runs a thread_local constructor (which could allocate).
+		thread_local void* threadCounters = nullptr;
+	}
+
+	AllocationProfiler::AllocationProfiler() : m_siteCount(2), m_threads(nullptr), m_recording(true) {
+		for (Site& site : m_sites) {
+			site.state.store(0, std::memory_order_relaxed);
+		}
+		m_sites[otherSitesIndex].file = "(other sites)";
+		m_sites[otherSitesIndex].function = "";
+		m_sites[otherSitesIndex].line = 0;
+		m_sites[otherSitesIndex].caller = nullptr;
+		m_sites[otherSitesIndex].state.store(2, std::memory_order_release);
+		m_sites[untaggedIndex].file = "(untagged new)";
+		m_sites[untaggedIndex].function = "";
+		m_sites[untaggedIndex].line = 0;
+		m_sites[untaggedIndex].caller = nullptr;
+		m_sites[untaggedIndex].state.store(2, std::memory_order_release);
+
+		for (Shard& shard : m_shards) {
+			shard.blocks = nullptr;
+			shard.capacity = 0;
+			shard.count = 0;
+		}
+	};
+
+	AllocationProfiler& AllocationProfiler::Global() {
+		// Made in malloc'd memory and never destroyed, since operator delete can still be called after every static has been destroyed
+		static AllocationProfiler* profiler = new (std::malloc(sizeof(AllocationProfiler))) AllocationProfiler();
+		return *profiler;
+	};
+
+	int AllocationProfiler::FindSite(const AllocationSite& site) {
+		// Sites are told apart by the addresses of their file and function names, which each file's compiled code shares, and the line (or, untagged, by the caller)
+		const unsigned long long hash = Mix((unsigned long long)(size_t)site.file * 31 + (unsigned long long)(size_t)site.function * 17 + (unsigned long long)site.line
+			+ (unsigned long long)(size_t)site.caller * 13);
+		for (int probe = 0; probe < MaxSites; probe++) {
+			const int index = (int)((hash + probe) & (MaxSites - 1));
+			if (index == otherSitesIndex || index == untaggedIndex) {
+				continue;
+			}
+			Site& entry = m_sites[index];
+
+			// Claim a free entry, unless the table is too full to keep the probes short
+			int state = entry.state.load(std::memory_order_acquire);
+			if (state == 0) {
+				if (m_siteCount.load(std::memory_order_relaxed) >= MaxSites * 3 / 4) {
+					return otherSitesIndex;
+				}
+				if (entry.state.compare_exchange_strong(state, 1, std::memory_order_acquire)) {
+					entry.file = site.file;
+					entry.function = site.function;
+					entry.line = site.line;
+					entry.caller = site.caller;
+					m_siteCount.fetch_add(1, std::memory_order_relaxed);
+					entry.state.store(2, std::memory_order_release);
+					return index;
+				}
+			}
+
+			// Another thread is filling this entry in, so wait the moment it takes to see whose it is
+			while (state != 2) {
+				state = entry.state.load(std::memory_order_acquire);
+			}
+			if (entry.file == site.file && entry.function == site.function && entry.line == site.line && entry.caller == site.caller) {
+				return index;
+			}
+		}
+		return otherSitesIndex;
+	};
+
+	AllocationProfiler::ThreadCounters& AllocationProfiler::GetThreadCounters() {
+		if (threadCounters == nullptr) {
+			// Counters outlive their thread, so its allocations still show in the report after it has finished
+			ThreadCounters* counters = (ThreadCounters*)std::calloc(1, sizeof(ThreadCounters));
+			if (counters == nullptr) {
+				std::abort();
+			}
+			counters->next = m_threads.load(std::memory_order_relaxed);
+			while (!m_threads.compare_exchange_weak(counters->next, counters, std::memory_order_release)) {
+			}
+			threadCounters = counters;
+		}
+		return *(ThreadCounters*)threadCounters;
+	};
+
+	void AllocationProfiler::Insert(size_t address, size_t size, int site) {
+		const unsigned long long hash = Mix(address);
+		Shard& shard = m_shards[hash & (ShardCount - 1)];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+
+		// Double the table once it's half full, putting every block back in at its new slot
+		if ((shard.count + 1) * 2 > shard.capacity) {
+			size_t capacity = shard.capacity == 0 ? initialShardCapacity : shard.capacity * 2;
+			LiveBlock* blocks = (LiveBlock*)std::calloc(capacity, sizeof(LiveBlock));
+			if (blocks == nullptr) {
+				std::abort();
+			}
+			for (size_t i = 0; i < shard.capacity; i++) {
+				if (shard.blocks[i].address != 0) {
+					size_t slot = (size_t)(Mix(shard.blocks[i].address) >> 6) & (capacity - 1);
+					while (blocks[slot].address != 0) {
+						slot = (slot + 1) & (capacity - 1);
+					}
+					blocks[slot] = shard.blocks[i];
+				}
+			}
+			std::free(shard.blocks);
+			shard.blocks = blocks;
+			shard.capacity = capacity;
+		}
+
+		size_t slot = (size_t)(hash >> 6) & (shard.capacity - 1);
+		while (shard.blocks[slot].address != 0 && shard.blocks[slot].address != address) {
+			slot = (slot + 1) & (shard.capacity - 1);
+		}
+		if (shard.blocks[slot].address == 0) {
+			shard.count++;
+		}
+		shard.blocks[slot] = LiveBlock{ address, size, site };
+	};
+
+	bool AllocationProfiler::Remove(size_t address, size_t& size, int& site) {
+		const unsigned long long hash = Mix(address);
+		Shard& shard = m_shards[hash & (ShardCount - 1)];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		if (shard.count == 0) {
+			return false;
+		}
+
+		const size_t mask = shard.capacity - 1;
+		size_t slot = (size_t)(hash >> 6) & mask;
+		while (shard.blocks[slot].address != address) {
+			if (shard.blocks[slot].address == 0) {
+				return false;
+			}
+			slot = (slot + 1) & mask;
+		}
+		size = shard.blocks[slot].size;
+		site = shard.blocks[slot].site;
+
+		// Close the gap by moving back any later block in the same run that would no longer be found past it, so the table never needs tombstones
+		size_t gap = slot;
+		for (size_t next = (gap + 1) & mask; shard.blocks[next].address != 0; next = (next + 1) & mask) {
+			size_t home = (size_t)(Mix(shard.blocks[next].address) >> 6) & mask;
+			if (((next - home) & mask) >= ((next - gap) & mask)) {
+				shard.blocks[gap] = shard.blocks[next];
+				gap = next;
+			}
+		}
+		shard.blocks[gap].address = 0;
+		shard.count--;
+		return true;
+	};
+
+	void* AllocationProfiler::Allocate(size_t size, const AllocationSite* site) {
+		void* block = std::malloc(size > 0 ? size : 1);
+		if (block == nullptr || !m_recording.load(std::memory_order_relaxed)) {
+			return block;
+		}
+
+		const int index = site != nullptr && (site->file != nullptr || site->caller != nullptr) ? FindSite(*site) : untaggedIndex;
+		SiteCounters& counters = GetThreadCounters().sites[index];
+		counters.allocations.store(counters.allocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		counters.bytes.store(counters.bytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+
+		Insert((size_t)block, size, index);
+		return block;
+	};
+
+	void AllocationProfiler::Free(void* block) {
+		if (block == nullptr) {
+			return;
+		}
+
+		size_t size;
+		int index;
+		if (Remove((size_t)block, size, index)) {
+			SiteCounters& counters = GetThreadCounters().sites[index];
+			counters.frees.store(counters.frees.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			counters.freedBytes.store(counters.freedBytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+		}
+		std::free(block);
+	};
+
+	void AllocationProfiler::SetRecording(bool recording) {
+		m_recording.store(recording, std::memory_order_relaxed);
+	};
+
+	bool AllocationProfiler::IsRecording() const {
+		return m_recording.load(std::memory_order_relaxed);
+	};
+
+	AllocationTotals AllocationProfiler::GetTotals() const {
+		AllocationTotals totals = AllocationTotals();
+		for (ThreadCounters* counters = m_threads.load(std::memory_order_acquire); counters != nullptr; counters = counters->next) {
+			for (const SiteCounters& site : counters->sites) {
+				totals.allocations += site.allocations.load(std::memory_order_relaxed);
+				totals.frees += site.frees.load(std::memory_order_relaxed);
+				totals.bytesAllocated += site.bytes.load(std::memory_order_relaxed);
+				totals.bytesFreed += site.freedBytes.load(std::memory_order_relaxed);
+			}
+			totals.threads++;
+		}
+		return totals;
+	};
+
+	std::vector<AllocationSiteStats> AllocationProfiler::GetSites() const {
+		// Sized up front, so the vector (which is allocated through the profiler too) doesn't grow while the sites are being read
+		std::vector<AllocationSiteStats> sites;
+		sites.reserve(MaxSites);
+		for (int i = 0; i < MaxSites; i++) {
+			const Site& entry = m_sites[i];
+			if (entry.state.load(std::memory_order_acquire) != 2) {
+				continue;
+			}
+			AllocationSiteStats stats = AllocationSiteStats();
+			stats.site = AllocationSite{ entry.file, entry.function, entry.line, entry.caller };
+			unsigned long long frees = 0;
+			unsigned long long freedBytes = 0;
+			for (ThreadCounters* counters = m_threads.load(std::memory_order_acquire); counters != nullptr; counters = counters->next) {
+				stats.allocations += counters->sites[i].allocations.load(std::memory_order_relaxed);
+				stats.bytes += counters->sites[i].bytes.load(std::memory_order_relaxed);
+				frees += counters->sites[i].frees.load(std::memory_order_relaxed);
+				freedBytes += counters->sites[i].freedBytes.load(std::memory_order_relaxed);
+			}
+			stats.liveBlocks = stats.allocations > frees ? stats.allocations - frees : 0;
+			stats.liveBytes = stats.bytes > freedBytes ? stats.bytes - freedBytes : 0;
+			if (stats.allocations > 0) {
+				sites.push_back(stats);
+			}
+		}
+
+		std::sort(sites.begin(), sites.end(), [](const AllocationSiteStats& a, const AllocationSiteStats& b) {
+			return a.bytes > b.bytes;
+		});
+		return sites;
+	};
+
+	void AllocationProfiler::Report(std::ostream& out, int maxSites) const {
+		// The site list is itself allocated, so the totals are read after it to include it
+		std::vector<AllocationSiteStats> sites = GetSites();
+		AllocationTotals totals = GetTotals();
+
+		out << "Allocation report: " << totals.allocations << " allocations (" << totals.bytesAllocated << " bytes), " << totals.frees << " frees (" << totals.bytesFreed << " bytes), "
+			<< totals.allocations - totals.frees << " blocks still live, across " << totals.threads << " threads" << std::endl;
+		out << std::setw(40) << "site" << std::setw(14) << "allocations" << std::setw(16) << "bytes" << std::setw(14) << "live blocks" << std::setw(16) << "live bytes" << "  function" << std::endl;
+		for (int i = 0; i < (int)sites.size() && i < maxSites; i++) {
+			const AllocationSiteStats& stats = sites[i];
+			std::string site;
+			std::string function;
+			if (stats.site.file != nullptr) {
+				site = FileName(stats.site.file);
+				if (stats.site.line > 0) {
+					site += ":" + std::to_string(stats.site.line);
+				}
+				function = stats.site.function;
+			}
+			else {
+				site = CallerName(stats.site.caller, function);
+			}
+			out << std::setw(40) << site << std::setw(14) << stats.allocations << std::setw(16) << stats.bytes << std::setw(14) << stats.liveBlocks << std::setw(16) << stats.liveBytes
+				<< "  " << function << std::endl;
+		}
+		if ((int)sites.size() > maxSites) {
+			out << "(and " << sites.size() - maxSites << " more sites)" << std::endl;
+		}
+		out << "Sites shown as file:line are tagged by memory.h. The rest are grouped by the code address that called operator new (module+offset),"
+			<< " which for containers is usually inside the std:: function that grew them." << std::endl;
+	};
+}
+
+
+#ifdef AIFG_ALLOCATION_PROFILER
+namespace {
+	void* AllocateOrThrow(std::size_t size, const AIForGames::AllocationSite* site) {
+		void* block = AIForGames::AllocationProfiler::Global().Allocate(size, site);
+		if (block == nullptr) {
+			throw std::bad_alloc();
+		}
+		return block;
+	};
+
+	// Prints the report once main has returned. <iostream> is included above this, so std::cout is still there when it runs.
+	struct ExitReport {
+		~ExitReport() {
+			AIForGames::AllocationProfiler::Global().Report(std::cout);
+		};
+	} exitReport;
+}
+
+// Every form of the global operator new and delete, replaced for the whole program.
+// The untagged forms record the address they return to, so allocations are still grouped by where they came from.
+void* operator new(std::size_t size) {
+	const AIForGames::AllocationSite site = AIForGames::AllocationSite::Caller(AIFG_RETURN_ADDRESS());
+	return AllocateOrThrow(size, &site);
+}
+
+void* operator new[](std::size_t size) {
+	const AIForGames::AllocationSite site = AIForGames::AllocationSite::Caller(AIFG_RETURN_ADDRESS());
+	return AllocateOrThrow(size, &site);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	const AIForGames::AllocationSite site = AIForGames::AllocationSite::Caller(AIFG_RETURN_ADDRESS());
+	return AIForGames::AllocationProfiler::Global().Allocate(size, &site);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	const AIForGames::AllocationSite site = AIForGames::AllocationSite::Caller(AIFG_RETURN_ADDRESS());
+	return AIForGames::AllocationProfiler::Global().Allocate(size, &site);
+}
+
+void* operator new(std::size_t size, const AIForGames::AllocationSite& site) {
+	return AllocateOrThrow(size, &site);
+}
+
+void* operator new[](std::size_t size, const AIForGames::AllocationSite& site) {
+	return AllocateOrThrow(size, &site);
+}
+
+void operator delete(void* block) noexcept {
+	AIForGames::AllocationProfiler::Global().Free(block);
+}
+
+void operator delete[](void* block) noexcept {
+	AIForGames::AllocationProfiler::Global().Free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+	AIForGames::AllocationProfiler::Global().Free(block);
+}
+
+void operator delete[](void* block, std::size_t) noexcept {
+	AIForGames::AllocationProfiler::Global().Free(block);
+}
+
+void operator delete(void* block, const std::nothrow_t&) noexcept {
+	AIForGames::AllocationProfiler::Global().Free(block);
+}
+
+void operator delete[](void* block, const std::nothrow_t&) noexcept {
+	AIForGames::AllocationProfiler::Global().Free(block);
+}
+
+void operator delete(void* block, const AIForGames::AllocationSite&) noexcept {
+	AIForGames::AllocationProfiler::Global().Free(block);
+}
+
+void operator delete[](void* block, const AIForGames::AllocationSite&) noexcept {
+	AIForGames::AllocationProfiler::Global().Free(block);
+}
+#endif
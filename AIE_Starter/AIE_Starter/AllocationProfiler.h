@@ -0,0 +1,174 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+#include <mutex>
+#include <vector>
+
+// The allocation profiler is chosen at compile time (the Debug configurations define it in the project settings):
+// with AIFG_ALLOCATION_PROFILER defined, every global operator new and delete in the program goes through AllocationProfiler::Global(),
+// and a report of where the memory went is printed when the program exits. Without it, nothing is replaced and the profiler costs nothing.
+// Include memory.h last in a .cpp file to tag each 'new' in that file with where it was called from. Every other allocation (which includes everything
+// the standard containers allocate) is recorded against the address operator new was called from, so the report still tells those call sites apart.
+
+// std::source_location when compiling as C++20, otherwise the compiler builtins it is made from (GCC, Clang and Visual Studio 2019 16.6 on have them)
+#if defined(__has_include)
+#if __has_include(<source_location>) && (__cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L))
+#include <source_location>
+#endif
+#endif
+
+namespace AIForGames {
+	// Where an allocation was made. Current() gives the place it's called from, because default arguments are filled in where the call is written.
+	// An untagged 'new' has no file, function or line, only the code address operator new returns to (its caller).
+	struct AllocationSite {
+		const char* file;
+		const char* function;
+		int line;
+		const void* caller;
+
+#ifdef __cpp_lib_source_location
+		static AllocationSite Current(std::source_location location = std::source_location::current()) {
+			return AllocationSite{ location.file_name(), location.function_name(), (int)location.line(), nullptr };
+		};
+#else
+		static AllocationSite Current(const char* file = __builtin_FILE(), const char* function = __builtin_FUNCTION(), int line = __builtin_LINE()) {
+			return AllocationSite{ file, function, line, nullptr };
+		};
+#endif
+
+		// The site for an untagged 'new', told apart by the address it was called from
+		static AllocationSite Caller(const void* caller) {
+			return AllocationSite{ nullptr, nullptr, 0, caller };
+		};
+	};
+
+	// Everything allocated from one call site since the program started
+	struct AllocationSiteStats {
+		AllocationSite site;
+		unsigned long long allocations;
+		unsigned long long bytes;
+		unsigned long long liveBlocks;
+		unsigned long long liveBytes;
+	};
+
+	// Everything allocated and freed by every thread since the program started
+	struct AllocationTotals {
+		unsigned long long allocations;
+		unsigned long long frees;
+		unsigned long long bytesAllocated;
+		unsigned long long bytesFreed;
+		int threads;
+	};
+
+	// Records every block handed out by operator new: how big it is and which call site asked for it, until it's deleted again.
+	// Live blocks are kept in hash tables indexed by address, split into shards with a lock each, so freeing a block is one short probe
+	// under a lock that's rarely shared. Counts are kept per thread and per call site, written by that thread alone, so counting never contends.
+	// An untagged 'new' is grouped by the address it returns to, which is usually inside whichever container or std:: function asked for the memory;
+	// the report prints that as module+offset (and the function's name, where the module exports it), ready for addr2line or the debugger.
+	// Nothing is ever printed while allocating; Report prints the call sites sorted by bytes, on demand and at exit.
+	// All of the profiler's own memory comes from malloc, so it never records itself.
+	class AllocationProfiler
+	{
+	public:
+		// Call sites past this many are counted together as "(other sites)". Must be a power of two.
+		static const int MaxSites = 4096;
+
+		// Must be a power of two
+		static const int ShardCount = 64;
+
+	private:
+		// A call site's entry. 'state' goes from 0 (free) to 1 (being filled in) to 2 (ready) when a thread claims it, and never back.
+		struct Site {
+			std::atomic<int> state;
+			const char* file;
+			const char* function;
+			int line;
+			const void* caller;
+		};
+
+		// An entry in a shard's table. An address of 0 marks an empty slot.
+		struct LiveBlock {
+			size_t address;
+			size_t size;
+			int site;
+		};
+
+		// One shard of the live block table: open addressing with linear probing, grown to stay under half full
+		struct Shard {
+			std::mutex mutex;
+			LiveBlock* blocks;
+			size_t capacity;
+			size_t count;
+		};
+
+		// What one thread has allocated and freed from one call site. Only the thread itself writes them, so each count is a plain load and store
+		// rather than an atomic add, and threads allocating from the same site never fight over a cache line.
+		struct SiteCounters {
+			std::atomic<unsigned long long> allocations;
+			std::atomic<unsigned long long> bytes;
+			std::atomic<unsigned long long> frees;
+			std::atomic<unsigned long long> freedBytes;
+		};
+
+		// One thread's counters for every call site. A block freed on another thread is counted as a free there, and the report adds every thread up.
+		struct ThreadCounters {
+			SiteCounters sites[MaxSites];
+			ThreadCounters* next;
+		};
+
+		Site m_sites[MaxSites];
+		std::atomic<int> m_siteCount;
+		Shard m_shards[ShardCount];
+		std::atomic<ThreadCounters*> m_threads;
+		std::atomic<bool> m_recording;
+
+		AllocationProfiler();
+
+		// Find (or claim) the entry for a call site
+		int FindSite(const AllocationSite& site);
+
+		// The calling thread's counters, made the first time the thread allocates
+		ThreadCounters& GetThreadCounters();
+
+		// Add or remove a block in its shard's table. Remove returns false if the block isn't there (it was allocated while recording was paused).
+		void Insert(size_t address, size_t size, int site);
+		bool Remove(size_t address, size_t& size, int& site);
+
+	public:
+		AllocationProfiler(const AllocationProfiler&) = delete;
+		AllocationProfiler& operator=(const AllocationProfiler&) = delete;
+
+		// The profiler the replaced operator new and delete use. It's never destroyed, so blocks freed during shutdown are still found.
+		static AllocationProfiler& Global();
+
+		// Allocate a block with malloc and record it against the call site (nullptr, or a site with no caller, if nothing is known about where it came from).
+		// Returns nullptr if malloc fails.
+		void* Allocate(size_t size, const AllocationSite* site);
+
+		// Forget the block and free it
+		void Free(void* block);
+
+		// While paused, new blocks aren't recorded (only blocks recorded earlier are looked up when they're freed)
+		void SetRecording(bool recording);
+		bool IsRecording() const;
+
+		AllocationTotals GetTotals() const;
+
+		// Every call site seen so far, sorted by bytes allocated, most first
+		std::vector<AllocationSiteStats> GetSites() const;
+
+		// Print the totals and the top call sites by bytes allocated
+		void Report(std::ostream& out, int maxSites = 20) const;
+	};
+}
+
+#ifdef AIFG_ALLOCATION_PROFILER
+// The operator new that memory.h's 'new' calls, with the site it was called from
+void* operator new(std::size_t size, const AIForGames::AllocationSite& site);
+void* operator new[](std::size_t size, const AIForGames::AllocationSite& site);
+void operator delete(void* block, const AIForGames::AllocationSite& site) noexcept;
+void operator delete[](void* block, const AIForGames::AllocationSite& site) noexcept;
+#endif
+
+#define AIFG_ALLOCATION_SITE ::AIForGames::AllocationSite::Current()
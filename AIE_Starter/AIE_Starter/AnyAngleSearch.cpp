@@ -0,0 +1,112 @@
+#include "AnyAngleSearch.h"
+#include "Heuristics.h"
+#include "SearchTrace.h"
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace AIForGames {
+	AnyAngleSearch::AnyAngleSearch(const NodeMap& map) : m_map(map) {};
+
+	AnyAngleSearch::~AnyAngleSearch() {};
+
+	std::vector<Node*> AnyAngleSearch::FindPath(Node* startNode, Node* endNode, SearchContext& context) const {
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		SearchStats stats = SearchStats();
+
+		if (startNode == nullptr || endNode == nullptr || !m_map.AreConnected(startNode, endNode)) {
+			context.SetStats(stats);
+			return std::vector<Node*>();
+		}
+
+		// Straight lines would price every cell they cross the same, so weighted tiles need an ordinary A* search instead
+		if (!m_map.HasUniformCosts()) {
+			return m_map.GetGraph() == GridGraph::Implicit8 ? m_map.AStarSearch<OctileHeuristic>(startNode, endNode, context) : m_map.AStarSearch<ManhattanHeuristic>(startNode, endNode, context);
+		}
+		AIFG_TRACE_NODE(Begin, startNode->id, 0.0f);
+
+		const int width = m_map.GetWidth();
+		const int startId = startNode->id;
+		const int endId = endNode->id;
+
+		// Every cost is a straight line length in cells, and so is the estimate (which makes it exact on open ground)
+		auto distance = [width](int fromId, int toId) {
+			float dx = (float)(fromId % width - toId % width);
+			float dy = (float)(fromId / width - toId / width);
+			return std::sqrt(dx * dx + dy * dy);
+		};
+
+		context.Begin(m_map.GetNodeCount());
+		context.SetScore(startId, 0.0f, -1);
+		NodeQueue& openList = context.OpenList();
+		context.SetListState(startId, SearchContext::Open);
+		openList.Push(startId, distance(startId, endId));
+		stats.nodesOpened++;
+		AIFG_TRACE_EDGE(Push, startId, 0.0f);
+
+		while (!openList.Empty()) {
+			int currentNode = openList.Pop();
+
+			// The node was opened on the assumption that its previous node could see it. Check that now, and if it can't,
+			// join it to whichever of its closed neighbours gives it the lowest g score (the one it was opened from is always one of them).
+			int previousNode = context.GetPreviousNode(currentNode);
+			if (previousNode != -1 && !m_map.HasLineOfSight(previousNode, currentNode)) {
+				float bestG = std::numeric_limits<float>::infinity();
+				int bestNeighbour = -1;
+				m_map.ForEachNeighbour(currentNode, [&](int neighbour, float) {
+					if (context.GetListState(neighbour) == SearchContext::Closed && context.GetGScore(neighbour) + distance(neighbour, currentNode) < bestG) {
+						bestG = context.GetGScore(neighbour) + distance(neighbour, currentNode);
+						bestNeighbour = neighbour;
+					}
+				});
+				context.SetScore(currentNode, bestG, bestNeighbour);
+			}
+
+			AIFG_TRACE_NODE(Expand, currentNode, context.GetGScore(currentNode));
+
+			if (currentNode == endId) {
+				AIFG_TRACE_NODE(Found, currentNode, context.GetGScore(currentNode));
+				break;
+			}
+
+			context.SetListState(currentNode, SearchContext::Closed);
+			stats.nodesExpanded++;
+			AIFG_TRACE_NODE(Close, currentNode, context.GetGScore(currentNode));
+
+			// Each neighbour is offered a straight line from the current node's previous node (the start has none, so it offers itself),
+			// skipping the current node altogether. Whether that line is really clear waits until the neighbour comes off the open list.
+			int origin = context.GetPreviousNode(currentNode) != -1 ? context.GetPreviousNode(currentNode) : currentNode;
+			float originG = context.GetGScore(origin);
+			m_map.ForEachNeighbour(currentNode, [&](int targetNode, float) {
+				SearchContext::ListState targetState = context.GetListState(targetNode);
+				if (targetState == SearchContext::Closed) {
+					return;
+				}
+
+				float calcdG = originG + distance(origin, targetNode);
+				if (targetState == SearchContext::Unvisited) {
+					context.SetScore(targetNode, calcdG, origin);
+					context.SetListState(targetNode, SearchContext::Open);
+					openList.Push(targetNode, calcdG + distance(targetNode, endId));
+					stats.nodesOpened++;
+					AIFG_TRACE_EDGE(Push, targetNode, calcdG);
+				}
+				else if (calcdG < context.GetGScore(targetNode)) {
+					context.SetScore(targetNode, calcdG, origin);
+					openList.DecreaseKey(targetNode, calcdG + distance(targetNode, endId));
+					AIFG_TRACE_EDGE(Relax, targetNode, calcdG);
+				}
+			});
+		}
+
+		// Following the previous nodes back from the end only visits the corners
+		std::vector<Node*> path = m_map.ToNodePath(context.BuildPath(endId));
+		if (path.empty()) {
+			AIFG_TRACE_NODE(Exhausted, endId, 0.0f);
+		}
+
+		stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		context.SetStats(stats);
+		return path;
+	};
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "NodeMap.h"
+#include <vector>
+
+namespace AIForGames {
+	// Any-angle search with Lazy Theta*: A* over the map's own graph, except that a node opened from the current node is given the current node's
+	// previous node as its own wherever the straight line between them is clear (NodeMap::HasLineOfSight). Paths then run in straight lines at any angle
+	// from corner to corner, instead of in grid steps, and only the corners are kept in the path.
+	// The 'lazy' part: the line is only checked when the node comes off the open list rather than for every neighbour it's opened from,
+	// which is one check per node expanded instead of one per edge. If the line turns out to be blocked, the node takes the best of its closed neighbours instead.
+	// Paths are measured by their straight line length, so they are usually a little shorter than the grid's shortest path (but aren't promised to be the shortest of all).
+	class AnyAngleSearch
+	{
+		const NodeMap& m_map;
+
+	public:
+		// The search keeps a reference to the map, so the map has to outlive it
+		AnyAngleSearch(const NodeMap& map);
+		~AnyAngleSearch();
+
+		// Find a path from the start node to the end node (empty if there isn't one), using the context for the search's scratch data.
+		// The path holds the start, the corners it turns at and the end, with a clear straight line between each pair, which PathAgent follows like any other path.
+		// A straight line crosses cells of every cost alike, so on a map with weighted tiles this falls back to plain A* (and a path of every cell), as JumpPointSearch does.
+		std::vector<Node*> FindPath(Node* startNode, Node* endNode, SearchContext& context) const;
+	};
+}
@@ -0,0 +1,70 @@
+#include "BatchPathSolver.h"
+#include "PathAgent.h"
+
+namespace AIForGames {
+	BatchPathSolver::BatchPathSolver(const NodeMap& map, ThreadPool& pool) : m_map(map), m_pool(pool) {
+		m_contexts.resize(pool.GetThreadCount());
+	};
+
+	BatchPathSolver::~BatchPathSolver() {
+		// Queued tasks still point at this solver's contexts
+		m_pool.Wait();
+	};
+
+	std::vector<std::vector<Node*>> BatchPathSolver::Solve(const std::vector<PathRequest>& requests) {
+		std::vector<std::vector<Node*>> paths(requests.size());
+
+		// Each task writes only its own slot of the results, so they need no lock
+		std::vector<ThreadPool::Task> tasks;
+		tasks.reserve(requests.size());
+		for (size_t i = 0; i < requests.size(); i++) {
+			tasks.push_back([this, &requests, &paths, i](int worker) {
+				paths[i] = m_map.DijkstraSearch(requests[i].startNode, requests[i].endNode, m_contexts[worker]);
+			});
+		}
+		m_pool.Submit(tasks);
+		m_pool.Wait();
+
+		for (size_t i = 0; i < requests.size(); i++) {
+			if (requests[i].agent != nullptr) {
+				requests[i].agent->SetPath(paths[i]);
+			}
+		}
+		return paths;
+	};
+
+	void BatchPathSolver::SubmitAsync(const std::vector<PathRequest>& requests) {
+		std::vector<ThreadPool::Task> tasks;
+		tasks.reserve(requests.size());
+		for (const PathRequest& request : requests) {
+			tasks.push_back([this, request](int worker) {
+				FinishedRequest finished;
+				finished.agent = request.agent;
+				finished.path = m_map.DijkstraSearch(request.startNode, request.endNode, m_contexts[worker]);
+
+				std::lock_guard<std::mutex> lock(m_finishedLock);
+				m_finished.push_back(std::move(finished));
+			});
+		}
+		m_pool.Submit(tasks);
+	};
+
+	int BatchPathSolver::DeliverFinished() {
+		std::vector<FinishedRequest> finished;
+		{
+			std::lock_guard<std::mutex> lock(m_finishedLock);
+			finished.swap(m_finished);
+		}
+
+		for (FinishedRequest& request : finished) {
+			if (request.agent != nullptr) {
+				request.agent->SetPath(request.path);
+			}
+		}
+		return (int)finished.size();
+	};
+
+	void BatchPathSolver::Wait() {
+		m_pool.Wait();
+	};
+}
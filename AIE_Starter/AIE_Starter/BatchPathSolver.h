@@ -0,0 +1,54 @@
+#pragma once
+#include "NodeMap.h"
+#include "ThreadPool.h"
+#include <mutex>
+#include <vector>
+
+namespace AIForGames {
+	class PathAgent;
+
+	// One path for the batch solver to find. If an agent is given, the path is handed to it once it's been found.
+	struct PathRequest {
+		Node* startNode;
+		Node* endNode;
+		PathAgent* agent;
+	};
+
+	// Finds paths for many requests at once, spread over the threads of a ThreadPool.
+	// Every search only reads the NodeMap, and each worker thread has its own SearchContext, so the searches never wait on each other.
+	// Paths are handed to their agents on the thread that calls Solve or DeliverFinished, never from a worker, so agents don't need any locking of their own.
+	class BatchPathSolver
+	{
+		const NodeMap& m_map;
+		ThreadPool& m_pool;
+
+		// One search context per worker thread, indexed by the worker number the pool gives each task
+		std::vector<SearchContext> m_contexts;
+
+		// Requests submitted with SubmitAsync that have finished but not yet been handed to their agents
+		struct FinishedRequest {
+			PathAgent* agent;
+			std::vector<Node*> path;
+		};
+		std::vector<FinishedRequest> m_finished;
+		std::mutex m_finishedLock;
+
+	public:
+		// The solver keeps references to the map and the pool, so both have to outlive it.
+		// The map mustn't be changed while a batch is being solved.
+		BatchPathSolver(const NodeMap& map, ThreadPool& pool);
+		~BatchPathSolver();
+
+		// Solve every request and wait for them all to finish. The paths come back in the same order as the requests, and are handed to their agents too.
+		std::vector<std::vector<Node*>> Solve(const std::vector<PathRequest>& requests);
+
+		// Queue the requests and return straight away. Call DeliverFinished every frame to hand the agents their paths as they come in.
+		void SubmitAsync(const std::vector<PathRequest>& requests);
+
+		// Hand every path finished since the last call to its agent, and return how many were handed over
+		int DeliverFinished();
+
+		// Block until every request submitted so far has been solved (they still need delivering)
+		void Wait();
+	};
+}
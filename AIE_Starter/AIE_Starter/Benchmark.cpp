@@ -0,0 +1,2069 @@
+#include "Benchmark.h"
+#include "AgentSystem.h"
+#include "AllocationProfiler.h"
+#include "AnyAngleSearch.h"
+#include "BatchPathSolver.h"
+#include "DStarLite.h"
+#include "FlowFieldCache.h"
+#include "HierarchicalMap.h"
+#include "JumpPointSearch.h"
+#include "MapGeometry.h"
+#include "MapLoader.h"
+#include "MapSnapshot.h"
+#include "NodeMap.h"
+#include "PathCache.h"
+#include "PathAgent.h"
+#include "PathQuery.h"
+#include "PathScheduler.h"
+#include "SearchContext.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace AIForGames {
+	namespace {
+		typedef chrono::steady_clock Clock;
+
+		// How long a single run of the old search is allowed before it is abandoned (it is quadratic, so big queries would take hours)
+		const double legacyBudgetMs = 5000.0;
+
+		double MillisecondsSince(Clock::time_point start) {
+			return chrono::duration<double, milli>(Clock::now() - start).count();
+		};
+
+		// How many correctness checks have failed so far. RunBenchmarks returns nonzero if any have, so a wrong answer fails the run instead of just being printed.
+		int failedChecks = 0;
+
+		// The answer to print for a correctness check, counting it if it failed
+		const char* CheckResult(bool passed, const char* yes = "yes", const char* no = "NO") {
+			if (!passed) {
+				failedChecks++;
+			}
+			return passed ? yes : no;
+		};
+
+		// How much of the process's memory is in RAM right now (its resident set size), or 0 where that can't be found out
+		size_t ResidentBytes() {
+#ifdef _WIN32
+			PROCESS_MEMORY_COUNTERS counters;
+			return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.WorkingSetSize : 0;
+#elif defined(__linux__)
+			// The second number in statm is the resident size, in pages
+			ifstream statm("/proc/self/statm");
+			size_t totalPages = 0;
+			size_t residentPages = 0;
+			statm >> totalPages >> residentPages;
+			return residentPages * (size_t)sysconf(_SC_PAGESIZE);
+#else
+			return 0;
+#endif
+		};
+
+		// Build a square ascii map in the same '0' / '1' format as main uses.
+		// Walls are only ever placed on cells with an odd column and an odd row, so every open cell stays reachable from every other one.
+		vector<string> MakeBenchmarkGrid(int size, unsigned int seed) {
+			mt19937 random(seed);
+			vector<string> asciiMap(size, string(size, '1'));
+
+			for (int y = 1; y < size; y += 2) {
+				for (int x = 1; x < size; x += 2) {
+					if (random() % 2 == 0) {
+						asciiMap[y][x] = '0';
+					}
+				}
+			}
+
+			return asciiMap;
+		};
+	}
+
+	vector<string> MakeOpenGrid(int size, unsigned int seed) {
+		mt19937 random(seed);
+		vector<string> asciiMap(size, string(size, '1'));
+
+		// Blocks average a quarter of the biggest block's area, so this many of them cover about a quarter of the map
+		int maxBlockSize = size / 16 > 2 ? size / 16 : 2;
+		int blockCount = size * size / (maxBlockSize * maxBlockSize);
+		for (int i = 0; i < blockCount; i++) {
+			int left = 1 + (int)(random() % (size - 1));
+			int top = 1 + (int)(random() % (size - 1));
+			int width = 1 + (int)(random() % maxBlockSize);
+			int height = 1 + (int)(random() % maxBlockSize);
+			for (int y = top; y < top + height && y < size; y++) {
+				for (int x = left; x < left + width && x < size; x++) {
+					asciiMap[y][x] = '0';
+				}
+			}
+		}
+
+		return asciiMap;
+	};
+
+	namespace {
+
+
+		// The search as it was before the priority queue: the open list is re-sorted every iteration and list membership is found with linear searches.
+		// It runs on its own copy of the graph, so it stays a fixed baseline however the real Node and NodeMap change.
+		struct LegacyNode {
+			int x;
+			int y;
+			vector<pair<LegacyNode*, float>> connections;
+			int gScore;
+			LegacyNode* previousNode;
+		};
+
+		class LegacyGraph
+		{
+			int m_width;
+			vector<LegacyNode*> m_nodes;
+
+		public:
+			// Connects the nodes in the same order as NodeMap::Initialise, so both searches see the edges in the same order
+			LegacyGraph(const vector<string>& asciiMap) {
+				m_width = (int)asciiMap[0].size();
+				m_nodes.resize(m_width * asciiMap.size(), nullptr);
+
+				for (int y = 0; y < (int)asciiMap.size(); y++) {
+					for (int x = 0; x < m_width; x++) {
+						if (asciiMap[y][x] != '0') {
+							LegacyNode* node = new LegacyNode();
+							node->x = x;
+							node->y = y;
+							node->gScore = 0;
+							node->previousNode = nullptr;
+							m_nodes[x + m_width * y] = node;
+						}
+					}
+				}
+
+				for (int y = 0; y < (int)asciiMap.size(); y++) {
+					for (int x = 0; x < m_width; x++) {
+						LegacyNode* node = Get(x, y);
+						if (node == nullptr) {
+							continue;
+						}
+
+						LegacyNode* nodeWest = x == 0 ? nullptr : Get(x - 1, y);
+						if (nodeWest) {
+							node->connections.push_back(make_pair(nodeWest, 1.0f));
+							nodeWest->connections.push_back(make_pair(node, 1.0f));
+						}
+
+						LegacyNode* nodeSouth = y == 0 ? nullptr : Get(x, y - 1);
+						if (nodeSouth) {
+							node->connections.push_back(make_pair(nodeSouth, 1.0f));
+							nodeSouth->connections.push_back(make_pair(node, 1.0f));
+						}
+					}
+				}
+			};
+
+			~LegacyGraph() {
+				for (LegacyNode* node : m_nodes) {
+					delete node;
+				}
+			};
+
+			LegacyNode* Get(int x, int y) {
+				return m_nodes[x + m_width * y];
+			};
+
+			// Bytes held by the pointer grid, the nodes and their edge vectors (not counting the allocator's own overhead per allocation)
+			size_t GetMemoryUsage() const {
+				size_t bytes = m_nodes.capacity() * sizeof(LegacyNode*);
+				for (LegacyNode* node : m_nodes) {
+					if (node != nullptr) {
+						bytes += sizeof(LegacyNode) + node->connections.capacity() * sizeof(pair<LegacyNode*, float>);
+					}
+				}
+				return bytes;
+			};
+
+			// Visit every edge of every node once, the way a search reads them, and return the sum of the edge costs
+			float SumEdgeCosts() const {
+				float total = 0.0f;
+				for (LegacyNode* node : m_nodes) {
+					if (node != nullptr) {
+						for (const pair<LegacyNode*, float>& edge : node->connections) {
+							total += edge.second + (float)edge.first->x;
+						}
+					}
+				}
+				return total;
+			};
+		};
+
+
+		// The time to visit every edge of a NodeMap once, summing the costs and the neighbours' columns like LegacyGraph::SumEdgeCosts
+		double TimeEdgeScan(const NodeMap& map, float& sum) {
+			Clock::time_point start = Clock::now();
+			sum = 0.0f;
+			for (int id = 0; id < map.GetNodeCount(); id++) {
+				if (!map.IsWalkable(id % map.GetWidth(), id / map.GetWidth())) {
+					continue;
+				}
+				map.ForEachNeighbour(id, [&](int other, float cost) {
+					sum += cost + (float)(other % map.GetWidth());
+				});
+			}
+			return MillisecondsSince(start);
+		};
+
+
+		// Compares the memory and the time to read every edge once between the per-node edge vectors, the NodeMap's compressed sparse row arrays and the implicit grid
+		void BenchmarkGraphLayout(int size, float cellSize) {
+			vector<string> asciiMap = MakeBenchmarkGrid(size, 1234u);
+
+			NodeMap map;
+			NodeMap implicitMap;
+			{
+				MuteConsole mute;
+				map.Initialise(asciiMap, (int)cellSize);
+				implicitMap.Initialise(asciiMap, (int)cellSize, GridGraph::Implicit4);
+			}
+			LegacyGraph legacy(asciiMap);
+
+			int nodeCount = 0;
+			for (int id = 0; id < map.GetNodeCount(); id++) {
+				if (map.GetNodeById(id) != nullptr) {
+					nodeCount++;
+				}
+			}
+
+			Clock::time_point start = Clock::now();
+			float legacySum = legacy.SumEdgeCosts();
+			double legacyMs = MillisecondsSince(start);
+
+			float csrSum = 0.0f;
+			double csrMs = TimeEdgeScan(map, csrSum);
+			float implicitSum = 0.0f;
+			double implicitMs = TimeEdgeScan(implicitMap, implicitSum);
+
+			// The implicit grid has to find the same path as the explicit one, node for node
+			SearchContext context(map.GetNodeCount());
+			int target = ((size - 1) / 2) * 2;
+			vector<Node*> path = map.DijkstraSearch(map.GetNode(0, 0), map.GetNode(target, target), context);
+			vector<Node*> implicitPath = implicitMap.DijkstraSearch(implicitMap.GetNode(0, 0), implicitMap.GetNode(target, target), context);
+			bool samePath = path.size() == implicitPath.size();
+			for (int i = 0; samePath && i < (int)path.size(); i++) {
+				samePath = path[i]->id == implicitPath[i]->id;
+			}
+
+			size_t legacyBytes = legacy.GetMemoryUsage();
+			size_t csrBytes = map.GetMemoryUsage();
+			size_t implicitBytes = implicitMap.GetMemoryUsage();
+
+			cout << "Graph layout benchmark: " << size << "x" << size << " grid, " << nodeCount << " nodes" << endl;
+			cout << setw(24) << "layout" << setw(16) << "bytes / node" << setw(16) << "edge scan (ms)" << endl;
+			cout << setw(24) << "per-node edge vectors" << fixed << setprecision(1) << setw(16) << (double)legacyBytes / nodeCount << setprecision(2) << setw(16) << legacyMs << endl;
+			cout << setw(24) << "compressed sparse row" << fixed << setprecision(1) << setw(16) << (double)csrBytes / nodeCount << setprecision(2) << setw(16) << csrMs << endl;
+			cout << setw(24) << "implicit 4-connected" << fixed << setprecision(1) << setw(16) << (double)implicitBytes / nodeCount << setprecision(2) << setw(16) << implicitMs << endl;
+			cout << "Edge sums " << CheckResult(legacySum == csrSum && csrSum == implicitSum, "match", "DIFFER") << ", corner to corner paths " << CheckResult(samePath, "match", "DIFFER") << endl << endl;
+		};
+
+		void BenchmarkMapGeometry(int size, float cellSize) {
+			vector<string> asciiMap = MakeBenchmarkGrid(size, 1234u);
+			NodeMap map;
+			map.Initialise(asciiMap, (int)cellSize, GridGraph::Implicit8);
+
+			// What drawing the map cell by cell costs every frame: a block and a label per wall, and a line per edge (each one twice, once from each end)
+			int wallCount = 0;
+			int edgeCount = 0;
+			for (int id = 0; id < map.GetNodeCount(); id++) {
+				if (!map.IsWalkable(id % size, id / size)) {
+					wallCount++;
+					continue;
+				}
+				map.ForEachNeighbour(id, [&](int, float) {
+					edgeCount++;
+				});
+			}
+
+			Clock::time_point start = Clock::now();
+			MapGeometry geometry;
+			geometry.Build(map);
+			double buildMs = MillisecondsSince(start);
+
+			// Every wall gets one block and one label, and every pair of connected cells gets exactly one line
+			bool rightGeometry = (int)geometry.GetWalls().size() == wallCount && (int)geometry.GetLabels().size() == wallCount && (int)geometry.GetLines().size() * 2 == edgeCount;
+			for (const MapLine& line : geometry.GetLines()) {
+				Node* from = map.GetClosestNode(glm::vec2((float)line.startX, (float)line.startY));
+				Node* to = map.GetClosestNode(glm::vec2((float)line.endX, (float)line.endY));
+				rightGeometry = rightGeometry && from != nullptr && to != nullptr && map.GetStepCost(from->id, to->id) > 0.0f && from->id < to->id;
+			}
+
+			// The geometry has to go stale when (and only when) the map changes
+			bool upToDate = geometry.IsUpToDate(map);
+			map.SetTileWalkable(size / 2, size / 2, !map.IsWalkable(size / 2, size / 2));
+			bool staleAfterEdit = !geometry.IsUpToDate(map);
+
+			cout << "Map geometry: " << size << "x" << size << " grid, " << wallCount << " walls, " << edgeCount / 2 << " edges" << endl;
+			cout << "Draw calls per frame: " << 2 * wallCount + edgeCount << " cell by cell, " << 2 * wallCount + edgeCount / 2 << " from the geometry, 1 when it fits in a texture. Building the geometry takes "
+				<< fixed << setprecision(2) << buildMs << " ms" << endl;
+			cout << "Geometry " << CheckResult(rightGeometry, "matches", "DIFFERS FROM") << " the map, " << CheckResult(upToDate && staleAfterEdit, "and goes stale on an edit", "but DOESN'T TRACK EDITS") << endl << endl;
+		};
+
+		// Builds and frees a Node for every walkable cell of a map, once with a separate new for each Node (as NodeMap used to) and once out of a NodeArena,
+		// comparing the time, the growth in resident memory and the time to read every Node back in order. Then builds and clears the whole NodeMap.
+		void BenchmarkNodeArena(int size, float cellSize) {
+			vector<string> asciiMap = MakeBenchmarkGrid(size, 1234u);
+			const int cellCount = size * size;
+			int walkableCount = 0;
+			for (const string& row : asciiMap) {
+				walkableCount += (int)count(row.begin(), row.end(), '1');
+			}
+
+			cout << "Node arena benchmark: " << size << "x" << size << " grid, " << walkableCount << " Nodes" << endl;
+			cout << setw(24) << "" << setw(12) << "build (ms)" << setw(14) << "free (ms)" << setw(14) << "RSS (MB)" << setw(14) << "read (ms)" << setw(14) << "allocations" << endl;
+
+			float totals[2] = { 0.0f, 0.0f };
+			for (int pass = 0; pass < 2; pass++) {
+				// The arena goes first: freeing a Node at a time can leave the memory in the process for a while, which would hide the arena's growth
+				const bool arena = pass == 0;
+				NodeArena nodeArena;
+				size_t residentBefore = ResidentBytes();
+
+				Clock::time_point start = Clock::now();
+				Node** nodes = new Node * [cellCount]();
+				if (arena) {
+					nodeArena.Reserve(walkableCount);
+				}
+				for (int y = 0; y < size; y++) {
+					for (int x = 0; x < size; x++) {
+						if (asciiMap[y][x] == '1') {
+							const int id = x + size * y;
+							const float centreX = ((float)x + 0.5f) * cellSize;
+							const float centreY = ((float)y + 0.5f) * cellSize;
+							if (arena) {
+								nodes[id] = nodeArena.Create(centreX, centreY, id);
+							}
+							else {
+								nodes[id] = new Node(centreX, centreY);
+								nodes[id]->id = id;
+							}
+						}
+					}
+				}
+				double buildMs = MillisecondsSince(start);
+				double residentMb = ((double)ResidentBytes() - (double)residentBefore) / (1024.0 * 1024.0);
+
+				// Visiting every Node in id order, the way a pass over the whole map (drawing it, or building something from it) does
+				start = Clock::now();
+				for (int id = 0; id < cellCount; id++) {
+					if (nodes[id] != nullptr) {
+						totals[pass] += nodes[id]->position.x;
+					}
+				}
+				double readMs = MillisecondsSince(start);
+
+				start = Clock::now();
+				if (arena) {
+					nodeArena.Clear();
+				}
+				else {
+					for (int id = 0; id < cellCount; id++) {
+						delete nodes[id];
+					}
+				}
+				delete[] nodes;
+				double freeMs = MillisecondsSince(start);
+
+				const int allocations = arena ? 2 : walkableCount + 1;
+				cout << setw(24) << (arena ? "NodeArena" : "a new per Node") << fixed << setprecision(1) << setw(12) << buildMs << setw(14) << freeMs << setw(14) << residentMb
+					<< setprecision(2) << setw(14) << readMs << setw(14) << allocations << endl;
+			}
+
+			// The whole graph, which now keeps its Nodes in an arena too. Closing and reopening cells must leave every Node where it was.
+			NodeMap map;
+			Clock::time_point start = Clock::now();
+			{
+				MuteConsole mute;
+				map.Initialise(asciiMap, (int)cellSize);
+			}
+			double buildMs = MillisecondsSince(start);
+			Node* corner = map.GetNode(0, 0);
+			map.SetTileWalkable(0, 0, false);
+			map.SetTileWalkable(0, 0, true);
+			map.SetTileWalkable(1, 1, true);
+			bool stable = corner != nullptr && map.GetNode(0, 0) == corner && map.GetNode(1, 1) != nullptr && map.GetNode(1, 1)->id == 1 + size;
+			start = Clock::now();
+			map.Initialise(vector<string>(1, "1"), (int)cellSize);
+			double clearMs = MillisecondsSince(start);
+			cout << "Both read back " << CheckResult(totals[0] == totals[1], "the same", "DIFFERENT") << " positions. NodeMap::Initialise builds the whole graph in " << setprecision(1) << buildMs
+				<< " ms and clears it in " << clearMs << " ms. Nodes " << CheckResult(stable, "stay put", "MOVED") << " when cells are closed and opened." << endl << endl;
+		};
+
+		// Returns false if the search ran past its time budget before reaching the end node
+		bool LegacyDijkstraSearch(LegacyNode* startNode, LegacyNode* endNode, double budgetMs, vector<LegacyNode*>& path) {
+			Clock::time_point start = Clock::now();
+
+			auto lambdaNodeSort = [](LegacyNode* const& lhs, LegacyNode* const& rhs) -> bool {
+				return lhs->gScore < rhs->gScore;
+			};
+
+			startNode->gScore = 0;
+			startNode->previousNode = nullptr;
+
+			vector<LegacyNode*> openList;
+			vector<LegacyNode*> closedList;
+			openList.push_back(startNode);
+
+			int counter = 0;
+			while (openList.size() != 0) {
+				// Checking the clock is slow next to a single iteration, so only look every so often
+				if (++counter % 256 == 0 && MillisecondsSince(start) > budgetMs) {
+					return false;
+				}
+
+				// A stable sort pins down the order of equal g scores, which std::sort leaves to the library (MSVC's std::sort is stable for short lists, like the demo map's)
+				stable_sort(openList.begin(), openList.end(), lambdaNodeSort);
+
+				LegacyNode* currentNode = *openList.begin();
+				if (currentNode == endNode) {
+					break;
+				}
+
+				openList.erase(find(openList.begin(), openList.end(), currentNode));
+				closedList.push_back(currentNode);
+
+				for (const pair<LegacyNode*, float>& edge : currentNode->connections) {
+					LegacyNode* target = edge.first;
+					if (find(closedList.begin(), closedList.end(), target) == closedList.end()) {
+						int calcdG = currentNode->gScore + (int)edge.second;
+
+						if (find(openList.begin(), openList.end(), target) == openList.end()) {
+							target->gScore = calcdG;
+							target->previousNode = currentNode;
+							openList.push_back(target);
+						}
+						else if (calcdG < target->gScore) {
+							target->gScore = calcdG;
+							target->previousNode = currentNode;
+						}
+					}
+				}
+			}
+
+			path.clear();
+			for (LegacyNode* node = endNode; node != nullptr; node = node->previousNode) {
+				path.insert(path.begin(), node);
+			}
+			return true;
+		};
+
+
+		// Builds a very large map as an implicit grid, which stores a bit per cell instead of a node and four edges
+		void BenchmarkLargeImplicitMap(int size, float cellSize) {
+			NodeMap map;
+			{
+				vector<string> asciiMap = MakeBenchmarkGrid(size, 1234u);
+				Clock::time_point start = Clock::now();
+				map.Initialise(asciiMap, (int)cellSize, GridGraph::Implicit8);
+				double buildMs = MillisecondsSince(start);
+				cout << "Implicit grid: " << size << "x" << size << " cells built in " << fixed << setprecision(0) << buildMs << " ms" << endl;
+			}
+
+			// Nodes only appear as they are asked for, and still have the same addresses when asked for again.
+			// The corner is the furthest cell with even coordinates, since those are never walls.
+			const int far = ((size - 1) / 2) * 2;
+			Node* corner = map.GetNode(far, far);
+			Node* closest = map.GetClosestNode(glm::vec2((far + 0.5f) * cellSize, (far + 0.5f) * cellSize));
+			cout << "Graph memory " << setprecision(1) << map.GetMemoryUsage() / (1024.0 * 1024.0) << " MB, far corner node " << CheckResult(corner != nullptr && corner == closest, "found", "MISSING") << endl << endl;
+		};
+
+
+		// Clicks all over (and just off) a map with big blocks of wall: the explicit graph answers GetClosestNode from its nearest-walkable table,
+		// the implicit graph by searching outwards from the cell, and both have to find a node the same number of steps away. Then again after doors open and close.
+		void BenchmarkClosestNode(int size, float cellSize) {
+			const int queryCount = 100000;
+			const int editCount = 2000;
+
+			// An open grid with a square block of wall stamped on it every so often
+			vector<string> asciiMap = MakeOpenGrid(size, 31u);
+			mt19937 random(8u);
+			for (int block = 0; block < size * size / 1024; block++) {
+				int left = (int)(random() % size);
+				int top = (int)(random() % size);
+				for (int y = top; y < top + 16 && y < size; y++) {
+					for (int x = left; x < left + 16 && x < size; x++) {
+						asciiMap[y][x] = '0';
+					}
+				}
+			}
+
+			NodeMap map;
+			Clock::time_point start = Clock::now();
+			map.Initialise(asciiMap, (int)cellSize);
+			double buildMs = MillisecondsSince(start);
+			NodeMap implicitMap;
+			implicitMap.Initialise(asciiMap, (int)cellSize, GridGraph::Implicit4);
+
+			vector<glm::vec2> clicks;
+			for (int i = 0; i < queryCount; i++) {
+				clicks.push_back(glm::vec2(((float)(random() % ((size + 4) * 16)) / 16.0f - 2.0f) * cellSize, ((float)(random() % ((size + 4) * 16)) / 16.0f - 2.0f) * cellSize));
+			}
+
+			// Returns the time per lookup in nanoseconds for each map, and whether every click found a node the same number of steps from the clicked cell
+			auto runClicks = [&](double& tableNs, double& searchNs) {
+				vector<Node*> tableNodes(queryCount);
+				vector<Node*> searchNodes(queryCount);
+				Clock::time_point start = Clock::now();
+				for (int i = 0; i < queryCount; i++) {
+					tableNodes[i] = map.GetClosestNode(clicks[i]);
+				}
+				tableNs = MillisecondsSince(start) * 1000000.0 / queryCount;
+				start = Clock::now();
+				for (int i = 0; i < queryCount; i++) {
+					searchNodes[i] = implicitMap.GetClosestNode(clicks[i]);
+				}
+				searchNs = MillisecondsSince(start) * 1000000.0 / queryCount;
+
+				bool same = true;
+				for (int i = 0; i < queryCount && same; i++) {
+					int x = min(max((int)floor(clicks[i].x / cellSize), 0), size - 1);
+					int y = min(max((int)floor(clicks[i].y / cellSize), 0), size - 1);
+					same = tableNodes[i] != nullptr && searchNodes[i] != nullptr && map.IsWalkable(tableNodes[i]->id % size, tableNodes[i]->id / size)
+						&& abs(tableNodes[i]->id % size - x) + abs(tableNodes[i]->id / size - y) == abs(searchNodes[i]->id % size - x) + abs(searchNodes[i]->id / size - y);
+				}
+				return same;
+			};
+
+			cout << "Closest node benchmark: " << size << "x" << size << " grid with blocks of wall, " << queryCount << " clicks (explicit graph built with its table in " << fixed << setprecision(1) << buildMs << " ms)" << endl;
+			cout << setw(24) << "" << setw(16) << "table (ns)" << setw(16) << "search (ns)" << setw(16) << "same distance" << endl;
+			double tableNs;
+			double searchNs;
+			bool same = runClicks(tableNs, searchNs);
+			cout << setw(24) << "as built" << setprecision(1) << setw(16) << tableNs << setw(16) << searchNs << setw(16) << CheckResult(same) << endl;
+
+			// Open and close cells all over the map, mostly inside the blocks of wall where they change the most answers
+			start = Clock::now();
+			for (int i = 0; i < editCount; i++) {
+				int x = (int)(random() % size);
+				int y = (int)(random() % size);
+				bool walkable = !map.IsWalkable(x, y);
+				map.SetTileWalkable(x, y, walkable);
+				implicitMap.SetTileWalkable(x, y, walkable);
+			}
+			double editUs = MillisecondsSince(start) * 1000.0 / editCount;
+			same = runClicks(tableNs, searchNs);
+			cout << setw(24) << "after edits" << setprecision(1) << setw(16) << tableNs << setw(16) << searchNs << setw(16) << CheckResult(same) << endl;
+			cout << "Each edit took " << setprecision(2) << editUs << " us on both maps, patching the table included" << endl << endl;
+		};
+
+		// A map split into rooms by walls with doors in only some of them, so plenty of random queries have no path at all.
+		// Times those queries rejected by their component labels against the search running out of nodes, then opens and closes doors
+		// and checks the labels kept up to date by SetTileWalkable split the map the same way as labels built from scratch.
+		void BenchmarkConnectedComponents(int size, float cellSize) {
+			const int queryCount = 20;
+			const int editCount = 2000;
+			const int roomSize = size / 4;
+
+			vector<string> asciiMap = MakeOpenGrid(size, 77u);
+			mt19937 random(21u);
+			for (int i = roomSize; i < size; i += roomSize) {
+				for (int j = 0; j < size; j++) {
+					asciiMap[i][j] = '0';
+					asciiMap[j][i] = '0';
+				}
+			}
+			for (int i = roomSize; i < size; i += roomSize) {
+				for (int room = 0; room < size; room += roomSize) {
+					if (random() % 2 == 0) {
+						asciiMap[i][room + roomSize / 2] = '1';
+					}
+					if (random() % 2 == 0) {
+						asciiMap[room + roomSize / 2][i] = '1';
+					}
+				}
+			}
+
+			NodeMap map;
+			map.Initialise(asciiMap, (int)cellSize);
+			SearchContext context(map.GetNodeCount());
+			auto randomNode = [&]() {
+				Node* node = nullptr;
+				while (node == nullptr) {
+					node = map.GetNode((int)(random() % size), (int)(random() % size));
+				}
+				return node;
+			};
+
+			// Every query is run both ways: as a search, rejected straight away when the ends are in different components,
+			// and as a full shortest path tree from the start, which is what the search used to do before finding there was no path
+			int unreachable = 0;
+			double rejectedMs = 0.0;
+			double drainedMs = 0.0;
+			bool same = true;
+			for (int i = 0; i < queryCount; i++) {
+				Node* start = randomNode();
+				Node* end = randomNode();
+				Clock::time_point queryStart = Clock::now();
+				vector<Node*> path = map.DijkstraSearch(start, end, context);
+				double searchMs = MillisecondsSince(queryStart);
+				queryStart = Clock::now();
+				map.BuildShortestPathTree(start, context);
+				double treeMs = MillisecondsSince(queryStart);
+
+				bool reachable = context.GetGScore(end->id) != numeric_limits<float>::infinity();
+				same = same && reachable == map.AreConnected(start, end) && reachable == !path.empty();
+				if (!reachable) {
+					unreachable++;
+					rejectedMs += searchMs;
+					drainedMs += treeMs;
+				}
+			}
+
+			// Two sets of labels agree if they pair up one to one across every cell
+			auto samePartition = [&](const NodeMap& a, const NodeMap& b) {
+				vector<int> aToB(a.GetNodeCount() + 1, -1);
+				vector<int> bToA(b.GetNodeCount() + 1, -1);
+				bool agree = a.GetComponentCount() == b.GetComponentCount();
+				for (int id = 0; id < a.GetNodeCount() && agree; id++) {
+					int labelA = a.GetComponent(id) + 1;
+					int labelB = b.GetComponent(id) + 1;
+					agree = (aToB[labelA] < 0 || aToB[labelA] == labelB) && (bToA[labelB] < 0 || bToA[labelB] == labelA);
+					aToB[labelA] = labelB;
+					bToA[labelB] = labelA;
+				}
+				return agree;
+			};
+
+			// Open and shut the doorways and cells along the walls, which join and split rooms, and close cells inside the rooms too
+			Clock::time_point editStart = Clock::now();
+			for (int i = 0; i < editCount; i++) {
+				int wall = roomSize * (1 + (int)(random() % 3));
+				int along = (int)(random() % size);
+				int x = i % 3 == 0 ? wall : (i % 3 == 1 ? along : (int)(random() % size));
+				int y = i % 3 == 0 ? along : (i % 3 == 1 ? wall : (int)(random() % size));
+				bool walkable = i % 3 == 2 ? false : random() % 2 == 0;
+				map.SetTileWalkable(x, y, walkable);
+				asciiMap[y][x] = walkable ? '1' : '0';
+			}
+			double editMs = MillisecondsSince(editStart) / editCount;
+
+			NodeMap rebuilt;
+			Clock::time_point buildStart = Clock::now();
+			rebuilt.Initialise(asciiMap, (int)cellSize);
+			double buildMs = MillisecondsSince(buildStart);
+
+			cout << "Connected components benchmark: " << size << "x" << size << " map of 16 rooms, " << queryCount << " random queries (" << unreachable << " with no path)" << endl;
+			cout << setw(32) << "" << setw(16) << "time (ms)" << setw(16) << "agree" << endl;
+			cout << setw(32) << "unreachable, rejected" << fixed << setprecision(4) << setw(16) << (unreachable > 0 ? rejectedMs / unreachable : 0.0) << setw(16) << CheckResult(same) << endl;
+			cout << setw(32) << "unreachable, searched out" << setw(16) << (unreachable > 0 ? drainedMs / unreachable : 0.0) << endl;
+			cout << setw(32) << "edit (per SetTileWalkable)" << setw(16) << editMs << setw(16) << CheckResult(samePartition(map, rebuilt)) << endl;
+			cout << setw(32) << "whole map built again" << setw(16) << buildMs << endl;
+			cout << map.GetComponentCount() << " components after " << editCount << " edits" << endl << endl;
+		};
+
+		// A crowd of agents all clicked to new destinations in the same frame, part way along paths they were already following.
+		// Searching every path at once holds that one frame up for all of them; the scheduler spreads the same searches over the following frames within a budget,
+		// while the agents keep walking. Every agent has to end up at its new destination either way, and a PathQuery stepped a few hundred nodes at a time
+		// has to find exactly the path DijkstraSearch does.
+		void BenchmarkPathScheduler(int size, float cellSize) {
+			const int agentCount = 16;
+			const int nodeBudget = 20000;
+			const double microsecondBudget = 2000.0;
+			const float frameTime = 1.0f / 60.0f;
+
+			NodeMap map;
+			map.Initialise(MakeOpenGrid(size, 2024u), (int)cellSize);
+			SearchContext context(map.GetNodeCount());
+			mt19937 random(3u);
+			auto randomNode = [&]() {
+				Node* node = nullptr;
+				while (node == nullptr) {
+					node = map.GetNode((int)(random() % size), (int)(random() % size));
+				}
+				return node;
+			};
+
+			// Where each agent starts, where it's first heading, and where it's sent once it's on its way
+			vector<Node*> starts;
+			vector<Node*> firstEnds;
+			vector<Node*> ends;
+			while ((int)starts.size() < agentCount) {
+				Node* start = randomNode();
+				Node* firstEnd = randomNode();
+				Node* end = randomNode();
+				if (map.AreConnected(start, firstEnd) && map.AreConnected(start, end)) {
+					starts.push_back(start);
+					firstEnds.push_back(firstEnd);
+					ends.push_back(end);
+				}
+			}
+
+			// Returns true if every agent got where it was sent
+			auto walkAll = [&](vector<PathAgent>& agents) {
+				MuteConsole mute;
+				bool moving = true;
+				for (int frame = 0; moving && frame < 1000000; frame++) {
+					moving = false;
+					for (PathAgent& agent : agents) {
+						agent.Update(frameTime);
+						moving = moving || agent.IsMoving();
+					}
+				}
+				bool arrived = true;
+				for (int i = 0; i < agentCount; i++) {
+					arrived = arrived && agents[i].GetCurrentNode() == ends[i];
+				}
+				return arrived;
+			};
+
+			cout << "Path scheduler benchmark: " << size << "x" << size << " open grid, " << agentCount << " agents given new destinations in the same frame" << endl;
+			cout << setw(28) << "" << setw(10) << "frames" << setw(18) << "worst frame (ms)" << setw(18) << "searching (ms)" << setw(12) << "arrived" << endl;
+
+			// 0: every search in the frame of the click, 1: the scheduler with a node budget, 2: the scheduler with a time budget
+			const char* names[3] = { "all at once", "", "" };
+			string budgetNames[2] = { "scheduler, " + to_string(nodeBudget) + " nodes/frame", "scheduler, " + to_string((int)(microsecondBudget / 1000.0)) + " ms/frame" };
+			for (int mode = 0; mode < 3; mode++) {
+				vector<PathAgent> agents(agentCount);
+				{
+					MuteConsole mute;
+					for (int i = 0; i < agentCount; i++) {
+						agents[i].SetMap(&map);
+						agents[i].SetSpeed(400);
+						agents[i].SetNode(starts[i]);
+						agents[i].SetPath(map.DijkstraSearch(starts[i], firstEnds[i], context));
+					}
+					for (int frame = 0; frame < 30; frame++) {
+						for (PathAgent& agent : agents) {
+							agent.Update(frameTime);
+						}
+					}
+				}
+
+				int frames = 0;
+				double worstFrameMs = 0.0;
+				double totalMs = 0.0;
+				if (mode == 0) {
+					Clock::time_point start = Clock::now();
+					for (int i = 0; i < agentCount; i++) {
+						agents[i].GoToNode(ends[i], context);
+					}
+					worstFrameMs = totalMs = MillisecondsSince(start);
+					frames = 1;
+				}
+				else {
+					PathScheduler scheduler(map);
+					for (int i = 0; i < agentCount; i++) {
+						agents[i].GoToNode(ends[i], scheduler);
+					}
+					while (scheduler.GetPendingCount() > 0) {
+						Clock::time_point start = Clock::now();
+						if (mode == 1) {
+							scheduler.Update(nodeBudget);
+						}
+						else {
+							scheduler.Update(map.GetNodeCount(), microsecondBudget);
+						}
+						double frameMs = MillisecondsSince(start);
+						worstFrameMs = max(worstFrameMs, frameMs);
+						totalMs += frameMs;
+						frames++;
+
+						MuteConsole mute;
+						for (PathAgent& agent : agents) {
+							agent.Update(frameTime);
+						}
+					}
+				}
+
+				bool arrived = walkAll(agents);
+				cout << setw(28) << (mode == 0 ? names[0] : budgetNames[mode - 1].c_str()) << setw(10) << frames << fixed << setprecision(3) << setw(18) << worstFrameMs << setw(18) << totalMs
+					<< setw(12) << CheckResult(arrived) << endl;
+			}
+
+			// The same searches a slice of 500 nodes at a time, which have to give exactly DijkstraSearch's paths
+			bool samePaths = true;
+			int slices = 0;
+			PathQuery query(map);
+			for (int i = 0; i < agentCount; i++) {
+				query.Start(starts[i], ends[i]);
+				while (!query.IsDone()) {
+					query.Step(500);
+				}
+				slices += query.GetSliceCount();
+				samePaths = samePaths && query.GetStatus() == PathQuery::Status::Found && query.GetPath() == map.DijkstraSearch(starts[i], ends[i], context);
+			}
+			cout << "PathQuery stepped 500 nodes at a time (" << slices / agentCount << " steps a search) finds the same paths as DijkstraSearch: " << CheckResult(samePaths) << endl << endl;
+		};
+
+		// Writes a very large map to disk in both file formats, then loads it the old way (reading every line into a string for Initialise) and with MapLoader
+		void BenchmarkMapLoader(int size, float cellSize) {
+			const char* asciiFile = "benchmark_map.txt";
+			const char* movingAiFile = "benchmark_map.map";
+			{
+				vector<string> asciiMap = MakeBenchmarkGrid(size, 1234u);
+				ofstream ascii(asciiFile, ios::binary);
+				ofstream movingAi(movingAiFile, ios::binary);
+				movingAi << "type octile\nheight " << size << "\nwidth " << size << "\nmap\n";
+				for (string& row : asciiMap) {
+					ascii << row << '\n';
+					replace(row.begin(), row.end(), '1', '.');
+					replace(row.begin(), row.end(), '0', '@');
+					movingAi << row << '\n';
+				}
+			}
+
+			NodeMap lineByLine;
+			Clock::time_point start = Clock::now();
+			{
+				vector<string> asciiMap;
+				ifstream file(asciiFile);
+				string line;
+				while (getline(file, line)) {
+					asciiMap.push_back(line);
+				}
+				lineByLine.Initialise(asciiMap, (int)cellSize, GridGraph::Implicit8);
+			}
+			double lineByLineMs = MillisecondsSince(start);
+
+			MapLoader loader;
+			NodeMap asciiMapped;
+			bool asciiLoaded = loader.Load(asciiFile, asciiMapped, (int)cellSize, GridGraph::Implicit8) && loader.GetMalformedRowCount() == 0;
+			double asciiMs = loader.GetMilliseconds();
+			NodeMap movingAiMapped;
+			bool movingAiLoaded = loader.Load(movingAiFile, movingAiMapped, (int)cellSize, GridGraph::Implicit8) && loader.GetMalformedRowCount() == 0;
+			double movingAiMs = loader.GetMilliseconds();
+
+			bool sameCells = asciiLoaded && movingAiLoaded && asciiMapped.GetWidth() == size && movingAiMapped.GetHeight() == size;
+			for (int y = 0; sameCells && y < size; y++) {
+				for (int x = 0; x < size; x++) {
+					bool walkable = lineByLine.IsWalkable(x, y);
+					sameCells = sameCells && asciiMapped.IsWalkable(x, y) == walkable && movingAiMapped.IsWalkable(x, y) == walkable;
+				}
+			}
+			remove(asciiFile);
+			remove(movingAiFile);
+
+			// A broken file: one short row, one row with a character that isn't in the format, and a row missing off the end
+			{
+				ofstream broken(movingAiFile, ios::binary);
+				broken << "type octile\r\nheight 4\r\nwidth 4\r\nmap\r\n....\r\n..\r\n.?..\r\n";
+			}
+			NodeMap brokenMap;
+			bool brokenLoaded = loader.Load(movingAiFile, brokenMap, (int)cellSize);
+			bool brokenReported = brokenLoaded && loader.GetMalformedRowCount() == 3 && loader.GetMalformedRows() == vector<int>({ 1, 2, 3 })
+				&& brokenMap.IsWalkable(3, 0) && !brokenMap.IsWalkable(3, 1) && !brokenMap.IsWalkable(1, 2) && !brokenMap.IsWalkable(0, 3);
+			remove(movingAiFile);
+
+			cout << "Map loading: " << size << "x" << size << " implicit grid" << endl;
+			cout << setw(28) << "lines into strings" << fixed << setprecision(0) << setw(10) << lineByLineMs << " ms" << endl;
+			cout << setw(28) << "memory-mapped ascii" << setw(10) << asciiMs << " ms" << endl;
+			cout << setw(28) << "memory-mapped Moving AI" << setw(10) << movingAiMs << " ms" << endl;
+			cout << "Loaded cells " << CheckResult(sameCells, "match", "DIFFER") << ", malformed rows " << CheckResult(brokenReported, "reported", "NOT REPORTED") << endl << endl;
+		};
+
+
+		// Times the old sorted-vector search against the heap-based NodeMap::DijkstraSearch on queries of growing length
+		void BenchmarkOpenList(int size, float cellSize) {
+			vector<string> asciiMap = MakeBenchmarkGrid(size, 1234u);
+
+			NodeMap map;
+			{
+				MuteConsole mute;
+				map.Initialise(asciiMap, (int)cellSize);
+			}
+			LegacyGraph legacy(asciiMap);
+			SearchContext context(map.GetNodeCount());
+
+			cout << "Open list benchmark: " << size << "x" << size << " grid" << endl;
+			cout << setw(8) << "span" << setw(12) << "path nodes" << setw(20) << "sorted vector (ms)" << setw(12) << "heap (ms)" << setw(10) << "speedup" << setw(12) << "same path" << endl;
+
+			bool legacyFinished = true;
+			for (int span = 16; ; span *= 4) {
+				// Queries run from the corner along the diagonal; even cells are never walls
+				int target = span < size - 1 ? span : ((size - 1) / 2) * 2;
+
+				Clock::time_point start = Clock::now();
+				vector<Node*> path;
+				{
+					MuteConsole mute;
+					path = map.DijkstraSearch(map.GetNode(0, 0), map.GetNode(target, target), context);
+				}
+				double heapMs = MillisecondsSince(start);
+
+				cout << setw(8) << target << setw(12) << path.size();
+
+				// Once the old search has blown its budget, every longer query would too
+				vector<LegacyNode*> legacyPath;
+				double legacyMs = 0.0;
+				if (legacyFinished) {
+					start = Clock::now();
+					legacyFinished = LegacyDijkstraSearch(legacy.Get(0, 0), legacy.Get(target, target), legacyBudgetMs, legacyPath);
+					legacyMs = MillisecondsSince(start);
+				}
+
+				if (legacyFinished) {
+					bool samePath = legacyPath.size() == path.size();
+					for (int i = 0; samePath && i < (int)path.size(); i++) {
+						samePath = path[i] == map.GetNode(legacyPath[i]->x, legacyPath[i]->y);
+					}
+
+					cout << fixed << setprecision(2) << setw(20) << legacyMs << setw(12) << heapMs << setw(9) << legacyMs / heapMs << "x" << setw(12) << CheckResult(samePath) << endl;
+				}
+				else {
+					cout << setw(20) << (legacyMs > 0.0 ? "> budget" : "skipped") << fixed << setprecision(2) << setw(12) << heapMs << setw(10) << "-" << setw(12) << "-" << endl;
+				}
+
+				if (target != span) {
+					break;
+				}
+			}
+			cout << endl;
+		};
+
+
+		// Runs the same set of random queries with DijkstraSearch and with AStarSearch under each heuristic, reporting the average work per query
+		template<typename Heuristic>
+		void RunHeuristicQueries(const char* name, NodeMap& map, const vector<pair<Node*, Node*>>& queries, const vector<size_t>& expectedLengths, SearchContext& context) {
+			double expanded = 0.0;
+			double milliseconds = 0.0;
+			bool sameLengths = true;
+
+			for (size_t i = 0; i < queries.size(); i++) {
+				vector<Node*> path = map.AStarSearch<Heuristic>(queries[i].first, queries[i].second, context);
+				expanded += context.GetStats().nodesExpanded;
+				milliseconds += context.GetStats().milliseconds;
+				sameLengths = sameLengths && path.size() == expectedLengths[i];
+			}
+
+			cout << setw(24) << name << fixed << setprecision(0) << setw(16) << expanded / queries.size() << setprecision(3) << setw(14) << milliseconds / queries.size() << setw(16) << CheckResult(sameLengths) << endl;
+		};
+
+		void BenchmarkHeuristics(int size, float cellSize) {
+			const int queryCount = 20;
+
+			vector<string> asciiMap = MakeBenchmarkGrid(size, 1234u);
+			NodeMap map;
+			{
+				MuteConsole mute;
+				map.Initialise(asciiMap, (int)cellSize);
+			}
+			SearchContext context(map.GetNodeCount());
+
+			// Random start and end cells, picked from the even cells which are never walls
+			mt19937 random(42u);
+			vector<pair<Node*, Node*>> queries;
+			for (int i = 0; i < queryCount; i++) {
+				Node* start = map.GetNode((int)(random() % (size / 2)) * 2, (int)(random() % (size / 2)) * 2);
+				Node* end = map.GetNode((int)(random() % (size / 2)) * 2, (int)(random() % (size / 2)) * 2);
+				queries.push_back(make_pair(start, end));
+			}
+
+			cout << "Heuristic benchmark: " << size << "x" << size << " grid, " << queryCount << " random queries (averages per query)" << endl;
+			cout << setw(24) << "search" << setw(16) << "nodes expanded" << setw(14) << "time (ms)" << setw(16) << "optimal length" << endl;
+
+			// DijkstraSearch sets the reference path lengths every other search has to match
+			vector<size_t> expectedLengths;
+			double expanded = 0.0;
+			double milliseconds = 0.0;
+			for (const pair<Node*, Node*>& query : queries) {
+				MuteConsole mute;
+				expectedLengths.push_back(map.DijkstraSearch(query.first, query.second, context).size());
+				expanded += context.GetStats().nodesExpanded;
+				milliseconds += context.GetStats().milliseconds;
+			}
+			cout << setw(24) << "DijkstraSearch" << fixed << setprecision(0) << setw(16) << expanded / queryCount << setprecision(3) << setw(14) << milliseconds / queryCount << setw(16) << "-" << endl;
+
+			RunHeuristicQueries<ZeroHeuristic>("A* (zero)", map, queries, expectedLengths, context);
+			RunHeuristicQueries<EuclideanHeuristic>("A* (euclidean)", map, queries, expectedLengths, context);
+			RunHeuristicQueries<OctileHeuristic>("A* (octile)", map, queries, expectedLengths, context);
+			RunHeuristicQueries<ManhattanHeuristic>("A* (manhattan)", map, queries, expectedLengths, context);
+			cout << endl;
+		};
+	}
+
+
+	namespace {
+		// Runs the same random queries with A* and with Jump Point Search, without and with the JPS+ tables, on one graph mode of an open map
+		template<typename Heuristic>
+		void RunJumpPointQueries(const vector<string>& asciiMap, float cellSize, GridGraph graph, const char* graphName, int queryCount) {
+			NodeMap map;
+			map.Initialise(asciiMap, (int)cellSize, graph);
+			SearchContext context(map.GetNodeCount());
+			int size = map.GetWidth();
+
+			mt19937 random(99u);
+			vector<pair<Node*, Node*>> queries;
+			while ((int)queries.size() < queryCount) {
+				Node* start = map.GetNode((int)(random() % size), (int)(random() % size));
+				Node* end = map.GetNode((int)(random() % size), (int)(random() % size));
+				if (start != nullptr && end != nullptr) {
+					queries.push_back(make_pair(start, end));
+				}
+			}
+
+			JumpPointSearch jumpPointSearch(map);
+			JumpPointSearch jumpPointSearchPlus(map);
+			Clock::time_point start = Clock::now();
+			jumpPointSearchPlus.BuildJumpTables();
+			double tableMs = MillisecondsSince(start);
+
+			// A* sets the reference path costs the jump point searches have to match
+			vector<float> costs;
+			double expanded[3] = { 0.0, 0.0, 0.0 };
+			double milliseconds[3] = { 0.0, 0.0, 0.0 };
+			bool sameCosts[2] = { true, true };
+			for (const pair<Node*, Node*>& query : queries) {
+				map.AStarSearch<Heuristic>(query.first, query.second, context);
+				float cost = context.GetGScore(query.second->id);
+				expanded[0] += context.GetStats().nodesExpanded;
+				milliseconds[0] += context.GetStats().milliseconds;
+
+				for (int i = 0; i < 2; i++) {
+					(i == 0 ? jumpPointSearch : jumpPointSearchPlus).FindPath(query.first, query.second, context);
+					expanded[i + 1] += context.GetStats().nodesExpanded;
+					milliseconds[i + 1] += context.GetStats().milliseconds;
+					float jumpCost = context.GetGScore(query.second->id);
+					sameCosts[i] = sameCosts[i] && (jumpCost == cost || fabs(jumpCost - cost) < 0.001f * (cost + 1.0f));
+				}
+			}
+
+			const char* names[3] = { "A*", "JPS", "JPS+" };
+			for (int i = 0; i < 3; i++) {
+				cout << setw(16) << graphName << setw(8) << names[i] << fixed << setprecision(0) << setw(16) << expanded[i] / queryCount << setprecision(3) << setw(14) << milliseconds[i] / queryCount
+					<< setw(16) << (i == 0 ? "-" : CheckResult(sameCosts[i - 1])) << endl;
+			}
+			cout << setw(16) << graphName << " JPS+ tables built in " << setprecision(1) << tableMs << " ms" << endl;
+		};
+
+		// Compares A* with Jump Point Search on an open map, for both the 4-connected and the 8-connected grid
+		void BenchmarkJumpPointSearch(int size, float cellSize) {
+			const int queryCount = 20;
+			vector<string> asciiMap = MakeOpenGrid(size, 1234u);
+
+			cout << "Jump Point Search benchmark: " << size << "x" << size << " open grid, " << queryCount << " random queries (averages per query)" << endl;
+			cout << setw(16) << "graph" << setw(8) << "search" << setw(16) << "nodes expanded" << setw(14) << "time (ms)" << setw(16) << "optimal cost" << endl;
+			RunJumpPointQueries<ManhattanHeuristic>(asciiMap, cellSize, GridGraph::Implicit4, "4-connected", queryCount);
+			RunJumpPointQueries<OctileHeuristic>(asciiMap, cellSize, GridGraph::Implicit8, "8-connected", queryCount);
+			cout << endl;
+		};
+
+		// Runs the same random queries with A* and with Lazy Theta* on one graph mode of an open map, then walks a PathAgent down each path.
+		// Every straight line of a Theta* path is checked against the walls by stepping along it a hundredth of a cell at a time, independently of HasLineOfSight.
+		template<typename Heuristic>
+		void RunAnyAngleQueries(const vector<string>& asciiMap, float cellSize, GridGraph graph, const char* graphName, int queryCount) {
+			NodeMap map;
+			map.Initialise(asciiMap, (int)cellSize, graph);
+			SearchContext context(map.GetNodeCount());
+			AnyAngleSearch anyAngleSearch(map);
+			int size = map.GetWidth();
+
+			// Only the explicit graph labels its components (AreConnected is always true on the implicit ones), so the same map built
+			// that way picks out the pairs that really have a path between them
+			NodeMap reachability;
+			reachability.Initialise(asciiMap, (int)cellSize);
+
+			mt19937 random(99u);
+			vector<pair<Node*, Node*>> queries;
+			while ((int)queries.size() < queryCount) {
+				int startX = (int)(random() % size);
+				int startY = (int)(random() % size);
+				int endX = (int)(random() % size);
+				int endY = (int)(random() % size);
+				Node* start = map.GetNode(startX, startY);
+				Node* end = map.GetNode(endX, endY);
+				if (start != nullptr && end != nullptr && reachability.AreConnected(reachability.GetNode(startX, startY), reachability.GetNode(endX, endY))) {
+					queries.push_back(make_pair(start, end));
+				}
+			}
+
+			auto pathLength = [&](const vector<Node*>& path) {
+				float length = 0.0f;
+				for (size_t i = 1; i < path.size(); i++) {
+					length += glm::length(path[i]->position - path[i - 1]->position) / cellSize;
+				}
+				return length;
+			};
+			auto linesClear = [&](const vector<Node*>& path) {
+				for (size_t i = 1; i < path.size(); i++) {
+					glm::vec2 from = path[i - 1]->position / cellSize;
+					glm::vec2 to = path[i]->position / cellSize;
+					int steps = (int)(glm::length(to - from) * 100.0f) + 1;
+					for (int step = 0; step <= steps; step++) {
+						glm::vec2 point = from + (to - from) * ((float)step / steps);
+						if (!map.IsWalkable((int)floor(point.x), (int)floor(point.y))) {
+							return false;
+						}
+					}
+				}
+				return true;
+			};
+
+			// Walk an agent from the start of the path to its end, returning how long all of its Update calls took (including the line it prints at every waypoint)
+			auto walk = [&](const vector<Node*>& path) {
+				if (path.empty()) {
+					return 0.0;
+				}
+				MuteConsole mute;
+				PathAgent agent;
+				agent.SetNode(path.front());
+				agent.SetSpeed(400);
+				agent.SetPath(path);
+				Clock::time_point start = Clock::now();
+				while (agent.IsMoving()) {
+					agent.Update(1.0f / 60.0f);
+				}
+				return MillisecondsSince(start);
+			};
+
+			const char* names[2] = { "A*", "Lazy Theta*" };
+			double expanded[2] = { 0.0, 0.0 };
+			double milliseconds[2] = { 0.0, 0.0 };
+			double waypoints[2] = { 0.0, 0.0 };
+			double lengths[2] = { 0.0, 0.0 };
+			double walkMs[2] = { 0.0, 0.0 };
+			bool clear = true;
+			for (const pair<Node*, Node*>& query : queries) {
+				for (int i = 0; i < 2; i++) {
+					vector<Node*> path = i == 0 ? map.AStarSearch<Heuristic>(query.first, query.second, context) : anyAngleSearch.FindPath(query.first, query.second, context);
+					expanded[i] += context.GetStats().nodesExpanded;
+					milliseconds[i] += context.GetStats().milliseconds;
+					waypoints[i] += path.size();
+					lengths[i] += pathLength(path);
+					walkMs[i] += walk(path);
+					clear = clear && (i == 0 || (!path.empty() && path.front() == query.first && path.back() == query.second && linesClear(path)));
+				}
+			}
+
+			for (int i = 0; i < 2; i++) {
+				cout << setw(16) << graphName << setw(14) << names[i] << fixed << setprecision(0) << setw(16) << expanded[i] / queryCount << setprecision(3) << setw(12) << milliseconds[i] / queryCount
+					<< setprecision(1) << setw(12) << waypoints[i] / queryCount << setw(14) << lengths[i] / queryCount << setprecision(3) << setw(14) << walkMs[i] / queryCount
+					<< setw(14) << (i == 0 ? "-" : CheckResult(clear)) << endl;
+			}
+		};
+
+		// Compares A* with Lazy Theta* on an open map, for both the 4-connected and the 8-connected grid: the work each search does,
+		// how many waypoints and how long its paths are (in cells), and how long a PathAgent spends in Update following them
+		void BenchmarkAnyAngleSearch(int size, float cellSize) {
+			const int queryCount = 20;
+			vector<string> asciiMap = MakeOpenGrid(size, 1234u);
+
+			cout << "Any-angle search benchmark: " << size << "x" << size << " open grid, " << queryCount << " random queries (averages per query)" << endl;
+			cout << setw(16) << "graph" << setw(14) << "search" << setw(16) << "nodes expanded" << setw(12) << "time (ms)" << setw(12) << "waypoints" << setw(14) << "length" << setw(14) << "walk (ms)" << setw(14) << "lines clear" << endl;
+			RunAnyAngleQueries<ManhattanHeuristic>(asciiMap, cellSize, GridGraph::Explicit, "4-connected", queryCount);
+			RunAnyAngleQueries<OctileHeuristic>(asciiMap, cellSize, GridGraph::Implicit8, "8-connected", queryCount);
+			cout << endl;
+		};
+
+		// Cold start from an ascii map (build the graph and the JPS+ tables) against loading a snapshot of the finished graph
+		void RunSnapshot(const vector<string>& asciiMap, float cellSize, GridGraph graph, const char* graphName) {
+			const char* snapshotFile = "benchmark_map.snapshot";
+			const int size = (int)asciiMap.size();
+
+			// Some rough ground, so the tile costs go into the snapshot too
+			Clock::time_point start = Clock::now();
+			NodeMap built;
+			built.Initialise(asciiMap, (int)cellSize, graph);
+			for (int i = 1; i < size; i += 7) {
+				built.SetTileCost(i, 0, 2.0f);
+			}
+			JumpPointSearch builtSearch(built);
+			builtSearch.BuildJumpTables();
+			double buildMs = MillisecondsSince(start);
+
+			start = Clock::now();
+			bool saved = MapSnapshot::Save(snapshotFile, built, &builtSearch);
+			double saveMs = MillisecondsSince(start);
+
+			start = Clock::now();
+			NodeMap loaded;
+			JumpPointSearch loadedSearch(loaded);
+			string error;
+			bool loadedOk = saved && MapSnapshot::Load(snapshotFile, loaded, &loadedSearch, &error);
+			double loadMs = MillisecondsSince(start);
+
+			// Every cell, edge and cost has to come back exactly as it was, along with tables the search will use
+			bool sameGraph = loadedOk && loaded.GetWidth() == size && loaded.GetHeight() == size && loaded.GetGraph() == graph && loadedSearch.HasJumpTables() && !loaded.HasUniformCosts();
+			for (int id = 0; sameGraph && id < built.GetNodeCount(); id++) {
+				Node* a = built.GetNodeById(id);
+				Node* b = loaded.GetNodeById(id);
+				sameGraph = (a == nullptr) == (b == nullptr) && (a == nullptr || a->position == b->position);
+				vector<pair<int, float>> edgesA;
+				vector<pair<int, float>> edgesB;
+				built.ForEachNeighbour(id, [&](int target, float cost) { edgesA.push_back(make_pair(target, cost)); });
+				loaded.ForEachNeighbour(id, [&](int target, float cost) { edgesB.push_back(make_pair(target, cost)); });
+				sameGraph = sameGraph && edgesA == edgesB;
+			}
+
+			// A snapshot with one byte changed has to be turned away, leaving the map alone
+			{
+				vector<char> bytes;
+				{
+					ifstream in(snapshotFile, ios::binary);
+					bytes.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+				}
+				bytes[bytes.size() / 2] ^= 1;
+				ofstream out(snapshotFile, ios::binary);
+				out.write(bytes.data(), bytes.size());
+			}
+			bool corruptRejected = !MapSnapshot::Load(snapshotFile, loaded, nullptr) && loaded.GetWidth() == size && loadedSearch.HasJumpTables();
+			remove(snapshotFile);
+
+			cout << setw(16) << graphName << fixed << setprecision(1) << setw(24) << buildMs << setw(12) << saveMs << setw(12) << loadMs << setw(14) << CheckResult(sameGraph) << setw(18) << CheckResult(corruptRejected)
+				<< (loadedOk ? "" : "   (" + error + ")") << endl;
+		};
+
+		void BenchmarkSnapshot(int size, float cellSize) {
+			vector<string> asciiMap = MakeOpenGrid(size, 555u);
+
+			cout << "Snapshot benchmark: " << size << "x" << size << " open grid with tile costs and JPS+ tables" << endl;
+			cout << setw(16) << "graph" << setw(24) << "build from ascii (ms)" << setw(12) << "save (ms)" << setw(12) << "load (ms)" << setw(14) << "same graph" << setw(18) << "rejects corrupt" << endl;
+			RunSnapshot(asciiMap, cellSize, GridGraph::Explicit, "explicit");
+			RunSnapshot(asciiMap, cellSize, GridGraph::Implicit8, "8-connected");
+			cout << endl;
+		};
+	}
+
+
+	namespace {
+		// Compares A* with the hierarchical search on a 4-connected open map: the abstract route on its own, the first segment an agent needs, and the whole refined path
+		void BenchmarkHierarchicalSearch(int size, float cellSize) {
+			const int queryCount = 20;
+			vector<string> asciiMap = MakeOpenGrid(size, 4321u);
+
+			NodeMap map;
+			map.Initialise(asciiMap, (int)cellSize);
+			SearchContext context(map.GetNodeCount());
+
+			HierarchicalMap hierarchy(map, 16);
+			Clock::time_point start = Clock::now();
+			hierarchy.Build();
+			double buildMs = MillisecondsSince(start);
+
+			// Rebuilding around one cell only touches its cluster and the four next to it
+			start = Clock::now();
+			hierarchy.RebuildAround(size / 2, size / 2);
+			double rebuildMs = MillisecondsSince(start);
+
+			mt19937 random(99u);
+			double aStarMs = 0.0;
+			double aStarExpanded = 0.0;
+			double abstractMs = 0.0;
+			double abstractExpanded = 0.0;
+			double firstSegmentMs = 0.0;
+			double fullMs = 0.0;
+			double lengthRatio = 0.0;
+			int found = 0;
+			while (found < queryCount) {
+				Node* startNode = map.GetNode((int)(random() % size), (int)(random() % size));
+				Node* endNode = map.GetNode((int)(random() % size), (int)(random() % size));
+				if (startNode == nullptr || endNode == nullptr) {
+					continue;
+				}
+
+				vector<Node*> path = map.AStarSearch<ManhattanHeuristic>(startNode, endNode, context);
+				if (path.size() < 2) {
+					continue;
+				}
+				aStarMs += context.GetStats().milliseconds;
+				aStarExpanded += context.GetStats().nodesExpanded;
+
+				vector<int> waypoints = hierarchy.FindAbstractPath(startNode, endNode, context);
+				abstractMs += context.GetStats().milliseconds;
+				abstractExpanded += context.GetStats().nodesExpanded;
+
+				start = Clock::now();
+				hierarchy.RefineSegment(waypoints[0], waypoints[1], context);
+				firstSegmentMs += MillisecondsSince(start);
+
+				vector<Node*> hierarchicalPath = hierarchy.FindPath(startNode, endNode, context);
+				fullMs += context.GetStats().milliseconds;
+
+				// Every step on this map costs 1, so the lengths compare the path costs
+				lengthRatio += (double)(hierarchicalPath.size() - 1) / (path.size() - 1);
+				found++;
+			}
+
+			cout << "Hierarchical search benchmark: " << size << "x" << size << " open grid, " << hierarchy.GetClusterCount() << " clusters of 16x16, " << hierarchy.GetEntranceCount() << " entrances" << endl;
+			cout << "Built in " << fixed << setprecision(1) << buildMs << " ms, rebuilt around one cell in " << setprecision(3) << rebuildMs << " ms" << endl;
+			cout << setw(32) << "search" << setw(16) << "nodes expanded" << setw(14) << "time (ms)" << endl;
+			cout << setw(32) << "A* (manhattan)" << setprecision(0) << setw(16) << aStarExpanded / queryCount << setprecision(3) << setw(14) << aStarMs / queryCount << endl;
+			cout << setw(32) << "abstract route" << setprecision(0) << setw(16) << abstractExpanded / queryCount << setprecision(3) << setw(14) << abstractMs / queryCount << endl;
+			cout << setw(32) << "abstract route + first segment" << setw(16) << "-" << setw(14) << (abstractMs + firstSegmentMs) / queryCount << endl;
+			cout << setw(32) << "whole path refined" << setw(16) << "-" << setw(14) << fullMs / queryCount << endl;
+			cout << "Hierarchical paths average " << setprecision(3) << lengthRatio / queryCount << "x the shortest length" << endl << endl;
+		};
+	}
+
+
+	namespace {
+		// Stress test for the batch solver: 10000 queries solved with 1, 2, 4 and one thread per hardware thread.
+		// Every run has to return exactly the paths the single-threaded run did.
+		void BenchmarkBatchSolver(int size, float cellSize) {
+			const int queryCount = 10000;
+			const int queryRange = 32;
+			vector<string> asciiMap = MakeBenchmarkGrid(size, 1234u);
+
+			NodeMap map;
+			map.Initialise(asciiMap, (int)cellSize);
+
+			// Short and medium queries between even cells (which are never walls), like agents moving around a level
+			mt19937 random(7u);
+			vector<PathRequest> requests;
+			for (int i = 0; i < queryCount; i++) {
+				int startX = (int)(random() % (size / 2)) * 2;
+				int startY = (int)(random() % (size / 2)) * 2;
+				int endX = min(max(startX + (int)(random() % (queryRange + 1)) * 2 - queryRange, 0), ((size - 1) / 2) * 2);
+				int endY = min(max(startY + (int)(random() % (queryRange + 1)) * 2 - queryRange, 0), ((size - 1) / 2) * 2);
+				requests.push_back({ map.GetNode(startX, startY), map.GetNode(endX, endY), nullptr });
+			}
+
+			vector<int> threadCounts;
+			threadCounts.push_back(1);
+			threadCounts.push_back(2);
+			threadCounts.push_back(4);
+			int hardwareThreads = (int)thread::hardware_concurrency();
+			if (hardwareThreads > 4) {
+				threadCounts.push_back(hardwareThreads);
+			}
+
+			cout << "Batch solver stress test: " << size << "x" << size << " grid, " << queryCount << " queries, " << hardwareThreads << " hardware threads" << endl;
+			cout << setw(10) << "threads" << setw(14) << "time (ms)" << setw(16) << "queries / s" << setw(10) << "speedup" << setw(14) << "same paths" << endl;
+
+			vector<vector<Node*>> reference;
+			double singleThreadMs = 0.0;
+			for (int threadCount : threadCounts) {
+				ThreadPool pool(threadCount);
+				BatchPathSolver solver(map, pool);
+
+				Clock::time_point start = Clock::now();
+				vector<vector<Node*>> paths = solver.Solve(requests);
+				double milliseconds = MillisecondsSince(start);
+
+				if (reference.empty()) {
+					reference = paths;
+					singleThreadMs = milliseconds;
+				}
+
+				bool samePaths = paths == reference;
+				for (int i = 0; samePaths && i < queryCount; i++) {
+					samePaths = !paths[i].empty() && paths[i].front() == requests[i].startNode && paths[i].back() == requests[i].endNode;
+				}
+
+				cout << setw(10) << threadCount << fixed << setprecision(1) << setw(14) << milliseconds << setprecision(0) << setw(16) << queryCount / (milliseconds / 1000.0)
+					<< setprecision(2) << setw(9) << singleThreadMs / milliseconds << "x" << setw(14) << CheckResult(samePaths) << endl;
+			}
+
+			// The asynchronous route: submit for a crowd of agents, then hand the paths over on this thread as they finish
+			const int agentCount = 1000;
+			vector<PathAgent> agents(agentCount);
+			vector<PathRequest> agentRequests;
+			for (int i = 0; i < agentCount; i++) {
+				agents[i].SetMap(&map);
+				agents[i].SetNode(requests[i].startNode);
+				agentRequests.push_back({ requests[i].startNode, requests[i].endNode, &agents[i] });
+			}
+
+			ThreadPool pool;
+			BatchPathSolver solver(map, pool);
+			solver.SubmitAsync(agentRequests);
+			int delivered = 0;
+			while (delivered < agentCount) {
+				delivered += solver.DeliverFinished();
+				this_thread::yield();
+			}
+
+			bool agentsMatch = true;
+			for (int i = 0; agentsMatch && i < agentCount; i++) {
+				agentsMatch = agents[i].GetPath() == reference[i];
+			}
+			cout << delivered << " agents handed their paths asynchronously, " << CheckResult(agentsMatch, "all match", "MISMATCH") << endl << endl;
+		};
+	}
+
+
+	namespace {
+		// Agents leaving from a few spawn points for a set of goals, searched every time and then through a PathCache
+		void BenchmarkPathCache(int size, float cellSize) {
+			const int queryCount = 1000;
+			const int spawnCount = 4;
+			const int goalCount = 200;
+			vector<string> asciiMap = MakeBenchmarkGrid(size, 1234u);
+
+			NodeMap map;
+			map.Initialise(asciiMap, (int)cellSize);
+			SearchContext context(map.GetNodeCount());
+
+			// Spawn points and goals on even cells, which are never walls
+			mt19937 random(5u);
+			auto randomNode = [&]() {
+				return map.GetNode((int)(random() % (size / 2)) * 2, (int)(random() % (size / 2)) * 2);
+			};
+			vector<Node*> spawns;
+			vector<Node*> goals;
+			for (int i = 0; i < spawnCount; i++) {
+				spawns.push_back(randomNode());
+			}
+			for (int i = 0; i < goalCount; i++) {
+				goals.push_back(randomNode());
+			}
+			vector<pair<Node*, Node*>> queries;
+			for (int i = 0; i < queryCount; i++) {
+				queries.push_back(make_pair(spawns[random() % spawnCount], goals[random() % goalCount]));
+			}
+
+			Clock::time_point start = Clock::now();
+			vector<vector<Node*>> uncached;
+			for (const pair<Node*, Node*>& query : queries) {
+				uncached.push_back(map.DijkstraSearch(query.first, query.second, context));
+			}
+			double uncachedMs = MillisecondsSince(start);
+
+			PathCache cache(map);
+			start = Clock::now();
+			bool samePaths = true;
+			for (int i = 0; i < queryCount; i++) {
+				samePaths = cache.FindPath(queries[i].first, queries[i].second, context) == uncached[i] && samePaths;
+			}
+			double cachedMs = MillisecondsSince(start);
+			PathCacheStats stats = cache.GetStats();
+
+			cout << "Path cache benchmark: " << size << "x" << size << " grid, " << queryCount << " queries from " << spawnCount << " spawn points to " << goalCount << " goals" << endl;
+			cout << "Uncached " << fixed << setprecision(1) << uncachedMs << " ms, cached " << cachedMs << " ms (" << setprecision(1) << uncachedMs / cachedMs << "x), same paths " << CheckResult(samePaths) << endl;
+			cout << stats.pathHits << " path hits, " << stats.treeHits << " tree hits, " << stats.misses << " misses, " << stats.treesBuilt << " trees built, "
+				<< stats.evictions << " evictions, " << setprecision(1) << cache.GetMemoryUsage() / (1024.0 * 1024.0) << " MB cached" << endl;
+
+			// Initialising the map again changes its version, so the next query throws the whole cache out
+			{
+				MuteConsole mute;
+				map.Initialise(asciiMap, (int)cellSize);
+			}
+			cache.FindPath(map.GetNode(0, 0), map.GetNode(2, 2), context);
+			stats = cache.GetStats();
+			cout << "After the map changed: " << stats.invalidations << " invalidation, " << setprecision(1) << cache.GetMemoryUsage() / 1024.0 << " KB cached" << endl << endl;
+		};
+	}
+
+
+	namespace {
+		// The cost of a path, priced with the map's current tile costs
+		float PathCost(const NodeMap& map, const vector<Node*>& path) {
+			float cost = 0.0f;
+			for (size_t i = 1; i < path.size(); i++) {
+				cost += map.GetStepCost(path[i - 1]->id, path[i]->id);
+			}
+			return cost;
+		};
+
+		// Runs the same long queries one way and both ways at once, with and without a heuristic, on one graph mode of a map
+		template<typename Heuristic>
+		void RunBidirectionalQueries(NodeMap& map, const char* graphName, const char* heuristicName, int queryCount) {
+			SearchContext forward(map.GetNodeCount());
+			SearchContext backward(map.GetNodeCount());
+			int size = map.GetWidth();
+
+			// Starts from the left eighth of the map and ends in the right eighth, so every query crosses most of it
+			mt19937 random(7u);
+			vector<pair<Node*, Node*>> queries;
+			while ((int)queries.size() < queryCount) {
+				Node* start = map.GetNode((int)(random() % (size / 8)), (int)(random() % size));
+				Node* end = map.GetNode(size - 1 - (int)(random() % (size / 8)), (int)(random() % size));
+				if (start != nullptr && end != nullptr) {
+					queries.push_back(make_pair(start, end));
+				}
+			}
+
+			// Dijkstra and A* one way, then the same both ways. The one way searches set the costs the others have to match.
+			const char* names[4] = { "Dijkstra", "bidirectional Dijkstra", heuristicName, "bidirectional A*" };
+			double expanded[4] = { 0.0, 0.0, 0.0, 0.0 };
+			double milliseconds[4] = { 0.0, 0.0, 0.0, 0.0 };
+			bool sameCosts[4] = { true, true, true, true };
+			for (const pair<Node*, Node*>& query : queries) {
+				vector<Node*> paths[4];
+				paths[0] = map.DijkstraSearch(query.first, query.second, forward);
+				expanded[0] += forward.GetStats().nodesExpanded;
+				milliseconds[0] += forward.GetStats().milliseconds;
+				paths[1] = map.BidirectionalSearch<ZeroHeuristic>(query.first, query.second, forward, backward);
+				expanded[1] += forward.GetStats().nodesExpanded;
+				milliseconds[1] += forward.GetStats().milliseconds;
+				paths[2] = map.AStarSearch<Heuristic>(query.first, query.second, forward);
+				expanded[2] += forward.GetStats().nodesExpanded;
+				milliseconds[2] += forward.GetStats().milliseconds;
+				paths[3] = map.BidirectionalSearch<Heuristic>(query.first, query.second, forward, backward);
+				expanded[3] += forward.GetStats().nodesExpanded;
+				milliseconds[3] += forward.GetStats().milliseconds;
+
+				// The stitched path has to run from the start to the end, and cost the same as the one way search.
+				// On a small map a wall can cut the ends off from each other, and then every search has to come back empty.
+				const float cost = PathCost(map, paths[0]);
+				for (int i = 1; i < 4; i++) {
+					const float pathCost = PathCost(map, paths[i]);
+					sameCosts[i] = sameCosts[i] && (paths[0].empty() ? paths[i].empty()
+						: !paths[i].empty() && paths[i].front() == query.first && paths[i].back() == query.second && fabs(pathCost - cost) < 0.001f * (cost + 1.0f));
+				}
+			}
+
+			for (int i = 0; i < 4; i++) {
+				cout << setw(16) << graphName << setw(26) << names[i] << fixed << setprecision(0) << setw(16) << expanded[i] / queryCount << setprecision(3) << setw(14) << milliseconds[i] / queryCount
+					<< setw(12) << (i == 0 ? "-" : CheckResult(sameCosts[i])) << endl;
+			}
+		};
+
+		// Long point to point queries searched from one end and from both ends at once.
+		// The 8-connected map has patches of rough ground, so the backward half has to price edges the right way round to find the same paths.
+		void BenchmarkBidirectionalSearch(int size, float cellSize) {
+			const int queryCount = 10;
+
+			NodeMap mazeMap;
+			{
+				MuteConsole mute;
+				mazeMap.Initialise(MakeBenchmarkGrid(size, 1234u), (int)cellSize);
+			}
+
+			NodeMap roughMap;
+			roughMap.Initialise(MakeOpenGrid(size, 1234u), (int)cellSize, GridGraph::Implicit8);
+			mt19937 random(5u);
+			for (int i = 0; i < size * size / 8; i++) {
+				roughMap.SetTileCost((int)(random() % size), (int)(random() % size), 1.0f + (float)(random() % 4));
+			}
+
+			cout << "Bidirectional search benchmark: " << size << "x" << size << " grids, " << queryCount << " queries across the map (averages per query)" << endl;
+			cout << setw(16) << "graph" << setw(26) << "search" << setw(16) << "nodes expanded" << setw(14) << "time (ms)" << setw(12) << "same cost" << endl;
+			RunBidirectionalQueries<ManhattanHeuristic>(mazeMap, "explicit", "A* (manhattan)", queryCount);
+			RunBidirectionalQueries<OctileHeuristic>(roughMap, "8-connected", "A* (octile)", queryCount);
+			cout << endl;
+		};
+
+		// Answers "how far is every target", "which target is nearest" and "which target is nearest to any of these sources" once with a search per source
+		// and target pair, and once with a single MultiSourceSearch, checking both give the same distances
+		void BenchmarkMultiSourceSearch(int size, float cellSize) {
+			const int targetCount = 50;
+			const int sourceCount = 8;
+
+			NodeMap map;
+			map.Initialise(MakeOpenGrid(size, 4321u), (int)cellSize, GridGraph::Implicit8);
+			SearchContext context(map.GetNodeCount());
+
+			mt19937 random(11u);
+			auto randomNode = [&]() {
+				Node* node = nullptr;
+				while (node == nullptr) {
+					node = map.GetNode((int)(random() % size), (int)(random() % size));
+				}
+				return node;
+			};
+			vector<Node*> sources;
+			for (int i = 0; i < sourceCount; i++) {
+				sources.push_back(randomNode());
+			}
+			vector<Node*> targets;
+			for (int i = 0; i < targetCount; i++) {
+				targets.push_back(randomNode());
+			}
+
+			cout << "Multi-source search benchmark: " << size << "x" << size << " 8-connected grid, " << targetCount << " targets" << endl;
+			cout << setw(32) << "query" << setw(10) << "searches" << setw(16) << "nodes expanded" << setw(14) << "time (ms)" << setw(16) << "same distances" << endl;
+
+			// A DijkstraSearch for every source and target pair, which is what each query costs without MultiSourceSearch
+			vector<vector<float>> pairDistances(sourceCount, vector<float>(targetCount));
+			vector<double> pairExpanded(sourceCount, 0.0);
+			vector<double> pairMilliseconds(sourceCount, 0.0);
+			for (int source = 0; source < sourceCount; source++) {
+				for (int i = 0; i < targetCount; i++) {
+					map.DijkstraSearch(sources[source], targets[i], context);
+					pairDistances[source][i] = context.GetGScore(targets[i]->id);
+					pairExpanded[source] += context.GetStats().nodesExpanded;
+					pairMilliseconds[source] += context.GetStats().milliseconds;
+				}
+			}
+
+			// One row per query with a search per pair (the first query and the second need the same searches), keeping the shortest distance to each target, then the same answer in one pass
+			const char* names[3] = { "distance to every target", "nearest target", "nearest target to 8 sources" };
+			const int usedSources[3] = { 1, 1, sourceCount };
+			for (int query = 0; query < 3; query++) {
+				vector<Node*> querySources(sources.begin(), sources.begin() + usedSources[query]);
+				vector<float> distances(targetCount, numeric_limits<float>::infinity());
+				double expanded = 0.0;
+				double milliseconds = 0.0;
+				for (int source = 0; source < usedSources[query]; source++) {
+					for (int i = 0; i < targetCount; i++) {
+						distances[i] = min(distances[i], pairDistances[source][i]);
+					}
+					expanded += pairExpanded[source];
+					milliseconds += pairMilliseconds[source];
+				}
+				cout << setw(32) << names[query] << setw(10) << querySources.size() * targetCount << fixed << setprecision(0) << setw(16) << expanded << setprecision(3) << setw(14) << milliseconds << setw(16) << "-" << endl;
+
+				// The nearest target query only has to settle one target, and its answer is the smallest of the per-pair distances.
+				// On a small map a wall can cut some targets off from the sources, and then neither way may reach them. Small maps also repeat targets,
+				// which MultiSourceSearch only counts once.
+				const int targetsNeeded = query == 1 ? 1 : -1;
+				int reached = map.MultiSourceSearch(querySources, targets, context, targetsNeeded);
+				vector<int> reachableIds;
+				for (int i = 0; i < targetCount; i++) {
+					if (distances[i] != numeric_limits<float>::infinity()) {
+						reachableIds.push_back(targets[i]->id);
+					}
+				}
+				sort(reachableIds.begin(), reachableIds.end());
+				const int reachable = (int)(unique(reachableIds.begin(), reachableIds.end()) - reachableIds.begin());
+				bool same = reached == (query == 1 ? min(reachable, 1) : reachable);
+				float nearest = *min_element(distances.begin(), distances.end());
+				for (int i = 0; i < targetCount; i++) {
+					float distance = context.GetGScore(targets[i]->id);
+					if (query == 1) {
+						same = same && (distance == numeric_limits<float>::infinity() || fabs(distance - nearest) < 0.001f * (nearest + 1.0f));
+					}
+					else if (distances[i] == numeric_limits<float>::infinity()) {
+						same = same && distance == numeric_limits<float>::infinity();
+					}
+					else {
+						vector<Node*> path = map.GetSearchPath(targets[i], context);
+						same = same && fabs(distance - distances[i]) < 0.001f * (distances[i] + 1.0f) && !path.empty() && path.back() == targets[i]
+							&& find(querySources.begin(), querySources.end(), path.front()) != querySources.end() && fabs(PathCost(map, path) - distance) < 0.001f * (distance + 1.0f);
+					}
+				}
+				cout << setw(32) << "  ...in one pass" << setw(10) << 1 << fixed << setprecision(0) << setw(16) << (double)context.GetStats().nodesExpanded << setprecision(3) << setw(14) << context.GetStats().milliseconds
+					<< setw(16) << CheckResult(same) << endl;
+			}
+			cout << endl;
+		};
+
+		// Allocate and free rounds of small blocks of mixed sizes, returning the time per allocate and free pair in nanoseconds
+		template<typename Allocate, typename Free>
+		double TimeAllocations(int rounds, vector<char*>& blocks, Allocate allocate, Free release) {
+			Clock::time_point start = Clock::now();
+			for (int round = 0; round < rounds; round++) {
+				for (size_t i = 0; i < blocks.size(); i++) {
+					blocks[i] = allocate(16 + (i % 16) * 16);
+					blocks[i][0] = (char)i;
+				}
+				for (size_t i = 0; i < blocks.size(); i++) {
+					release(blocks[i]);
+				}
+			}
+			return MillisecondsSince(start) * 1000000.0 / ((double)rounds * blocks.size());
+		};
+
+		// The cost of the allocation profiler: new and delete of small blocks against malloc and free, and searches that make a new SearchContext every time,
+		// with the profiler recording and paused
+		void BenchmarkAllocationProfiler(int size, float cellSize) {
+			const int rounds = 500;
+			const int queryCount = 200;
+			vector<char*> blocks(1000);
+
+			NodeMap map;
+			map.Initialise(MakeOpenGrid(size, 77u), (int)cellSize, GridGraph::Implicit8);
+			mt19937 random(3u);
+			vector<pair<Node*, Node*>> queries;
+			while ((int)queries.size() < queryCount) {
+				Node* start = map.GetNode((int)(random() % size), (int)(random() % size));
+				Node* end = map.GetNode((int)(random() % size), (int)(random() % size));
+				if (start != nullptr && end != nullptr) {
+					queries.push_back(make_pair(start, end));
+				}
+			}
+			auto timeSearches = [&]() {
+				Clock::time_point start = Clock::now();
+				for (const pair<Node*, Node*>& query : queries) {
+					map.DijkstraSearch(query.first, query.second);
+				}
+				return MillisecondsSince(start) / queryCount;
+			};
+
+			AllocationProfiler& profiler = AllocationProfiler::Global();
+			const bool wasRecording = profiler.IsRecording();
+			double mallocNs = TimeAllocations(rounds, blocks, [](size_t bytes) { return (char*)malloc(bytes); }, [](char* block) { free(block); });
+			profiler.SetRecording(true);
+			double recordingNs = TimeAllocations(rounds, blocks, [](size_t bytes) { return new char[bytes]; }, [](char* block) { delete[] block; });
+			double recordingSearchMs = timeSearches();
+			profiler.SetRecording(false);
+			double pausedNs = TimeAllocations(rounds, blocks, [](size_t bytes) { return new char[bytes]; }, [](char* block) { delete[] block; });
+			double pausedSearchMs = timeSearches();
+			profiler.SetRecording(wasRecording);
+
+#ifdef AIFG_ALLOCATION_PROFILER
+			cout << "Allocation profiler benchmark: every new and delete goes through the profiler" << endl;
+#else
+			cout << "Allocation profiler benchmark: built without AIFG_ALLOCATION_PROFILER, so new and delete aren't replaced and both columns should match" << endl;
+#endif
+			cout << setw(28) << "" << setw(18) << "recording" << setw(18) << "paused" << endl;
+			cout << setw(28) << "new + delete (ns)" << fixed << setprecision(1) << setw(18) << recordingNs << setw(18) << pausedNs << "   (malloc + free " << mallocNs << " ns)" << endl;
+			cout << setw(28) << "DijkstraSearch (ms)" << setprecision(3) << setw(18) << recordingSearchMs << setw(18) << pausedSearchMs << "   (" << size << "x" << size << ", a new SearchContext per query)" << endl;
+#ifdef AIFG_ALLOCATION_PROFILER
+			profiler.Report(cout, 5);
+#endif
+			cout << endl;
+		};
+
+		// An agent crossing an open map while doors slam shut on the path ahead of it (and reopen a while later), and patches of rough ground come and go.
+		// Every few steps the path is found again, once from scratch with A* and once by repairing a D* Lite search, and the two have to cost the same.
+		void BenchmarkDynamicReplanning(int size, float cellSize) {
+			const int stepCount = 400;
+			const int stepsPerEdit = 4;
+			const int maxClosedDoors = 8;
+			vector<string> asciiMap = MakeOpenGrid(size, 99u);
+
+			NodeMap map;
+			map.Initialise(asciiMap, (int)cellSize);
+			SearchContext context(map.GetNodeCount());
+
+			// Head for the walkable cell nearest the far corner that can be reached at all
+			Node* agentNode = map.GetNode(0, 0);
+			Node* goal = nullptr;
+			for (int i = 0; i < size && goal == nullptr; i++) {
+				Node* candidate = map.GetNode(size - 1 - i, size - 1 - i);
+				if (candidate != nullptr && !map.AStarSearch<ManhattanHeuristic>(agentNode, candidate, context).empty()) {
+					goal = candidate;
+				}
+			}
+
+			DStarLite planner(map);
+			Clock::time_point start = Clock::now();
+			vector<Node*> path = planner.FindPath(agentNode, goal);
+			double firstMs = MillisecondsSince(start);
+			int firstExpanded = planner.GetStats().nodesExpanded;
+
+			mt19937 random(3u);
+			vector<int> closedDoors;
+			double freshMs = 0.0;
+			double repairMs = 0.0;
+			long long freshExpanded = 0;
+			long long repairExpanded = 0;
+			int replans = 0;
+			bool sameCosts = true;
+
+			for (int step = 0; step < stepCount && path.size() > 1; step++) {
+				agentNode = path[1];
+				path.erase(path.begin());
+				if (step % stepsPerEdit != 0) {
+					continue;
+				}
+
+				// Close a door somewhere on the path ahead, reopen the oldest one, and scatter some rough ground near the agent
+				if (path.size() > 6) {
+					int door = path[3 + random() % min<size_t>(path.size() - 4, 60)]->id;
+					if (door != goal->id) {
+						map.SetTileWalkable(door % size, door / size, false);
+						closedDoors.push_back(door);
+					}
+				}
+				if ((int)closedDoors.size() > maxClosedDoors) {
+					map.SetTileWalkable(closedDoors.front() % size, closedDoors.front() / size, true);
+					closedDoors.erase(closedDoors.begin());
+				}
+				int roughX = min(max(agentNode->id % size + (int)(random() % 21) - 10, 0), size - 1);
+				int roughY = min(max(agentNode->id / size + (int)(random() % 21) - 10, 0), size - 1);
+				map.SetTileCost(roughX, roughY, 1.0f + (float)(random() % 4));
+
+				start = Clock::now();
+				vector<Node*> freshPath = map.AStarSearch<ManhattanHeuristic>(agentNode, goal, context);
+				freshMs += MillisecondsSince(start);
+				freshExpanded += context.GetStats().nodesExpanded;
+
+				path = planner.FindPath(agentNode, goal);
+				repairMs += planner.GetStats().milliseconds;
+				repairExpanded += planner.GetStats().nodesExpanded;
+				replans++;
+
+				sameCosts = sameCosts && path.empty() == freshPath.empty() && fabs(PathCost(map, path) - PathCost(map, freshPath)) < 1e-3f * (1.0f + PathCost(map, freshPath));
+			}
+
+			cout << "Dynamic replanning benchmark: " << size << "x" << size << " open grid, " << replans << " replans while doors close on the path ahead" << endl;
+			cout << "First D* Lite search " << fixed << setprecision(2) << firstMs << " ms (" << firstExpanded << " expanded)" << endl;
+			cout << setw(14) << "search" << setw(16) << "avg ms" << setw(16) << "avg expanded" << endl;
+			cout << setw(14) << "A* (fresh)" << setw(16) << setprecision(3) << freshMs / max(replans, 1) << setw(16) << freshExpanded / max(replans, 1) << endl;
+			cout << setw(14) << "D* Lite" << setw(16) << setprecision(3) << repairMs / max(replans, 1) << setw(16) << repairExpanded / max(replans, 1) << endl;
+			cout << "Same path costs " << CheckResult(sameCosts) << ", D* Lite keeps " << setprecision(1) << planner.GetMemoryUsage() / (1024.0 * 1024.0) << " MB of search state" << endl << endl;
+		};
+	}
+
+
+	namespace {
+		// A crowd heading for one goal: every agent searching for itself, against one shared flow field that each agent reads a step at a time.
+		// Then doors close around the map, and the field is repaired instead of being built again.
+		void BenchmarkFlowFields(int size, float cellSize) {
+			const int doorCount = 32;
+			vector<string> asciiMap = MakeOpenGrid(size, 21u);
+
+			NodeMap map;
+			map.Initialise(asciiMap, (int)cellSize);
+			SearchContext context(map.GetNodeCount());
+
+			// The first row is always clear, so the goal is always reachable
+			Node* goal = map.GetNode(size / 2, 0);
+			mt19937 random(8u);
+			auto randomNode = [&]() {
+				Node* node = nullptr;
+				while (node == nullptr) {
+					node = map.GetNode((int)(random() % size), (int)(random() % size));
+				}
+				return node;
+			};
+
+			cout << "Flow field benchmark: " << size << "x" << size << " open grid, every agent heading for the same goal" << endl;
+			cout << setw(10) << "agents" << setw(18) << "searches (ms)" << setw(18) << "flow field (ms)" << setw(16) << "tick (ms)" << setw(14) << "same costs" << endl;
+
+			const int crowdSizes[3] = { 10, 100, 1000 };
+			for (int crowdSize : crowdSizes) {
+				vector<Node*> crowd;
+				for (int i = 0; i < crowdSize; i++) {
+					crowd.push_back(randomNode());
+				}
+
+				// Every agent searching for its own path
+				Clock::time_point start = Clock::now();
+				vector<float> searchCosts;
+				for (Node* agentNode : crowd) {
+					map.DijkstraSearch(agentNode, goal, context);
+					searchCosts.push_back(context.GetGScore(goal->id));
+				}
+				double searchMs = MillisecondsSince(start);
+
+				// One field for the whole crowd, then a tick of every agent looking up its next step
+				start = Clock::now();
+				FlowFieldCache flowFields(map);
+				FlowField* field = flowFields.GetField(goal);
+				double fieldMs = MillisecondsSince(start);
+
+				start = Clock::now();
+				int moving = 0;
+				for (Node* agentNode : crowd) {
+					moving += flowFields.GetNextNode(agentNode, goal) != nullptr;
+				}
+				double tickMs = MillisecondsSince(start);
+
+				// Following the field all the way has to cost what the agent's own search found. An agent walled off from the goal
+				// (which happens on small maps) has nowhere to follow the field to, and its search has to have found no path either.
+				bool sameCosts = moving > 0;
+				for (int i = 0; i < crowdSize; i++) {
+					float cost = 0.0f;
+					Node* node = crowd[i];
+					while (node != goal && node != nullptr) {
+						Node* next = field->GetNextNode(node);
+						if (next != nullptr) {
+							cost += map.GetStepCost(node->id, next->id);
+						}
+						node = next;
+					}
+					if (node == nullptr) {
+						cost = numeric_limits<float>::infinity();
+					}
+					sameCosts = sameCosts && (cost == searchCosts[i] || fabs(cost - searchCosts[i]) < 1e-3f * (1.0f + cost));
+				}
+
+				cout << setw(10) << crowdSize << fixed << setprecision(2) << setw(18) << searchMs << setw(18) << fieldMs << setprecision(3) << setw(16) << tickMs << setw(14) << CheckResult(sameCosts) << endl;
+			}
+
+			// Doors closing and rough ground appearing all over the map, then the cached field repaired against one built from nothing
+			FlowFieldCache flowFields(map);
+			flowFields.GetField(goal);
+			for (int i = 0; i < doorCount; i++) {
+				Node* door = randomNode();
+				if (door != goal) {
+					map.SetTileWalkable(door->id % size, door->id / size, false);
+				}
+				Node* rough = randomNode();
+				map.SetTileCost(rough->id % size, rough->id / size, 3.0f);
+			}
+
+			FlowField* repaired = flowFields.GetField(goal);
+			FlowField rebuilt(map);
+			rebuilt.Build(goal);
+
+			bool sameField = true;
+			for (int id = 0; id < map.GetNodeCount() && sameField; id++) {
+				float a = repaired->GetDistance(id);
+				float b = rebuilt.GetDistance(id);
+				sameField = a == b || fabs(a - b) < 1e-3f * (1.0f + b);
+			}
+			cout << "After " << doorCount << " doors and " << doorCount << " rough tiles: repair " << setprecision(2) << repaired->GetStats().milliseconds << " ms (" << repaired->GetStats().nodesExpanded << " expanded), rebuild "
+				<< rebuilt.GetStats().milliseconds << " ms (" << rebuilt.GetStats().nodesExpanded << " expanded), same field " << CheckResult(sameField) << endl;
+			cout << "Each field holds " << setprecision(1) << repaired->GetMemoryUsage() / 1024.0 << " KB" << endl << endl;
+		};
+
+		void BenchmarkAgentSystem(int size, float cellSize) {
+			const int agentCount = 100000;
+			const int legacyAgentCount = 10000;
+			const int pathCount = 64;
+			const int tickCount = 300;
+			const float deltaTime = 1.0f / 60.0f;
+			vector<string> asciiMap = MakeOpenGrid(size, 77u);
+
+			NodeMap map;
+			map.Initialise(asciiMap, (int)cellSize);
+			SearchContext context(map.GetNodeCount());
+
+			// A handful of long paths, shared out between the agents so the crowd is spread all over the map
+			mt19937 random(13u);
+			auto randomNode = [&]() {
+				Node* node = nullptr;
+				while (node == nullptr) {
+					node = map.GetNode((int)(random() % size), (int)(random() % size));
+				}
+				return node;
+			};
+			vector<vector<Node*>> paths;
+			while ((int)paths.size() < pathCount) {
+				vector<Node*> path = map.DijkstraSearch(randomNode(), randomNode(), context);
+				if (path.size() >= 2) {
+					paths.push_back(path);
+				}
+			}
+			vector<float> speeds;
+			for (int i = 0; i < agentCount; i++) {
+				speeds.push_back(cellSize * (1.0f + (float)(random() % 1000) / 250.0f));
+			}
+
+			// Three systems with the same agents: the scalar reference, the SIMD step on this thread, and the SIMD step spread over a pool
+			AgentSystem systems[3];
+			for (AgentSystem& system : systems) {
+				for (int i = 0; i < agentCount; i++) {
+					const vector<Node*>& path = paths[i % pathCount];
+					int agent = system.AddAgent(path.front()->position, speeds[i]);
+					system.SetPath(agent, path);
+				}
+			}
+
+			ThreadPool pool;
+			cout << "Agent system benchmark: " << agentCount << " agents on a " << size << "x" << size << " open grid, " << tickCount << " ticks, " << AgentSystem::GetSimdName() << " movement step" << endl;
+			cout << setw(24) << "update" << setw(16) << "tick (ms)" << setw(20) << "agents / ms" << setw(14) << "same moves" << endl;
+
+			const char* names[3] = { "scalar", AgentSystem::GetSimdName(), "" };
+			string threadedName = string(AgentSystem::GetSimdName()) + ", " + to_string(pool.GetThreadCount()) + " threads";
+			names[2] = threadedName.c_str();
+			for (int s = 0; s < 3; s++) {
+				Clock::time_point start = Clock::now();
+				for (int tick = 0; tick < tickCount; tick++) {
+					if (s == 0) {
+						systems[s].UpdateScalar(deltaTime);
+					}
+					else {
+						systems[s].Update(deltaTime, s == 2 ? &pool : nullptr);
+					}
+				}
+				double tickMs = MillisecondsSince(start) / tickCount;
+
+				// Every agent has to end up at exactly the same float position as the scalar reference puts it
+				bool sameMoves = true;
+				for (int i = 0; sameMoves && i < agentCount; i++) {
+					sameMoves = systems[s].GetPosition(i) == systems[0].GetPosition(i) && systems[s].IsMoving(i) == systems[0].IsMoving(i);
+				}
+
+				cout << setw(24) << names[s] << fixed << setprecision(3) << setw(16) << tickMs << setprecision(0) << setw(20) << agentCount / tickMs << setw(14) << CheckResult(sameMoves) << endl;
+			}
+
+			// The same paths followed by one PathAgent object each, for comparison
+			vector<PathAgent> agents(legacyAgentCount);
+			for (int i = 0; i < legacyAgentCount; i++) {
+				agents[i].SetMap(&map);
+				agents[i].SetNode(paths[i % pathCount].front());
+				agents[i].SetSpeed((int)speeds[i]);
+				agents[i].SetPath(paths[i % pathCount]);
+			}
+			Clock::time_point start = Clock::now();
+			{
+				MuteConsole mute;
+				for (int tick = 0; tick < tickCount; tick++) {
+					for (PathAgent& agent : agents) {
+						agent.Update(deltaTime);
+					}
+				}
+			}
+			double legacyTickMs = MillisecondsSince(start) / tickCount;
+			cout << setw(24) << "PathAgent objects" << setprecision(3) << setw(16) << legacyTickMs << setprecision(0) << setw(20) << legacyAgentCount / legacyTickMs
+				<< "   (" << legacyAgentCount << " agents)" << endl << endl;
+		};
+	}
+
+
+	int RunBenchmarks(int argc, char* argv[]) {
+		// Grid sizes can be given after the --benchmark flag, otherwise use the two standard sizes
+		vector<int> sizes;
+		for (int i = 2; i < argc; i++) {
+			int size = atoi(argv[i]);
+			if (size >= 16) {
+				sizes.push_back(size);
+			}
+		}
+		if (sizes.empty()) {
+			sizes.push_back(512);
+			sizes.push_back(2048);
+		}
+
+		// The node arena, very large map and map loading benchmarks each run once, on a grid scaled from the largest size asked for
+		// (2048x2048, about 10000x10000 and 16384x16384 by default), so a quick run on small grids stays quick and only writes small files
+		const int largestSize = *max_element(sizes.begin(), sizes.end());
+
+		// The crowd, cache and batch benchmarks run thousands of searches each, so they get one grid an eighth of the largest size (256x256 by default),
+		// but never smaller than 32x32
+		const int crowdSize = max(largestSize / 8, 32);
+
+		BenchmarkNodeArena(largestSize, 50.0f);
+		for (int size : sizes) {
+			BenchmarkClosestNode(size, 50.0f);
+		}
+		for (int size : sizes) {
+			BenchmarkConnectedComponents(size, 50.0f);
+		}
+		for (int size : sizes) {
+			BenchmarkGraphLayout(size, 50.0f);
+		}
+		for (int size : sizes) {
+			BenchmarkMapGeometry(size, 50.0f);
+		}
+		BenchmarkLargeImplicitMap(largestSize * 5, 50.0f);
+		BenchmarkMapLoader(largestSize * 8, 50.0f);
+		for (int size : sizes) {
+			BenchmarkOpenList(size, 50.0f);
+		}
+		for (int size : sizes) {
+			BenchmarkHeuristics(size, 50.0f);
+		}
+		for (int size : sizes) {
+			BenchmarkBidirectionalSearch(size, 50.0f);
+		}
+		for (int size : sizes) {
+			BenchmarkJumpPointSearch(size, 50.0f);
+		}
+		for (int size : sizes) {
+			BenchmarkAnyAngleSearch(size, 50.0f);
+		}
+		for (int size : sizes) {
+			BenchmarkSnapshot(size, 50.0f);
+		}
+		for (int size : sizes) {
+			BenchmarkHierarchicalSearch(size, 50.0f);
+		}
+		for (int size : sizes) {
+			BenchmarkDynamicReplanning(size, 50.0f);
+		}
+		for (int size : sizes) {
+			BenchmarkPathScheduler(size, 50.0f);
+		}
+		BenchmarkMultiSourceSearch(crowdSize, 50.0f);
+		BenchmarkFlowFields(crowdSize, 50.0f);
+		BenchmarkPathCache(crowdSize, 50.0f);
+		BenchmarkBatchSolver(crowdSize, 50.0f);
+		BenchmarkAgentSystem(crowdSize, 50.0f);
+		BenchmarkAllocationProfiler(crowdSize, 50.0f);
+
+		if (failedChecks > 0) {
+			cout << failedChecks << " correctness check" << (failedChecks == 1 ? "" : "s") << " failed" << endl;
+			return 1;
+		}
+		cout << "All correctness checks passed" << endl;
+		return 0;
+	};
+}
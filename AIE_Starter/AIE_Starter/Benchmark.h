@@ -0,0 +1,26 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace AIForGames {
+	// Command line benchmarks for the pathfinding code, run with "AIE_Starter.exe --benchmark [grid sizes...]" instead of opening the window.
+	// Each benchmark builds square test grids (512x512 and 2048x2048 unless other sizes are given) and prints its timings to the console.
+	// The few that need one much bigger grid, and the ones that run thousands of searches on one smaller grid, scale it from the largest size given.
+	// Returns nonzero if any of the correctness checks printed along the way (the "yes" / "NO" columns, and the capitalised answers like DIFFER) failed.
+	int RunBenchmarks(int argc, char* argv[]);
+
+	// Build a square ascii map that is mostly open floor, broken up by solid rectangular blocks, like a level of rooms and wide corridors.
+	// The first row and column are always kept clear. The same seed always gives the same map.
+	std::vector<std::string> MakeOpenGrid(int size, unsigned int seed);
+
+	// Silences std::cout while it is alive, so the search and agent narrative isn't what ends up being timed
+	class MuteConsole
+	{
+		std::streambuf* m_previous;
+
+	public:
+		MuteConsole() : m_previous(std::cout.rdbuf(nullptr)) {};
+		~MuteConsole() { std::cout.rdbuf(m_previous); };
+	};
+}
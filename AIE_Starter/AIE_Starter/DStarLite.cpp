@@ -0,0 +1,247 @@
+#include "DStarLite.h"
+#include "Heuristics.h"
+#include <chrono>
+#include <limits>
+
+namespace AIForGames {
+	namespace {
+		const float infinity = std::numeric_limits<float>::infinity();
+
+		// How far apart two keys have to be before float rounding can't be the only thing separating them
+		const float keyTolerance = 1e-4f;
+	}
+
+	DStarLite::DStarLite(const NodeMap& map) : m_map(map) {
+		m_diagonal = map.GetGraph() == GridGraph::Implicit8;
+		m_start = -1;
+		m_goal = -1;
+		m_lastStart = -1;
+		m_keyModifier = 0.0f;
+		m_version = map.GetVersion();
+		m_stats = SearchStats();
+	};
+
+	DStarLite::~DStarLite() {};
+
+	float DStarLite::Estimate(int fromId, int toId) const {
+		// Edge costs count cells, so measure the estimate in cells too
+		const int width = m_map.GetWidth();
+		glm::vec2 from((float)(fromId % width), (float)(fromId / width));
+		glm::vec2 to((float)(toId % width), (float)(toId / width));
+		return m_diagonal ? OctileHeuristic::Estimate(from, to) : ManhattanHeuristic::Estimate(from, to);
+	};
+
+	DStarLite::Key DStarLite::CalculateKey(int id) const {
+		// The search runs from the goal towards the agent, so the estimate is of the distance still to go to the agent
+		const Record& record = m_records[id];
+		float distance = record.g < record.rhs ? record.g : record.rhs;
+		Key key;
+		key.first = distance + Estimate(m_start, id) + m_keyModifier;
+		key.second = distance;
+		return key;
+	};
+
+	void DStarLite::UpdateRhs(int id) {
+		Record& record = m_records[id];
+		if (id == m_goal) {
+			record.rhs = 0.0f;
+			return;
+		}
+
+		record.rhs = infinity;
+		if (!m_map.IsWalkable(id % m_map.GetWidth(), id / m_map.GetWidth())) {
+			return;
+		}
+		m_map.ForEachNeighbour(id, [&](int targetNode, float cost) {
+			float distance = cost + m_records[targetNode].g;
+			if (distance < record.rhs) {
+				record.rhs = distance;
+			}
+		});
+	};
+
+	void DStarLite::UpdateVertex(int id) {
+		Record& record = m_records[id];
+		if (record.queued) {
+			m_queue.erase({ record.key, id });
+			record.queued = false;
+		}
+		if (record.g != record.rhs) {
+			record.key = CalculateKey(id);
+			m_queue.insert({ record.key, id });
+			record.queued = true;
+			m_stats.nodesOpened++;
+		}
+	};
+
+	void DStarLite::ComputeShortestPath() {
+		while (!m_queue.empty()) {
+			// Stop once the start is consistent and nothing left on the queue could shorten its path.
+			// A key that only ties with the start's because of rounding still gets expanded, or a stale g score there could be left for the path to follow.
+			const QueueEntry top = *m_queue.begin();
+			const Record& startRecord = m_records[m_start];
+			if (CalculateKey(m_start).first * (1.0f + keyTolerance) + keyTolerance < top.key.first && startRecord.rhs == startRecord.g) {
+				break;
+			}
+
+			// The key was worked out before the agent last moved, so it may be out of date. If it is, put it back where it belongs instead.
+			int currentNode = top.id;
+			Record& record = m_records[currentNode];
+			Key newKey = CalculateKey(currentNode);
+			if (top.key < newKey) {
+				m_queue.erase(m_queue.begin());
+				record.key = newKey;
+				m_queue.insert({ newKey, currentNode });
+				continue;
+			}
+
+			m_queue.erase(m_queue.begin());
+			record.queued = false;
+			m_stats.nodesExpanded++;
+
+			// Every edge into a cell has a twin leaving it, so the cells that step into this one are its neighbours
+			if (record.g > record.rhs) {
+				// The cell has got closer to the goal: settle its new distance and tell the cells that step into it
+				record.g = record.rhs;
+				m_map.ForEachNeighbour(currentNode, [&](int sourceNode, float) {
+					if (sourceNode == m_goal) {
+						return;
+					}
+					float distance = m_map.GetStepCost(sourceNode, currentNode) + record.g;
+					if (distance < m_records[sourceNode].rhs) {
+						m_records[sourceNode].rhs = distance;
+						UpdateVertex(sourceNode);
+					}
+				});
+			}
+			else {
+				// The cell has got further away (or been cut off). Forget its distance, and recompute any cell whose best route went through it.
+				float oldG = record.g;
+				record.g = infinity;
+				m_map.ForEachNeighbour(currentNode, [&](int sourceNode, float) {
+					if (sourceNode != m_goal && m_records[sourceNode].rhs == m_map.GetStepCost(sourceNode, currentNode) + oldG) {
+						UpdateRhs(sourceNode);
+						UpdateVertex(sourceNode);
+					}
+				});
+				UpdateVertex(currentNode);
+			}
+		}
+	};
+
+	void DStarLite::Restart(int start, int goal) {
+		Record empty;
+		empty.g = infinity;
+		empty.rhs = infinity;
+		empty.key.first = infinity;
+		empty.key.second = infinity;
+		empty.queued = false;
+		m_records.assign(m_map.GetNodeCount(), empty);
+		m_queue.clear();
+
+		m_start = start;
+		m_lastStart = start;
+		m_goal = goal;
+		m_keyModifier = 0.0f;
+
+		m_records[goal].rhs = 0.0f;
+		UpdateVertex(goal);
+	};
+
+	std::vector<Node*> DStarLite::ExtractPath() const {
+		std::vector<int> path;
+		if (m_records[m_start].g == infinity) {
+			return std::vector<Node*>();
+		}
+
+		// Each step goes to whichever neighbour is closest to the goal counting the step there, which is the way the shortest path goes.
+		// The step limit only guards against a loop if the distances were ever left inconsistent.
+		int currentNode = m_start;
+		path.push_back(currentNode);
+		for (int steps = 0; currentNode != m_goal && steps < m_map.GetNodeCount(); steps++) {
+			int bestNode = -1;
+			float bestDistance = infinity;
+			m_map.ForEachNeighbour(currentNode, [&](int targetNode, float cost) {
+				float distance = cost + m_records[targetNode].g;
+				if (distance < bestDistance) {
+					bestDistance = distance;
+					bestNode = targetNode;
+				}
+			});
+
+			if (bestNode == -1) {
+				return std::vector<Node*>();
+			}
+			currentNode = bestNode;
+			path.push_back(currentNode);
+		}
+
+		if (currentNode != m_goal) {
+			return std::vector<Node*>();
+		}
+		return m_map.ToNodePath(path);
+	};
+
+	std::vector<Node*> DStarLite::FindPath(Node* startNode, Node* goalNode) {
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		m_stats = SearchStats();
+
+		if (startNode == nullptr || goalNode == nullptr) {
+			return std::vector<Node*>();
+		}
+
+		// A new goal (or a map that has been initialised again, or edited more than the map remembers) means starting over.
+		// Otherwise the search only has to hear about what changed: where the agent is now, and which cells were edited.
+		std::vector<int> editedCells;
+		if (goalNode->id != m_goal || (int)m_records.size() != m_map.GetNodeCount() || !m_map.GetEditsSince(m_version, editedCells)) {
+			Restart(startNode->id, goalNode->id);
+		}
+		else {
+			if (startNode->id != m_start) {
+				// Rather than re-keying the whole queue for the new start, every key from now on gets the distance moved added to it.
+				// That keeps the keys already queued no bigger than they should be, and ComputeShortestPath fixes each one when it reaches the front.
+				m_start = startNode->id;
+				m_keyModifier += Estimate(m_lastStart, m_start);
+				m_lastStart = m_start;
+			}
+
+			// An edited cell changes the edges into and out of it, and the diagonal steps past its corners, so every cell around it may have a different rhs now
+			const int width = m_map.GetWidth();
+			const int height = m_map.GetHeight();
+			for (int cell : editedCells) {
+				int x = cell % width;
+				int y = cell / width;
+				for (int ny = y - 1; ny <= y + 1; ny++) {
+					for (int nx = x - 1; nx <= x + 1; nx++) {
+						if (nx >= 0 && nx < width && ny >= 0 && ny < height) {
+							UpdateRhs(nx + width * ny);
+							UpdateVertex(nx + width * ny);
+						}
+					}
+				}
+			}
+		}
+		m_version = m_map.GetVersion();
+
+		ComputeShortestPath();
+		std::vector<Node*> path = m_map.GetNodeById(m_goal) != nullptr ? ExtractPath() : std::vector<Node*>();
+
+		m_stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		return path;
+	};
+
+	void DStarLite::Reset() {
+		m_records.clear();
+		m_queue.clear();
+		m_goal = -1;
+	};
+
+	SearchStats DStarLite::GetStats() const {
+		return m_stats;
+	};
+
+	size_t DStarLite::GetMemoryUsage() const {
+		// Each entry in the set is a separately allocated tree node: the entry, three links and a colour
+		return m_records.capacity() * sizeof(Record) + m_queue.size() * (sizeof(QueueEntry) + 4 * sizeof(void*));
+	};
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "NodeMap.h"
+#include <set>
+#include <vector>
+
+namespace AIForGames {
+	// D* Lite: a shortest path search that keeps its work between queries, for an agent heading to one goal on a map that keeps changing under it.
+	// It searches backwards from the goal, so every cell's g score is its distance to the goal. When the agent moves on, or a door opens or closes,
+	// only the cells whose distances the change can affect are searched again, instead of starting over from nothing.
+	// On a map edited every few frames, a repair usually expands a small fraction of what a fresh search would.
+	class DStarLite
+	{
+		// Cells are taken off the queue in order of this pair, smallest first, comparing the first numbers and then the second
+		struct Key {
+			float first;
+			float second;
+
+			bool operator<(const Key& other) const {
+				return first < other.first || (first == other.first && second < other.second);
+			};
+		};
+
+		// Equal keys go in id order, so the set never sees two entries as the same
+		struct QueueEntry {
+			Key key;
+			int id;
+
+			bool operator<(const QueueEntry& other) const {
+				if (key < other.key) return true;
+				if (other.key < key) return false;
+				return id < other.id;
+			};
+		};
+
+		// Everything the search knows about one cell.
+		// g is the cell's distance to the goal as last worked out; rhs is what its neighbours' g scores say it should be now.
+		// A cell whose two differ is 'inconsistent', and waits on the queue to have its g score (and so its neighbours' rhs) fixed.
+		struct Record {
+			float g;
+			float rhs;
+			Key key;
+			bool queued;
+		};
+
+		const NodeMap& m_map;
+		bool m_diagonal;
+
+		std::vector<Record> m_records;
+		std::set<QueueEntry> m_queue;
+
+		int m_start;
+		int m_goal;
+
+		// The agent's position when the queued keys were worked out, and how far it has moved since (added to every new key instead of re-keying the whole queue)
+		int m_lastStart;
+		float m_keyModifier;
+
+		// The map's version the search is up to date with
+		unsigned int m_version;
+
+		SearchStats m_stats;
+
+		// An estimate of the distance between two cells that never overestimates, in the same units as the edge costs
+		float Estimate(int fromId, int toId) const;
+
+		Key CalculateKey(int id) const;
+
+		// Recompute a cell's rhs from its neighbours (the goal's stays at 0)
+		void UpdateRhs(int id);
+
+		// Put the cell on the queue, move it or take it off, to match whether it's consistent
+		void UpdateVertex(int id);
+
+		// Fix inconsistent cells in key order until the start's distance is settled
+		void ComputeShortestPath();
+
+		// Throw away the whole search and start one from the goal
+		void Restart(int start, int goal);
+
+		// Follow the g scores downhill from the start to the goal
+		std::vector<Node*> ExtractPath() const;
+
+	public:
+		// The search keeps a reference to the map, so the map has to outlive it
+		DStarLite(const NodeMap& map);
+		~DStarLite();
+
+		// The shortest path from the start node to the goal node (empty if there isn't one).
+		// Keep calling this with the same goal as the agent moves and the map is edited (SetTileWalkable / SetTileCost), and only the part of the search
+		// the move or the edits can change is redone. Asking for a different goal starts a fresh search.
+		std::vector<Node*> FindPath(Node* startNode, Node* goalNode);
+
+		// Forget the search, so the next FindPath starts from scratch
+		void Reset();
+
+		// The work done by the last FindPath: nodesExpanded counts the cells taken off the queue
+		SearchStats GetStats() const;
+
+		// The bytes used by the search's per-cell records and its queue
+		size_t GetMemoryUsage() const;
+	};
+}
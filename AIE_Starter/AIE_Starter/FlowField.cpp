@@ -0,0 +1,238 @@
+#include "FlowField.h"
+#include <chrono>
+#include <limits>
+
+namespace AIForGames {
+	namespace {
+		const float infinity = std::numeric_limits<float>::infinity();
+
+		// The eight directions a cell can step in, in the order NodeMap::ForEachNeighbour visits them (the straight ones first)
+		const int directionX[8] = { -1, 0, 1, 0, -1, 1, -1, 1 };
+		const int directionY[8] = { 0, -1, 0, 1, -1, -1, 1, 1 };
+
+		// The direction index of a step of (dx, dy), looked up by (dx + 1) + 3 * (dy + 1)
+		const signed char directionIndex[9] = { 4, 1, 5, 0, -1, 2, 6, 3, 7 };
+	}
+
+	FlowField::FlowField(const NodeMap& map) : m_map(map) {
+		m_goal = -1;
+		m_version = map.GetVersion();
+		m_stats = SearchStats();
+	};
+
+	FlowField::~FlowField() {};
+
+	int FlowField::GetNextCell(int id) const {
+		int direction = m_directions[id];
+		if (direction < 0) {
+			return -1;
+		}
+		return id + directionX[direction] + m_map.GetWidth() * directionY[direction];
+	};
+
+	void FlowField::Improve(int id, int nextCell, float distance) {
+		const int width = m_map.GetWidth();
+		m_distances[id] = distance;
+		m_directions[id] = directionIndex[(nextCell % width - id % width + 1) + 3 * (nextCell / width - id / width + 1)];
+
+		if (m_context.GetListState(id) == SearchContext::Open) {
+			m_context.OpenList().DecreaseKey(id, distance);
+		}
+		else {
+			// A repair can find a shorter way to a cell it has already closed, so closed cells go back on the open list too
+			m_context.SetListState(id, SearchContext::Open);
+			m_context.OpenList().Push(id, distance);
+			m_stats.nodesOpened++;
+		}
+	};
+
+	void FlowField::ImproveFromNeighbours(int id) {
+		if (id == m_goal || !m_map.IsWalkable(id % m_map.GetWidth(), id / m_map.GetWidth())) {
+			return;
+		}
+		m_map.ForEachNeighbour(id, [&](int targetNode, float cost) {
+			float distance = cost + m_distances[targetNode];
+			if (distance < m_distances[id]) {
+				Improve(id, targetNode, distance);
+			}
+		});
+	};
+
+	void FlowField::Propagate() {
+		// Dijkstra's algorithm run backwards: every edge into the current cell is one its neighbour could use to get to the goal
+		NodeQueue& openList = m_context.OpenList();
+		while (!openList.Empty()) {
+			int currentNode = openList.Pop();
+			m_context.SetListState(currentNode, SearchContext::Closed);
+			m_stats.nodesExpanded++;
+
+			float currentDistance = m_distances[currentNode];
+			m_map.ForEachNeighbour(currentNode, [&](int sourceNode, float) {
+				float distance = currentDistance + m_map.GetStepCost(sourceNode, currentNode);
+				if (distance < m_distances[sourceNode]) {
+					Improve(sourceNode, currentNode, distance);
+				}
+			});
+		}
+	};
+
+	void FlowField::Build(Node* goalNode) {
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		m_stats = SearchStats();
+		m_goal = goalNode != nullptr ? goalNode->id : -1;
+		Rebuild();
+		m_stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	};
+
+	void FlowField::Rebuild() {
+		m_version = m_map.GetVersion();
+
+		const int nodeCount = m_map.GetNodeCount();
+		m_distances.assign(nodeCount, infinity);
+		m_directions.assign(nodeCount, -1);
+		m_context.Begin(nodeCount);
+
+		// A goal that has been walled in (or is off a map that has been initialised again) can't be reached from anywhere
+		if (m_goal >= 0 && m_goal < nodeCount && m_map.GetNodeById(m_goal) != nullptr) {
+			m_distances[m_goal] = 0.0f;
+			m_context.SetListState(m_goal, SearchContext::Open);
+			m_context.OpenList().Push(m_goal, 0.0f);
+			m_stats.nodesOpened++;
+			Propagate();
+		}
+	};
+
+	void FlowField::Invalidate(int id, std::vector<int>& invalidated) {
+		const int width = m_map.GetWidth();
+		const int height = m_map.GetHeight();
+
+		// Walk the direction field backwards: a cell whose direction points at an invalidated cell is invalid too
+		std::vector<int> stack;
+		stack.push_back(id);
+		m_distances[id] = infinity;
+		m_directions[id] = -1;
+		invalidated.push_back(id);
+
+		while (!stack.empty()) {
+			int cell = stack.back();
+			stack.pop_back();
+			int x = cell % width;
+			int y = cell / width;
+
+			for (int direction = 0; direction < 8; direction++) {
+				int sourceX = x - directionX[direction];
+				int sourceY = y - directionY[direction];
+				if (sourceX < 0 || sourceX >= width || sourceY < 0 || sourceY >= height) {
+					continue;
+				}
+
+				int sourceNode = sourceX + width * sourceY;
+				if (m_directions[sourceNode] == direction) {
+					m_distances[sourceNode] = infinity;
+					m_directions[sourceNode] = -1;
+					invalidated.push_back(sourceNode);
+					stack.push_back(sourceNode);
+				}
+			}
+		}
+	};
+
+	void FlowField::Repair(const std::vector<int>& cells) {
+		const int width = m_map.GetWidth();
+		const int height = m_map.GetHeight();
+		m_context.Begin(m_map.GetNodeCount());
+
+		// An edit changes the edges into and out of the cell, and the diagonal steps past its corners, so only the cells around it can have a step that changed
+		std::vector<int> suspects;
+		for (int cell : cells) {
+			int x = cell % width;
+			int y = cell / width;
+			for (int ny = y - 1; ny <= y + 1; ny++) {
+				for (int nx = x - 1; nx <= x + 1; nx++) {
+					if (nx >= 0 && nx < width && ny >= 0 && ny < height) {
+						suspects.push_back(nx + width * ny);
+					}
+				}
+			}
+		}
+
+		// 1: A cell whose step towards the goal is gone, or costs something different now, loses its distance, along with everything upstream of it.
+		// Everything else still has a real way to the goal at the distance it had, which can only have got shorter.
+		std::vector<int> invalidated;
+		for (int cell : suspects) {
+			if (cell == m_goal || m_distances[cell] == infinity) {
+				continue;
+			}
+
+			int nextCell = GetNextCell(cell);
+			bool stillValid = false;
+			if (m_map.IsWalkable(cell % width, cell / width)) {
+				m_map.ForEachNeighbour(cell, [&](int targetNode, float cost) {
+					if (targetNode == nextCell && cost + m_distances[nextCell] == m_distances[cell]) {
+						stillValid = true;
+					}
+				});
+			}
+			if (!stillValid) {
+				Invalidate(cell, invalidated);
+			}
+		}
+
+		// 2: The invalidated cells take what their neighbours can offer, and the cells around each edit look for a way through anything opened up or made cheaper
+		for (int cell : invalidated) {
+			ImproveFromNeighbours(cell);
+		}
+		for (int cell : suspects) {
+			ImproveFromNeighbours(cell);
+		}
+
+		// 3: Spread the new distances out from there
+		Propagate();
+	};
+
+	bool FlowField::Update() {
+		if (m_version == m_map.GetVersion()) {
+			return false;
+		}
+
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		m_stats = SearchStats();
+
+		// A walled-in goal empties the whole field, and the goal being opened again refills it, so neither is worth repairing
+		std::vector<int> cells;
+		bool goalWalkable = m_goal >= 0 && m_goal < m_map.GetNodeCount() && m_map.GetNodeById(m_goal) != nullptr;
+		if ((int)m_distances.size() != m_map.GetNodeCount() || !m_map.GetEditsSince(m_version, cells) || !goalWalkable || m_distances[m_goal] != 0.0f) {
+			Rebuild();
+		}
+		else {
+			Repair(cells);
+			m_version = m_map.GetVersion();
+		}
+		m_stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		return true;
+	};
+
+	int FlowField::GetGoal() const {
+		return m_goal;
+	};
+
+	float FlowField::GetDistance(int id) const {
+		return m_distances[id];
+	};
+
+	Node* FlowField::GetNextNode(Node* node) const {
+		if (node == nullptr) {
+			return nullptr;
+		}
+		int nextCell = GetNextCell(node->id);
+		return nextCell >= 0 ? m_map.GetNodeById(nextCell) : nullptr;
+	};
+
+	SearchStats FlowField::GetStats() const {
+		return m_stats;
+	};
+
+	size_t FlowField::GetMemoryUsage() const {
+		return m_distances.capacity() * sizeof(float) + m_directions.capacity() * sizeof(signed char);
+	};
+}
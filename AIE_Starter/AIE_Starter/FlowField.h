@@ -0,0 +1,73 @@
+#pragma once
+#include "NodeMap.h"
+#include <vector>
+
+namespace AIForGames {
+	// A flow field: every cell's way to one goal, worked out by a single search backwards from the goal.
+	// The integration field holds each cell's distance to the goal, and the direction field holds which neighbour to step to from each cell to get there.
+	// Any number of agents heading for the goal can then find their next step with one lookup, however many of them there are.
+	// When the map is edited, Update repairs only the cells whose way to the goal went through (or can now go through) the edited cells.
+	class FlowField
+	{
+		const NodeMap& m_map;
+		int m_goal;
+
+		// The map's version the field is up to date with
+		unsigned int m_version;
+
+		// The integration field: each cell's distance to the goal (infinity if the goal can't be reached from it)
+		std::vector<float> m_distances;
+
+		// The direction field: which of the eight neighbours to step to from each cell, as an index into the offsets in FlowField.cpp (-1 at the goal and wherever it can't be reached)
+		std::vector<signed char> m_directions;
+
+		// Only the open list and its flags are used; the distances live in the field itself
+		SearchContext m_context;
+		SearchStats m_stats;
+
+		// Set a cell's distance and direction from one of its neighbours, and put it on the open list
+		void Improve(int id, int nextCell, float distance);
+
+		// Give a cell the best distance its neighbours can offer, if that's better than the one it has
+		void ImproveFromNeighbours(int id);
+
+		// Run the backwards search from whatever is on the open list until nothing more can be improved
+		void Propagate();
+
+		// Forget the distance of a cell and of every cell whose way to the goal runs through it
+		void Invalidate(int id, std::vector<int>& invalidated);
+
+		// Work out the whole field for m_goal from scratch
+		void Rebuild();
+
+		// Bring the field up to date after the given cells were edited
+		void Repair(const std::vector<int>& cells);
+
+	public:
+		// The field keeps a reference to the map, so the map has to outlive it
+		FlowField(const NodeMap& map);
+		~FlowField();
+
+		// Work out the whole field for the goal from scratch
+		void Build(Node* goalNode);
+
+		// Catch up with the tile edits made since the field was built or last updated.
+		// Returns false if there was nothing to do. If the map has been initialised again (or edited more than it remembers) the whole field is built again.
+		bool Update();
+
+		int GetGoal() const;
+
+		// The distance from the cell with the given node id to the goal (infinity if it can't get there)
+		float GetDistance(int id) const;
+
+		// The next cell on the way to the goal from the given one, or -1 at the goal itself or where the goal can't be reached
+		int GetNextCell(int id) const;
+		Node* GetNextNode(Node* node) const;
+
+		// The work done by the last Build or Update
+		SearchStats GetStats() const;
+
+		// The bytes held by the two fields
+		size_t GetMemoryUsage() const;
+	};
+}
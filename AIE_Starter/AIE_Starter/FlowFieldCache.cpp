@@ -0,0 +1,67 @@
+#include "FlowFieldCache.h"
+
+namespace AIForGames {
+	FlowFieldCache::FlowFieldCache(const NodeMap& map, size_t maxFields) : m_map(map) {
+		m_maxFields = maxFields > 0 ? maxFields : 1;
+		m_stats = FlowFieldCacheStats();
+	};
+
+	FlowFieldCache::~FlowFieldCache() {};
+
+	FlowField* FlowFieldCache::GetField(Node* goalNode) {
+		if (goalNode == nullptr) {
+			return nullptr;
+		}
+
+		std::unordered_map<int, std::list<CachedField>::iterator>::iterator found = m_fieldIndex.find(goalNode->id);
+		if (found != m_fieldIndex.end()) {
+			m_fields.splice(m_fields.begin(), m_fields, found->second);
+			FlowField* field = found->second->field.get();
+
+			// Checking the map's version is all this costs when nothing has been edited
+			if (field->Update()) {
+				m_stats.repairs++;
+			}
+			else {
+				m_stats.hits++;
+			}
+			return field;
+		}
+
+		m_fields.push_front(CachedField());
+		m_fields.front().goal = goalNode->id;
+		m_fields.front().field.reset(new FlowField(m_map));
+		m_fields.front().field->Build(goalNode);
+		m_fieldIndex[goalNode->id] = m_fields.begin();
+		m_stats.builds++;
+
+		if (m_fields.size() > m_maxFields) {
+			m_fieldIndex.erase(m_fields.back().goal);
+			m_fields.pop_back();
+			m_stats.evictions++;
+		}
+		return m_fields.front().field.get();
+	};
+
+	Node* FlowFieldCache::GetNextNode(Node* node, Node* goalNode) {
+		FlowField* field = GetField(goalNode);
+		return field != nullptr ? field->GetNextNode(node) : nullptr;
+	};
+
+	void FlowFieldCache::Clear() {
+		m_fields.clear();
+		m_fieldIndex.clear();
+	};
+
+	FlowFieldCacheStats FlowFieldCache::GetStats() const {
+		return m_stats;
+	};
+
+	size_t FlowFieldCache::GetMemoryUsage() const {
+		size_t bytes = 0;
+		for (const CachedField& cached : m_fields) {
+			bytes += sizeof(CachedField) + sizeof(FlowField) + cached.field->GetMemoryUsage();
+		}
+		return bytes;
+	};
+}
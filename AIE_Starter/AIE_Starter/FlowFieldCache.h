@@ -0,0 +1,58 @@
+#pragma once
+#include "FlowField.h"
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+namespace AIForGames {
+	// How well a FlowFieldCache has been doing since it was made
+	struct FlowFieldCacheStats {
+		// Lookups answered by a field that was already built
+		int hits;
+		// Fields built for a goal nobody had asked about (or that had been evicted)
+		int builds;
+		// Times a field was repaired after the map was edited
+		int repairs;
+		// Fields thrown out to stay within the limit
+		int evictions;
+	};
+
+	// Keeps a FlowField for each goal in use, so a crowd heading for the same place shares one field instead of each agent searching.
+	// Fields are built the first time their goal is asked for and repaired (FlowField::Update) the next time they're used after the map is edited.
+	// A least-recently-used cache with a fixed number of fields. Unlike PathCache it isn't locked: use it from the thread that updates the agents and edits the map.
+	class FlowFieldCache
+	{
+		struct CachedField {
+			int goal;
+			std::unique_ptr<FlowField> field;
+		};
+
+		const NodeMap& m_map;
+		size_t m_maxFields;
+
+		// Most recently used at the front, with the map pointing into the list so a hit can be moved to the front without a search
+		std::list<CachedField> m_fields;
+		std::unordered_map<int, std::list<CachedField>::iterator> m_fieldIndex;
+
+		FlowFieldCacheStats m_stats;
+
+	public:
+		// The cache keeps a reference to the map, so the map has to outlive it
+		FlowFieldCache(const NodeMap& map, size_t maxFields = 8);
+		~FlowFieldCache();
+
+		// The flow field towards the goal, up to date with the map. The pointer stays valid until the field is evicted by asking for more than maxFields other goals.
+		FlowField* GetField(Node* goalNode);
+
+		// The next node on the way from the node to the goal (nullptr at the goal, or if it can't be reached): a single lookup once the field exists
+		Node* GetNextNode(Node* node, Node* goalNode);
+
+		// Throw every field away
+		void Clear();
+
+		FlowFieldCacheStats GetStats() const;
+
+		// The bytes held by the cached fields
+		size_t GetMemoryUsage() const;
+	};
+}
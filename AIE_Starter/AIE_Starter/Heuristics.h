@@ -0,0 +1,43 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cmath>
+
+namespace AIForGames {
+	// Heuristic policies for NodeMap::AStarSearch. Each one estimates the distance between two node positions, and the search is templated on
+	// the policy so the estimate is inlined into the search loop instead of being called through a function pointer.
+	// Every estimate is in the same units as the positions; the search converts it into edge cost by dividing by the map's cell size.
+
+	// No estimate at all, which turns A* back into Dijkstra's algorithm
+	struct ZeroHeuristic {
+		static float Estimate(const glm::vec2& from, const glm::vec2& to) {
+			return 0.0f;
+		};
+	};
+
+	// Horizontal plus vertical distance: the exact cost on an open 4-connected grid, so it expands the fewest nodes there
+	struct ManhattanHeuristic {
+		static float Estimate(const glm::vec2& from, const glm::vec2& to) {
+			return std::fabs(to.x - from.x) + std::fabs(to.y - from.y);
+		};
+	};
+
+	// Diagonal steps for the shorter axis and straight steps for the rest: the exact cost on an open 8-connected grid
+	struct OctileHeuristic {
+		static float Estimate(const glm::vec2& from, const glm::vec2& to) {
+			float dx = std::fabs(to.x - from.x);
+			float dy = std::fabs(to.y - from.y);
+			return dx > dy
+				? dx + (1.41421356f - 1.0f) * dy
+				: dy + (1.41421356f - 1.0f) * dx;
+		};
+	};
+
+	// Straight line distance, which never overestimates however the grid is connected
+	struct EuclideanHeuristic {
+		static float Estimate(const glm::vec2& from, const glm::vec2& to) {
+			float dx = to.x - from.x;
+			float dy = to.y - from.y;
+			return std::sqrt(dx * dx + dy * dy);
+		};
+	};
+}
@@ -0,0 +1,416 @@
+#include "HierarchicalMap.h"
+#include "Heuristics.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace AIForGames {
+	namespace {
+		const float infinity = std::numeric_limits<float>::infinity();
+
+		// Openings along a border at least this wide get a transition at each end instead of one in the middle
+		const int wideOpening = 6;
+	}
+
+	HierarchicalMap::HierarchicalMap(const NodeMap& map, int clusterSize) : m_map(map) {
+		m_version = map.GetVersion();
+		m_clusterSize = clusterSize;
+		m_clustersX = 0;
+		m_clustersY = 0;
+	};
+
+	HierarchicalMap::~HierarchicalMap() {};
+
+	int HierarchicalMap::GetClusterOf(int cell) const {
+		int x = cell % m_map.GetWidth();
+		int y = cell / m_map.GetWidth();
+		return (x / m_clusterSize) + m_clustersX * (y / m_clusterSize);
+	};
+
+	float HierarchicalMap::GetEdgeCost(int fromCell, int toCell) const {
+		float edgeCost = infinity;
+		m_map.ForEachNeighbour(fromCell, [&](int target, float cost) {
+			if (target == toCell) {
+				edgeCost = cost;
+			}
+		});
+		return edgeCost;
+	};
+
+	void HierarchicalMap::SearchCluster(const Cluster& cluster, int startCell, int endCell, SearchContext& context, bool backwards) const {
+		const int width = m_map.GetWidth();
+
+		context.Begin(m_map.GetNodeCount());
+		context.SetScore(startCell, 0.0f, -1);
+		context.SetListState(startCell, SearchContext::Open);
+		NodeQueue& openList = context.OpenList();
+		openList.Push(startCell, 0.0f);
+
+		while (!openList.Empty()) {
+			int currentNode = openList.Pop();
+			if (currentNode == endCell) {
+				break;
+			}
+			context.SetListState(currentNode, SearchContext::Closed);
+			float currentG = context.GetGScore(currentNode);
+
+			m_map.ForEachNeighbour(currentNode, [&](int targetNode, float cost) {
+				// Cells outside the cluster don't exist as far as this search is concerned
+				int x = targetNode % width;
+				int y = targetNode / width;
+				if (x < cluster.left || x >= cluster.right || y < cluster.top || y >= cluster.bottom) {
+					return;
+				}
+
+				// Every edge has a twin going the other way, but with weighted tiles the twin can cost something different
+				if (backwards) {
+					cost = m_map.GetStepCost(targetNode, currentNode);
+				}
+
+				SearchContext::ListState targetState = context.GetListState(targetNode);
+				float calcdG = currentG + cost;
+				if (targetState == SearchContext::Unvisited) {
+					context.SetScore(targetNode, calcdG, currentNode);
+					context.SetListState(targetNode, SearchContext::Open);
+					openList.Push(targetNode, calcdG);
+				}
+				else if (targetState == SearchContext::Open && calcdG < context.GetGScore(targetNode)) {
+					context.SetScore(targetNode, calcdG, currentNode);
+					openList.DecreaseKey(targetNode, calcdG);
+				}
+			});
+		}
+	};
+
+	void HierarchicalMap::BuildBorder(int clusterIndex, int neighbourIndex) {
+		Cluster& cluster = m_clusters[clusterIndex];
+		Cluster& neighbour = m_clusters[neighbourIndex];
+		const int width = m_map.GetWidth();
+
+		// Forget the transitions this border had before
+		cluster.transitions.erase(std::remove_if(cluster.transitions.begin(), cluster.transitions.end(),
+			[&](const Transition& transition) { return GetClusterOf(transition.partnerCell) == neighbourIndex; }), cluster.transitions.end());
+		neighbour.transitions.erase(std::remove_if(neighbour.transitions.begin(), neighbour.transitions.end(),
+			[&](const Transition& transition) { return GetClusterOf(transition.partnerCell) == clusterIndex; }), neighbour.transitions.end());
+
+		// The neighbour is either to the right (a vertical border) or below (a horizontal one)
+		bool vertical = neighbour.left != cluster.left;
+		int length = vertical ? cluster.bottom - cluster.top : cluster.right - cluster.left;
+
+		// The cell on each side of the border at position i along it
+		auto cellPair = [&](int i, int& cell, int& partnerCell) {
+			int x = vertical ? cluster.right - 1 : cluster.left + i;
+			int y = vertical ? cluster.top + i : cluster.bottom - 1;
+			cell = x + width * y;
+			partnerCell = vertical ? cell + 1 : cell + width;
+		};
+
+		auto addTransition = [&](int i) {
+			int cell;
+			int partnerCell;
+			cellPair(i, cell, partnerCell);
+			cluster.transitions.push_back({ cell, partnerCell, GetEdgeCost(cell, partnerCell) });
+			neighbour.transitions.push_back({ partnerCell, cell, GetEdgeCost(partnerCell, cell) });
+		};
+
+		// Walk along the border finding each run of cells that are open on both sides
+		int runStart = -1;
+		for (int i = 0; i <= length; i++) {
+			bool open = false;
+			if (i < length) {
+				int cell;
+				int partnerCell;
+				cellPair(i, cell, partnerCell);
+				open = m_map.IsWalkable(cell % width, cell / width) && m_map.IsWalkable(partnerCell % width, partnerCell / width);
+			}
+
+			if (open && runStart < 0) {
+				runStart = i;
+			}
+			else if (!open && runStart >= 0) {
+				// A narrow opening only needs one transition, in its middle. A wide one gets one at each end, so paths running along it don't detour through the middle.
+				if (i - runStart < wideOpening) {
+					addTransition((runStart + i - 1) / 2);
+				}
+				else {
+					addTransition(runStart);
+					addTransition(i - 1);
+				}
+				runStart = -1;
+			}
+		}
+	};
+
+	void HierarchicalMap::BuildCluster(int clusterIndex) {
+		Cluster& cluster = m_clusters[clusterIndex];
+
+		for (int cell : cluster.entrances) {
+			m_entranceIndex.erase(cell);
+		}
+		cluster.entrances.clear();
+
+		// A cell on a corner of the cluster can have a transition across each of two borders, but it's still only one entrance
+		for (const Transition& transition : cluster.transitions) {
+			if (m_entranceIndex.find(transition.cell) == m_entranceIndex.end()) {
+				m_entranceIndex[transition.cell] = (int)cluster.entrances.size();
+				cluster.entrances.push_back(transition.cell);
+			}
+		}
+
+		// One search from each entrance finds its distance to all the others
+		int entranceCount = (int)cluster.entrances.size();
+		cluster.distances.assign(entranceCount * entranceCount, infinity);
+		for (int from = 0; from < entranceCount; from++) {
+			SearchCluster(cluster, cluster.entrances[from], -1, m_buildContext);
+			for (int to = 0; to < entranceCount; to++) {
+				cluster.distances[from * entranceCount + to] = m_buildContext.GetGScore(cluster.entrances[to]);
+			}
+		}
+	};
+
+	void HierarchicalMap::Build() {
+		const int width = m_map.GetWidth();
+		const int height = m_map.GetHeight();
+		m_version = m_map.GetVersion();
+		m_clustersX = (width + m_clusterSize - 1) / m_clusterSize;
+		m_clustersY = (height + m_clusterSize - 1) / m_clusterSize;
+
+		m_clusters.clear();
+		m_clusters.resize(m_clustersX * m_clustersY);
+		m_entranceIndex.clear();
+
+		for (int cy = 0; cy < m_clustersY; cy++) {
+			for (int cx = 0; cx < m_clustersX; cx++) {
+				Cluster& cluster = m_clusters[cx + m_clustersX * cy];
+				cluster.left = cx * m_clusterSize;
+				cluster.top = cy * m_clusterSize;
+				cluster.right = std::min(cluster.left + m_clusterSize, width);
+				cluster.bottom = std::min(cluster.top + m_clusterSize, height);
+			}
+		}
+
+		for (int cy = 0; cy < m_clustersY; cy++) {
+			for (int cx = 0; cx < m_clustersX; cx++) {
+				int clusterIndex = cx + m_clustersX * cy;
+				if (cx + 1 < m_clustersX) {
+					BuildBorder(clusterIndex, clusterIndex + 1);
+				}
+				if (cy + 1 < m_clustersY) {
+					BuildBorder(clusterIndex, clusterIndex + m_clustersX);
+				}
+			}
+		}
+
+		for (int clusterIndex = 0; clusterIndex < (int)m_clusters.size(); clusterIndex++) {
+			BuildCluster(clusterIndex);
+		}
+	};
+
+	void HierarchicalMap::RebuildAround(int x, int y) {
+		int cx = x / m_clusterSize;
+		int cy = y / m_clusterSize;
+		int clusterIndex = cx + m_clustersX * cy;
+
+		// The cell can change the transitions on any of its cluster's borders, and so the entrances of the clusters on the other side of them
+		std::vector<int> rebuild;
+		rebuild.push_back(clusterIndex);
+		if (cx > 0) {
+			BuildBorder(clusterIndex - 1, clusterIndex);
+			rebuild.push_back(clusterIndex - 1);
+		}
+		if (cx + 1 < m_clustersX) {
+			BuildBorder(clusterIndex, clusterIndex + 1);
+			rebuild.push_back(clusterIndex + 1);
+		}
+		if (cy > 0) {
+			BuildBorder(clusterIndex - m_clustersX, clusterIndex);
+			rebuild.push_back(clusterIndex - m_clustersX);
+		}
+		if (cy + 1 < m_clustersY) {
+			BuildBorder(clusterIndex, clusterIndex + m_clustersX);
+			rebuild.push_back(clusterIndex + m_clustersX);
+		}
+
+		for (int index : rebuild) {
+			BuildCluster(index);
+		}
+	};
+
+	void HierarchicalMap::Update() {
+		std::vector<int> cells;
+		if (!m_map.GetEditsSince(m_version, cells)) {
+			Build();
+			return;
+		}
+		m_version = m_map.GetVersion();
+
+		// A door opening and closing in the same cluster only needs that cluster rebuilding once
+		std::vector<int> rebuilt;
+		for (int cell : cells) {
+			int clusterIndex = GetClusterOf(cell);
+			if (std::find(rebuilt.begin(), rebuilt.end(), clusterIndex) == rebuilt.end()) {
+				rebuilt.push_back(clusterIndex);
+				RebuildAround(cell % m_map.GetWidth(), cell / m_map.GetWidth());
+			}
+		}
+	};
+
+	int HierarchicalMap::GetClusterCount() const {
+		return (int)m_clusters.size();
+	};
+
+	int HierarchicalMap::GetEntranceCount() const {
+		return (int)m_entranceIndex.size();
+	};
+
+	std::vector<int> HierarchicalMap::FindAbstractPath(Node* startNode, Node* endNode, SearchContext& context) const {
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		SearchStats stats = SearchStats();
+
+		// Nothing to search for between two components of the map
+		if (startNode == nullptr || endNode == nullptr || !m_map.AreConnected(startNode, endNode)) {
+			context.SetStats(stats);
+			return std::vector<int>();
+		}
+
+		const int startCell = startNode->id;
+		const int endCell = endNode->id;
+		const int startClusterIndex = GetClusterOf(startCell);
+		const int endClusterIndex = GetClusterOf(endCell);
+		const Cluster& startCluster = m_clusters[startClusterIndex];
+		const Cluster& endCluster = m_clusters[endClusterIndex];
+
+		// Join the start onto the abstract graph: its distance to each entrance of its own cluster (and to the end, if that's in the same cluster)
+		SearchCluster(startCluster, startCell, -1, context);
+		std::vector<float> fromStart(startCluster.entrances.size());
+		for (size_t i = 0; i < fromStart.size(); i++) {
+			fromStart[i] = context.GetGScore(startCluster.entrances[i]);
+		}
+		float direct = startClusterIndex == endClusterIndex ? context.GetGScore(endCell) : infinity;
+
+		// And the end: a backwards search from it gives each entrance's distance in to it (weighted tiles make that different from the distance out)
+		SearchCluster(endCluster, endCell, -1, context, true);
+		std::vector<float> toEnd(endCluster.entrances.size());
+		for (size_t i = 0; i < toEnd.size(); i++) {
+			toEnd[i] = context.GetGScore(endCluster.entrances[i]);
+		}
+
+		// A* over the start, the entrances and the end
+		const float heuristicScale = 1.0f / m_map.GetCellSize();
+		const glm::vec2 goal = m_map.GetPosition(endCell);
+		const bool diagonal = m_map.GetGraph() == GridGraph::Implicit8;
+		auto estimate = [&](int cell) -> float {
+			glm::vec2 position = m_map.GetPosition(cell);
+			return (diagonal ? OctileHeuristic::Estimate(position, goal) : ManhattanHeuristic::Estimate(position, goal)) * heuristicScale;
+		};
+
+		context.Begin(m_map.GetNodeCount());
+		NodeQueue& openList = context.OpenList();
+		context.SetScore(startCell, 0.0f, -1);
+		context.SetListState(startCell, SearchContext::Open);
+		openList.Push(startCell, estimate(startCell));
+		stats.nodesOpened++;
+
+		while (!openList.Empty()) {
+			int currentNode = openList.Pop();
+			if (currentNode == endCell) {
+				break;
+			}
+			context.SetListState(currentNode, SearchContext::Closed);
+			stats.nodesExpanded++;
+			float currentG = context.GetGScore(currentNode);
+
+			auto relax = [&](int targetNode, float cost) {
+				if (cost == infinity) {
+					return;
+				}
+				SearchContext::ListState targetState = context.GetListState(targetNode);
+				float calcdG = currentG + cost;
+				if (targetState == SearchContext::Unvisited) {
+					context.SetScore(targetNode, calcdG, currentNode);
+					context.SetListState(targetNode, SearchContext::Open);
+					openList.Push(targetNode, calcdG + estimate(targetNode));
+					stats.nodesOpened++;
+				}
+				else if (targetState == SearchContext::Open && calcdG < context.GetGScore(targetNode)) {
+					context.SetScore(targetNode, calcdG, currentNode);
+					openList.DecreaseKey(targetNode, calcdG + estimate(targetNode));
+				}
+			};
+
+			if (currentNode == startCell) {
+				for (size_t i = 0; i < fromStart.size(); i++) {
+					relax(startCluster.entrances[i], fromStart[i]);
+				}
+				relax(endCell, direct);
+			}
+
+			// The start can be an entrance too, so this isn't an else
+			std::unordered_map<int, int>::const_iterator found = m_entranceIndex.find(currentNode);
+			if (found != m_entranceIndex.end()) {
+				int clusterIndex = GetClusterOf(currentNode);
+				const Cluster& cluster = m_clusters[clusterIndex];
+				int entranceCount = (int)cluster.entrances.size();
+				int from = found->second;
+
+				for (int to = 0; to < entranceCount; to++) {
+					if (to != from) {
+						relax(cluster.entrances[to], cluster.distances[from * entranceCount + to]);
+					}
+				}
+				for (const Transition& transition : cluster.transitions) {
+					if (transition.cell == currentNode) {
+						relax(transition.partnerCell, transition.cost);
+					}
+				}
+				if (clusterIndex == endClusterIndex) {
+					relax(endCell, toEnd[from]);
+				}
+			}
+		}
+
+		std::vector<int> path = context.BuildPath(endCell);
+		stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		context.SetStats(stats);
+		return path;
+	};
+
+	std::vector<Node*> HierarchicalMap::RefineSegment(int fromCell, int toCell, SearchContext& context) const {
+		// Consecutive cells in different clusters are the two sides of a transition, one step apart
+		int clusterIndex = GetClusterOf(fromCell);
+		if (clusterIndex != GetClusterOf(toCell)) {
+			std::vector<Node*> step;
+			step.push_back(m_map.GetNodeById(fromCell));
+			step.push_back(m_map.GetNodeById(toCell));
+			return step;
+		}
+
+		SearchCluster(m_clusters[clusterIndex], fromCell, toCell, context);
+		return m_map.ToNodePath(context.BuildPath(toCell));
+	};
+
+	std::vector<Node*> HierarchicalMap::FindPath(Node* startNode, Node* endNode, SearchContext& context) const {
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		std::vector<int> waypoints = FindAbstractPath(startNode, endNode, context);
+		SearchStats stats = context.GetStats();
+
+		std::vector<Node*> path;
+		if (waypoints.size() == 1) {
+			path.push_back(startNode);
+		}
+		for (size_t i = 1; i < waypoints.size(); i++) {
+			std::vector<Node*> segment = RefineSegment(waypoints[i - 1], waypoints[i], context);
+			if (segment.empty()) {
+				path.clear();
+				break;
+			}
+
+			// Each segment starts where the last one ended, so skip its first node
+			path.insert(path.end(), path.empty() ? segment.begin() : segment.begin() + 1, segment.end());
+		}
+
+		stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		context.SetStats(stats);
+		return path;
+	};
+}
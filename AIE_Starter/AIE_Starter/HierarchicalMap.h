@@ -0,0 +1,90 @@
+#pragma once
+#include "NodeMap.h"
+#include <unordered_map>
+#include <vector>
+
+namespace AIForGames {
+	// A hierarchical (HPA*) layer over a NodeMap, for long paths on big maps.
+	// The map is cut into square clusters. Wherever two neighbouring clusters share an open stretch of border, a cell on each side becomes an 'entrance',
+	// and the shortest distance between every pair of entrances inside each cluster is worked out once, up front.
+	// A query then only searches the small abstract graph of entrances to plan the route, and the cell-by-cell path is only found for one segment at a time.
+	class HierarchicalMap
+	{
+		// A step from an entrance cell of one cluster to the cell just across the border in the neighbouring cluster
+		struct Transition {
+			int cell;
+			int partnerCell;
+			float cost;
+		};
+
+		struct Cluster {
+			// The cells the cluster covers: left <= x < right, top <= y < bottom
+			int left;
+			int top;
+			int right;
+			int bottom;
+
+			std::vector<Transition> transitions;
+
+			// Every cell that has at least one transition, and the distance from each to each inside the cluster
+			// (distances[from * entrances.size() + to], infinity where the cluster's walls keep them apart)
+			std::vector<int> entrances;
+			std::vector<float> distances;
+		};
+
+		const NodeMap& m_map;
+		unsigned int m_version;
+		int m_clusterSize;
+		int m_clustersX;
+		int m_clustersY;
+		std::vector<Cluster> m_clusters;
+
+		// Entrance cell -> its index in its cluster's entrance list
+		std::unordered_map<int, int> m_entranceIndex;
+
+		// Scratch data for the searches run while building
+		SearchContext m_buildContext;
+
+		int GetClusterOf(int cell) const;
+
+		// The cost of the map's edge from one cell to a neighbouring one (infinity if there isn't one)
+		float GetEdgeCost(int fromCell, int toCell) const;
+
+		// Dijkstra's algorithm from one cell that never leaves the cluster, stopping early at the end cell if one is given (-1 to search the whole cluster).
+		// A backwards search follows the edges the wrong way, so its g scores are the distances from each cell to the start cell instead of from it.
+		void SearchCluster(const Cluster& cluster, int startCell, int endCell, SearchContext& context, bool backwards = false) const;
+
+		// Find the transitions across the border between a cluster and its neighbour to the right or below
+		void BuildBorder(int clusterIndex, int neighbourIndex);
+
+		// Collect a cluster's entrances from its transitions and work out the distances between them
+		void BuildCluster(int clusterIndex);
+
+	public:
+		// The layer keeps a reference to the map, so the map has to outlive it. Build() has to be called before the first query.
+		HierarchicalMap(const NodeMap& map, int clusterSize = 16);
+		~HierarchicalMap();
+
+		// Build every cluster's entrances and distances from scratch
+		void Build();
+
+		// Rebuild only what a change to the cell at (x, y) can affect: the borders of its cluster, and that cluster's and its four neighbours' distances
+		void RebuildAround(int x, int y);
+
+		// Catch up with the tile edits made to the map since the last Build or Update, rebuilding around each edited cluster once (or everything, if the map has been initialised again)
+		void Update();
+
+		int GetClusterCount() const;
+		int GetEntranceCount() const;
+
+		// Plan a route at the cluster level: the start cell, the entrance cells to pass through, then the end cell (empty if the end can't be reached).
+		// The work done by the abstract search is left in context.GetStats().
+		std::vector<int> FindAbstractPath(Node* startNode, Node* endNode, SearchContext& context) const;
+
+		// The cell-by-cell path between two consecutive cells of an abstract path
+		std::vector<Node*> RefineSegment(int fromCell, int toCell, SearchContext& context) const;
+
+		// The whole path at once: the abstract route with every segment refined. It's close to the shortest path, but not always exactly it.
+		std::vector<Node*> FindPath(Node* startNode, Node* endNode, SearchContext& context) const;
+	};
+}
@@ -0,0 +1,299 @@
+#include "JumpPointSearch.h"
+#include "Heuristics.h"
+#include "SearchTrace.h"
+#include <chrono>
+#include <cstdlib>
+
+namespace AIForGames {
+	namespace {
+		// The four straight directions, in the same order as NodeMap::ForEachNeighbour visits them
+		int DirectionIndex(int dx, int dy) {
+			return dx < 0 ? 0 : dy < 0 ? 1 : dx > 0 ? 2 : 3;
+		};
+
+		int Sign(int value) {
+			return (value > 0) - (value < 0);
+		};
+	}
+
+	JumpPointSearch::JumpPointSearch(const NodeMap& map) : m_map(map) {
+		m_diagonal = map.GetGraph() == GridGraph::Implicit8;
+		m_tableVersion = 0;
+	};
+
+	JumpPointSearch::~JumpPointSearch() {};
+
+	bool JumpPointSearch::IsStraightJumpPoint(int x, int y, int dx, int dy) const {
+		// A wall just behind a cell to the side means that side cell can't be reached any shorter way than through here
+		if (dx != 0) {
+			return (m_map.IsWalkable(x, y - 1) && !m_map.IsWalkable(x - dx, y - 1))
+				|| (m_map.IsWalkable(x, y + 1) && !m_map.IsWalkable(x - dx, y + 1));
+		}
+		return (m_map.IsWalkable(x - 1, y) && !m_map.IsWalkable(x - 1, y - dy))
+			|| (m_map.IsWalkable(x + 1, y) && !m_map.IsWalkable(x + 1, y - dy));
+	};
+
+	int JumpPointSearch::GetJumpDistance(int x, int y, int dx, int dy) const {
+		return m_jumpDistances[(x + m_map.GetWidth() * y) * 4 + DirectionIndex(dx, dy)];
+	};
+
+	int JumpPointSearch::Jump(int x, int y, int dx, int dy, int endX, int endY) const {
+		if (dx != 0 && dy != 0) {
+			return JumpDiagonal(x, y, dx, dy, endX, endY);
+		}
+		if (HasJumpTables()) {
+			return JumpStraightWithTables(x, y, dx, dy, endX, endY);
+		}
+		return JumpStraight(x, y, dx, dy, endX, endY);
+	};
+
+	int JumpPointSearch::JumpStraight(int x, int y, int dx, int dy, int endX, int endY) const {
+		while (true) {
+			x += dx;
+			y += dy;
+
+			if (!m_map.IsWalkable(x, y)) {
+				return -1;
+			}
+			if ((x == endX && y == endY) || IsStraightJumpPoint(x, y, dx, dy)) {
+				return x + m_map.GetWidth() * y;
+			}
+
+			// Without diagonal moves a path can only turn off a vertical line where a horizontal scan would find something, so check both sides as we go
+			if (!m_diagonal && dy != 0 && (JumpStraight(x, y, 1, 0, endX, endY) != -1 || JumpStraight(x, y, -1, 0, endX, endY) != -1)) {
+				return x + m_map.GetWidth() * y;
+			}
+		}
+	};
+
+	int JumpPointSearch::JumpStraightWithTables(int x, int y, int dx, int dy, int endX, int endY) const {
+		int distance = GetJumpDistance(x, y, dx, dy);
+		int reach = std::abs(distance);
+
+		// The tables don't know where the end is, so stop early if the end lies on this line before the wall
+		if (dx != 0 && endY == y && (endX - x) * dx > 0 && (endX - x) * dx <= reach) {
+			return endX + m_map.GetWidth() * endY;
+		}
+		if (dy != 0 && endX == x && (endY - y) * dy > 0 && (endY - y) * dy <= reach) {
+			return endX + m_map.GetWidth() * endY;
+		}
+
+		// Without diagonal moves, a vertical scan also stops on the end's row if a horizontal scan from there would reach the end
+		if (!m_diagonal && dy != 0) {
+			int steps = (endY - y) * dy;
+			if (steps > 0 && steps <= reach && (distance <= 0 || steps < distance)) {
+				int toEnd = std::abs(endX - x);
+				if (toEnd <= std::abs(GetJumpDistance(x, endY, Sign(endX - x), 0))) {
+					return x + m_map.GetWidth() * endY;
+				}
+			}
+		}
+
+		if (distance > 0) {
+			return (x + dx * distance) + m_map.GetWidth() * (y + dy * distance);
+		}
+		return -1;
+	};
+
+	int JumpPointSearch::JumpDiagonal(int x, int y, int dx, int dy, int endX, int endY) const {
+		while (true) {
+			// Same rule as the map's 8-connected graph: both cells beside a diagonal step have to be open
+			if (!m_map.IsWalkable(x + dx, y) || !m_map.IsWalkable(x, y + dy) || !m_map.IsWalkable(x + dx, y + dy)) {
+				return -1;
+			}
+			x += dx;
+			y += dy;
+
+			// A diagonal scan stops wherever one of the two straight scans it passes would find something
+			if ((x == endX && y == endY) || Jump(x, y, dx, 0, endX, endY) != -1 || Jump(x, y, 0, dy, endX, endY) != -1) {
+				return x + m_map.GetWidth() * y;
+			}
+		}
+	};
+
+	void JumpPointSearch::BuildJumpTables() {
+		const int width = m_map.GetWidth();
+		const int height = m_map.GetHeight();
+		m_jumpDistances.assign((size_t)width * height * 4, 0);
+		m_tableVersion = m_map.GetVersion();
+
+		// Each cell's distance follows from the next cell's along the scan, so sweep every line from the far end back.
+		// The horizontal tables go first, because the 4-connected vertical scans stop wherever a horizontal scan would find a jump point.
+		const int directionX[4] = { -1, 1, 0, 0 };
+		const int directionY[4] = { 0, 0, -1, 1 };
+		for (int direction = 0; direction < 4; direction++) {
+			int dx = directionX[direction];
+			int dy = directionY[direction];
+			int index = DirectionIndex(dx, dy);
+
+			for (int i = 0; i < width * height; i++) {
+				// Visit the cells so that (x + dx, y + dy) has always been done before (x, y)
+				int cell = (dx > 0 || dy > 0) ? width * height - 1 - i : i;
+				int x = cell % width;
+				int y = cell / width;
+				int nextX = x + dx;
+				int nextY = y + dy;
+
+				int distance;
+				if (!m_map.IsWalkable(nextX, nextY)) {
+					distance = 0;
+				}
+				else if (IsStraightJumpPoint(nextX, nextY, dx, dy)
+					|| (!m_diagonal && dy != 0 && (GetJumpDistance(nextX, nextY, 1, 0) > 0 || GetJumpDistance(nextX, nextY, -1, 0) > 0))) {
+					distance = 1;
+				}
+				else {
+					int next = GetJumpDistance(nextX, nextY, dx, dy);
+					distance = next > 0 ? next + 1 : next - 1;
+				}
+				m_jumpDistances[(size_t)cell * 4 + index] = distance;
+			}
+		}
+	};
+
+	bool JumpPointSearch::HasJumpTables() const {
+		return !m_jumpDistances.empty() && m_tableVersion == m_map.GetVersion();
+	};
+
+	std::vector<Node*> JumpPointSearch::FindPath(Node* startNode, Node* endNode, SearchContext& context) const {
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		SearchStats stats = SearchStats();
+
+		// Two nodes in different components of the map have no path to jump along
+		if (startNode == nullptr || endNode == nullptr || !m_map.AreConnected(startNode, endNode)) {
+			context.SetStats(stats);
+			return std::vector<Node*>();
+		}
+
+		// A jump prices every cell it passes over the same, so weighted tiles need an ordinary A* search instead
+		if (!m_map.HasUniformCosts()) {
+			return m_diagonal ? m_map.AStarSearch<OctileHeuristic>(startNode, endNode, context) : m_map.AStarSearch<ManhattanHeuristic>(startNode, endNode, context);
+		}
+		AIFG_TRACE_NODE(Begin, startNode->id, 0.0f);
+
+		const int width = m_map.GetWidth();
+		const int startId = startNode->id;
+		const int endId = endNode->id;
+		const int endX = endId % width;
+		const int endY = endId / width;
+		const float diagonalCost = 1.41421356f;
+
+		// The jumps are measured in cells, so the heuristics work in cells here too
+		const glm::vec2 goal((float)endX, (float)endY);
+		auto estimate = [&](int id) -> float {
+			glm::vec2 cell((float)(id % width), (float)(id / width));
+			return m_diagonal ? OctileHeuristic::Estimate(cell, goal) : ManhattanHeuristic::Estimate(cell, goal);
+		};
+
+		context.Begin(m_map.GetNodeCount());
+		context.SetScore(startId, 0.0f, -1);
+		NodeQueue& openList = context.OpenList();
+		context.SetListState(startId, SearchContext::Open);
+		openList.Push(startId, estimate(startId));
+		stats.nodesOpened++;
+		AIFG_TRACE_EDGE(Push, startId, 0.0f);
+
+		while (!openList.Empty()) {
+			int currentNode = openList.Pop();
+			float currentG = context.GetGScore(currentNode);
+			AIFG_TRACE_NODE(Expand, currentNode, currentG);
+
+			if (currentNode == endId) {
+				AIFG_TRACE_NODE(Found, currentNode, currentG);
+				break;
+			}
+
+			context.SetListState(currentNode, SearchContext::Closed);
+			stats.nodesExpanded++;
+			AIFG_TRACE_NODE(Close, currentNode, currentG);
+
+			// Work out which directions are worth scanning from here. The start scans in every direction;
+			// any other jump point only scans onwards and towards the neighbours the wall that made it a jump point uncovered.
+			int x = currentNode % width;
+			int y = currentNode / width;
+			int directions[8][2];
+			int directionCount = 0;
+			auto addDirection = [&](int dx, int dy) {
+				directions[directionCount][0] = dx;
+				directions[directionCount][1] = dy;
+				directionCount++;
+			};
+
+			int previousNode = context.GetPreviousNode(currentNode);
+			if (previousNode == -1) {
+				addDirection(-1, 0);
+				addDirection(0, -1);
+				addDirection(1, 0);
+				addDirection(0, 1);
+				if (m_diagonal) {
+					addDirection(-1, -1);
+					addDirection(1, -1);
+					addDirection(-1, 1);
+					addDirection(1, 1);
+				}
+			}
+			else {
+				int dx = Sign(x - previousNode % width);
+				int dy = Sign(y - previousNode / width);
+
+				if (!m_diagonal) {
+					addDirection(dx, dy);
+					addDirection(dy, dx);
+					addDirection(-dy, -dx);
+				}
+				else if (dx != 0 && dy != 0) {
+					addDirection(dx, 0);
+					addDirection(0, dy);
+					addDirection(dx, dy);
+				}
+				else {
+					addDirection(dx, dy);
+					for (int side = -1; side <= 1; side += 2) {
+						// (sideX, sideY) is perpendicular to the direction of travel
+						int sideX = dy != 0 ? side : 0;
+						int sideY = dx != 0 ? side : 0;
+						if (m_map.IsWalkable(x + sideX, y + sideY) && !m_map.IsWalkable(x + sideX - dx, y + sideY - dy)) {
+							addDirection(sideX, sideY);
+							addDirection(sideX + dx, sideY + dy);
+						}
+					}
+				}
+			}
+
+			for (int i = 0; i < directionCount; i++) {
+				int targetNode = Jump(x, y, directions[i][0], directions[i][1], endX, endY);
+				if (targetNode == -1 || context.GetListState(targetNode) == SearchContext::Closed) {
+					continue;
+				}
+
+				// A jump is either straight or exactly diagonal, so its cost comes straight from how far it went
+				int stepsX = std::abs(targetNode % width - x);
+				int stepsY = std::abs(targetNode / width - y);
+				float cost = (stepsX != 0 && stepsY != 0) ? stepsX * diagonalCost : (float)(stepsX + stepsY);
+				float calcdG = currentG + cost;
+
+				if (context.GetListState(targetNode) == SearchContext::Unvisited) {
+					context.SetScore(targetNode, calcdG, currentNode);
+					context.SetListState(targetNode, SearchContext::Open);
+					openList.Push(targetNode, calcdG + estimate(targetNode));
+					stats.nodesOpened++;
+					AIFG_TRACE_EDGE(Push, targetNode, calcdG);
+				}
+				else if (calcdG < context.GetGScore(targetNode)) {
+					context.SetScore(targetNode, calcdG, currentNode);
+					openList.DecreaseKey(targetNode, calcdG + estimate(targetNode));
+					AIFG_TRACE_EDGE(Relax, targetNode, calcdG);
+				}
+			}
+		}
+
+		std::vector<Node*> path = m_map.ToNodePath(context.BuildPath(endId));
+		if (path.empty()) {
+			AIFG_TRACE_NODE(Exhausted, endId, 0.0f);
+		}
+
+		stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		context.SetStats(stats);
+		return path;
+	};
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "NodeMap.h"
+#include <vector>
+
+namespace AIForGames {
+	// Jump Point Search: A* over a uniform-cost grid that skips the long runs of equivalent paths through open space.
+	// Instead of opening every neighbour, each step scans in a straight (or diagonal) line until it reaches a cell where the path might have to turn,
+	// and only those 'jump points' go on the open list. Paths are just as short as Dijkstra's, with far fewer nodes expanded on open maps.
+	// The map's graph mode picks the rules: GridGraph::Implicit8 jumps diagonally too (never cutting a wall's corner), the other modes jump on the 4-connected grid.
+	// The search only reads the map's walkable bits, so it works the same on an explicit or an implicit map.
+	class JumpPointSearch
+	{
+		// Saves and restores the jump tables along with the map
+		friend class MapSnapshot;
+
+		const NodeMap& m_map;
+		bool m_diagonal;
+
+		// JPS+ (after BuildJumpTables): for every cell and each of the four straight directions, how far a straight scan from that cell goes.
+		// A positive distance is the number of steps to the next jump point; zero or a negative distance is minus the number of walkable steps before a wall.
+		std::vector<int> m_jumpDistances;
+
+		// The map's version when the tables were built. Once the map changes (a tile edit, say) the tables are ignored until they're built again.
+		unsigned int m_tableVersion;
+
+		// True if a straight scan moving (dx, dy) has to stop at (x, y) because a neighbour there can only be reached through it.
+		// With tables built, the 4-connected vertical check also reads the horizontal tables instead of scanning.
+		bool IsStraightJumpPoint(int x, int y, int dx, int dy) const;
+
+		// Scan from (x, y) in a straight or diagonal direction and return the id of the first jump point (or the end cell), or -1 if a wall comes first
+		int Jump(int x, int y, int dx, int dy, int endX, int endY) const;
+		int JumpStraight(int x, int y, int dx, int dy, int endX, int endY) const;
+		int JumpStraightWithTables(int x, int y, int dx, int dy, int endX, int endY) const;
+		int JumpDiagonal(int x, int y, int dx, int dy, int endX, int endY) const;
+
+		int GetJumpDistance(int x, int y, int dx, int dy) const;
+
+	public:
+		// The search keeps a reference to the map, so the map has to outlive it
+		JumpPointSearch(const NodeMap& map);
+		~JumpPointSearch();
+
+		// Precompute the straight scan distances for every cell (JPS+), which turns each straight scan into a single lookup.
+		// Costs 16 bytes per cell. Call it again whenever the map changes; until then the search goes back to scanning.
+		void BuildJumpTables();
+		bool HasJumpTables() const;
+
+		// Find the shortest path from the start node to the end node (empty if there isn't one), using the context for the search's scratch data.
+		// The path only holds the jump points, with straight (or exactly diagonal) lines between them, which PathAgent follows like any other path.
+		// Jumping is only exact while every cell costs the same to step into, so on a map with weighted tiles this falls back to plain A* (and a path of every cell).
+		std::vector<Node*> FindPath(Node* startNode, Node* endNode, SearchContext& context) const;
+	};
+}
@@ -0,0 +1,58 @@
+#include "MapGeometry.h"
+#include "NodeMap.h"
+
+namespace AIForGames {
+	MapGeometry::MapGeometry() {
+		m_map = nullptr;
+		m_version = 0;
+	};
+
+	void MapGeometry::Build(const NodeMap& map) {
+		m_walls.clear();
+		m_labels.clear();
+		m_lines.clear();
+		m_map = &map;
+		m_version = map.GetVersion();
+
+		const int width = map.GetWidth();
+		const int height = map.GetHeight();
+		const int cellSize = (int)map.GetCellSize();
+
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				if (!map.IsWalkable(x, y)) {
+					// A solid block for the wall, 1 pixel smaller than the cell to separate it from its neighbours, labelled with its map coordinates
+					m_walls.push_back({ x * cellSize, y * cellSize, cellSize - 1, cellSize - 1 });
+					m_labels.push_back({ "(" + std::to_string(y) + ", " + std::to_string(x) + ")", x * cellSize + 2, y * cellSize + 2 });
+					continue;
+				}
+
+				// A line from the centre of this cell to the centre of each cell it connects to, counting each pair of cells once
+				int id = x + width * y;
+				glm::vec2 position = map.GetPosition(id);
+				map.ForEachNeighbour(id, [&](int other, float) {
+					if (other > id) {
+						glm::vec2 otherPosition = map.GetPosition(other);
+						m_lines.push_back({ (int)position.x, (int)position.y, (int)otherPosition.x, (int)otherPosition.y });
+					}
+				});
+			}
+		}
+	};
+
+	bool MapGeometry::IsUpToDate(const NodeMap& map) const {
+		return m_map == &map && m_version == map.GetVersion();
+	};
+
+	const std::vector<MapRectangle>& MapGeometry::GetWalls() const {
+		return m_walls;
+	};
+
+	const std::vector<MapLabel>& MapGeometry::GetLabels() const {
+		return m_labels;
+	};
+
+	const std::vector<MapLine>& MapGeometry::GetLines() const {
+		return m_lines;
+	};
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace AIForGames {
+	class NodeMap;
+
+	// A wall block, in screen pixels
+	struct MapRectangle {
+		int x;
+		int y;
+		int width;
+		int height;
+	};
+
+	// An edge between two cell centres, in screen pixels
+	struct MapLine {
+		int startX;
+		int startY;
+		int endX;
+		int endY;
+	};
+
+	// A wall's "(row, column)" label and where its top left corner goes
+	struct MapLabel {
+		std::string text;
+		int x;
+		int y;
+	};
+
+	// Everything NodeMap::Draw puts on the screen that only changes when the map does: the wall blocks, their labels and the edges.
+	// It is worked out once and kept until the map is edited or initialised again, instead of looping over every cell and building
+	// every label's strings again each frame. Building it needs no window, so the geometry can be checked without raylib.
+	class MapGeometry
+	{
+		std::vector<MapRectangle> m_walls;
+		std::vector<MapLabel> m_labels;
+		std::vector<MapLine> m_lines;
+
+		// The map and map version the geometry was built from
+		const NodeMap* m_map;
+		unsigned int m_version;
+
+	public:
+		MapGeometry();
+
+		// Work out the geometry of the map as it is now
+		void Build(const NodeMap& map);
+
+		// True if the geometry was built from this map and the map hasn't changed since
+		bool IsUpToDate(const NodeMap& map) const;
+
+		// One block and one label per wall cell, in row order
+		const std::vector<MapRectangle>& GetWalls() const;
+		const std::vector<MapLabel>& GetLabels() const;
+
+		// One line per pair of connected cells. Every edge has a twin going the other way, and only one of the two is drawn.
+		const std::vector<MapLine>& GetLines() const;
+	};
+}
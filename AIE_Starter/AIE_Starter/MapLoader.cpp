@@ -0,0 +1,201 @@
+#include "MapLoader.h"
+#include "MapSnapshot.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <sstream>
+
+namespace AIForGames {
+	namespace {
+		// How many malformed row numbers are kept for GetMalformedRows (the rest are only counted)
+		const size_t maxReportedRows = 16;
+
+		// Find the end of the line starting at data. lineEnd is set to the end of its text (before any "\r\n"), and the start of the next line is returned.
+		const char* NextLine(const char* data, const char* end, const char*& lineEnd) {
+			const char* newline = (const char*)memchr(data, '\n', end - data);
+			lineEnd = newline != nullptr ? newline : end;
+			if (lineEnd > data && lineEnd[-1] == '\r') {
+				lineEnd--;
+			}
+			return newline != nullptr ? newline + 1 : end;
+		};
+
+		bool SizeFits(long long width, long long height) {
+			return width > 0 && height > 0 && width * height <= INT_MAX;
+		};
+	}
+
+	MapLoader::MapLoader() {
+		m_malformedRowCount = 0;
+		m_milliseconds = 0.0;
+	};
+
+	void MapLoader::ReportMalformedRow(int y) {
+		m_malformedRowCount++;
+		if (m_malformedRows.size() < maxReportedRows) {
+			m_malformedRows.push_back(y);
+		}
+	};
+
+	bool MapLoader::Load(const std::string& fileName, NodeMap& map, int cellSize, GridGraph graph) {
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		m_error.clear();
+		m_malformedRowCount = 0;
+		m_malformedRows.clear();
+
+		MappedFile file;
+		if (!file.Open(fileName)) {
+			m_error = "Could not open " + fileName;
+			return false;
+		}
+
+		// Moving AI maps always start with their "type" line, and snapshots with their magic
+		const char* data = file.GetData();
+		const char* end = data + file.GetSize();
+		bool loaded = false;
+		if (file.GetSize() >= 8 && memcmp(data, "AIFGSNAP", 8) == 0) {
+			file.Close();
+			loaded = MapSnapshot::Load(fileName.c_str(), map, nullptr, &m_error);
+		}
+		else if (file.GetSize() >= 5 && memcmp(data, "type ", 5) == 0) {
+			loaded = LoadMovingAi(data, end, map, cellSize, graph);
+		}
+		else {
+			loaded = LoadAscii(data, end, map, cellSize, graph);
+		}
+
+		m_milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		return loaded;
+	};
+
+	bool MapLoader::LoadAscii(const char* data, const char* end, NodeMap& map, int cellSize, GridGraph graph) {
+		// Only a count of the rows is needed up front, which is a quick scan for line breaks. Blank lines aren't rows.
+		// As with Initialise, the width is the length of the first row.
+		long long width = -1;
+		long long height = 0;
+		for (const char* line = data; line < end; ) {
+			const char* lineEnd;
+			const char* next = NextLine(line, end, lineEnd);
+			if (lineEnd > line) {
+				if (width < 0) {
+					width = lineEnd - line;
+				}
+				height++;
+			}
+			line = next;
+		}
+
+		if (!SizeFits(width, height)) {
+			m_error = height == 0 ? "The file has no rows in it" : "The map is too big";
+			return false;
+		}
+
+		// '0' is a wall, anything else is walkable
+		bool walkableCodes[256];
+		std::fill(walkableCodes, walkableCodes + 256, true);
+		walkableCodes[(unsigned char)'0'] = false;
+
+		map.BeginRows((int)width, (int)height, cellSize, graph);
+		int y = 0;
+		for (const char* line = data; line < end; ) {
+			const char* lineEnd;
+			const char* next = NextLine(line, end, lineEnd);
+			if (lineEnd > line) {
+				if (lineEnd - line != width) {
+					ReportMalformedRow(y);
+				}
+				map.AddRow(y, line, (int)(lineEnd - line), walkableCodes);
+				y++;
+			}
+			line = next;
+		}
+		map.EndRows();
+		return true;
+	};
+
+	bool MapLoader::LoadMovingAi(const char* data, const char* end, NodeMap& map, int cellSize, GridGraph graph) {
+		// The header is a few "key value" lines, ending with a line that just says "map"
+		long long width = -1;
+		long long height = -1;
+		const char* line = data;
+		bool foundMap = false;
+		while (line < end && !foundMap) {
+			const char* lineEnd;
+			const char* next = NextLine(line, end, lineEnd);
+			std::istringstream header(std::string(line, lineEnd));
+			std::string key;
+			header >> key;
+			if (key == "width") {
+				header >> width;
+			}
+			else if (key == "height") {
+				header >> height;
+			}
+			foundMap = key == "map";
+			line = next;
+		}
+
+		if (!foundMap) {
+			m_error = "The Moving AI header has no \"map\" line";
+			return false;
+		}
+		if (!SizeFits(width, height)) {
+			m_error = "The Moving AI header has a missing or impossible width or height";
+			return false;
+		}
+
+		// Ground and swamp are walkable. Out of bounds, trees and water are walls (water is only walkable from other water, which a grid of bits can't say).
+		bool walkableCodes[256] = {};
+		bool knownCodes[256] = {};
+		for (unsigned char code : { '.', 'G', 'S' }) {
+			walkableCodes[code] = true;
+			knownCodes[code] = true;
+		}
+		for (unsigned char code : { '@', 'O', 'T', 'W' }) {
+			knownCodes[code] = true;
+		}
+
+		map.BeginRows((int)width, (int)height, cellSize, graph);
+		int y = 0;
+		while (line < end && y < height) {
+			const char* lineEnd;
+			const char* next = NextLine(line, end, lineEnd);
+			bool malformed = lineEnd - line != width;
+			for (const char* cell = line; cell < lineEnd && !malformed; cell++) {
+				malformed = !knownCodes[(unsigned char)*cell];
+			}
+			if (malformed) {
+				ReportMalformedRow(y);
+			}
+
+			map.AddRow(y, line, (int)(lineEnd - line), walkableCodes);
+			y++;
+			line = next;
+		}
+
+		// Rows the file stops short of are left as walls
+		for (; y < height; y++) {
+			ReportMalformedRow(y);
+		}
+		map.EndRows();
+		return true;
+	};
+
+	const std::string& MapLoader::GetError() const {
+		return m_error;
+	};
+
+	int MapLoader::GetMalformedRowCount() const {
+		return m_malformedRowCount;
+	};
+
+	const std::vector<int>& MapLoader::GetMalformedRows() const {
+		return m_malformedRows;
+	};
+
+	double MapLoader::GetMilliseconds() const {
+		return m_milliseconds;
+	};
+}
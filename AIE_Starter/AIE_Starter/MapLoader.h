@@ -0,0 +1,42 @@
+#pragma once
+#include "NodeMap.h"
+#include <string>
+#include <vector>
+
+namespace AIForGames {
+	// Loads a map file into a NodeMap, reading it straight out of a memory-mapped copy of the file one row at a time, so no string is ever made of a row.
+	// Two formats are understood:
+	//   - the ascii format main uses: one row per line, '0' for a wall and anything else walkable
+	//   - the Moving AI .map format: a "type", "height", "width" and "map" header, then rows of '.', 'G' and 'S' (walkable) and '@', 'O', 'T' and 'W' (walls)
+	// A MapSnapshot file is recognised too, and loaded with the cell size and graph mode it was saved with.
+	// Rows of the wrong length, unknown characters and missing rows don't stop the load. The cells affected become walls,
+	// and the rows are counted (and the first few remembered) instead of printing anything for them.
+	class MapLoader
+	{
+		std::string m_error;
+		int m_malformedRowCount;
+		std::vector<int> m_malformedRows;
+		double m_milliseconds;
+
+		void ReportMalformedRow(int y);
+
+		bool LoadAscii(const char* data, const char* end, NodeMap& map, int cellSize, GridGraph graph);
+		bool LoadMovingAi(const char* data, const char* end, NodeMap& map, int cellSize, GridGraph graph);
+
+	public:
+		MapLoader();
+
+		// Returns false (with GetError saying why) if the file can't be read or has no map in it, in which case the map is left as it was.
+		// Maps too big to give every cell a Node should use one of the implicit graphs.
+		bool Load(const std::string& fileName, NodeMap& map, int cellSize, GridGraph graph = GridGraph::Explicit);
+
+		const std::string& GetError() const;
+
+		// How many rows were malformed in the last load, and which they were (only the first few are kept)
+		int GetMalformedRowCount() const;
+		const std::vector<int>& GetMalformedRows() const;
+
+		// How long the last load took, from opening the file to the finished graph
+		double GetMilliseconds() const;
+	};
+}
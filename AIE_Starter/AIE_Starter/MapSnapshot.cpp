@@ -0,0 +1,262 @@
+#include "MapSnapshot.h"
+#include "JumpPointSearch.h"
+#include "MappedFile.h"
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace AIForGames {
+	namespace {
+		// Written at the start of every snapshot file. The version goes up whenever the layout of the file or of any section changes.
+		const char snapshotMagic[8] = { 'A', 'I', 'F', 'G', 'S', 'N', 'A', 'P' };
+		const uint32_t snapshotVersion = 1;
+
+		enum SectionType : uint32_t {
+			WalkableBits = 1,
+			EdgeOffsets,
+			EdgeCounts,
+			EdgeTargets,
+			EdgeCosts,
+			Positions,
+			TileCosts,
+			JumpDistances
+		};
+
+		struct SnapshotHeader {
+			char magic[8];
+			uint32_t version;
+			uint32_t sectionCount;
+			// Of every byte after the header: the section table, the sections and their padding
+			uint64_t checksum;
+			int32_t width;
+			int32_t height;
+			float cellSize;
+			uint32_t graph;
+			int32_t weightedCells;
+			uint32_t padding;
+		};
+
+		struct SnapshotSection {
+			uint32_t type;
+			uint32_t elementSize;
+			// Where the section's array starts, counted from the start of the file (always a multiple of 8)
+			uint64_t offset;
+			uint64_t count;
+		};
+
+		// One array to be saved as a section
+		struct SectionSource {
+			uint32_t type;
+			uint32_t elementSize;
+			const void* data;
+			uint64_t count;
+		};
+
+		static_assert(sizeof(SnapshotHeader) == 48 && sizeof(SnapshotSection) == 24, "The snapshot structures must have no hidden padding");
+		static_assert(sizeof(glm::vec2) == 8, "Positions are saved as two packed floats");
+
+		size_t AlignUp(size_t size) {
+			return (size + 7) & ~(size_t)7;
+		};
+
+		// FNV-1a taken a 64-bit word at a time rather than a byte at a time, so checking a large snapshot costs a fraction of reading it
+		uint64_t Checksum(const char* data, size_t size) {
+			uint64_t hash = 14695981039346656037ull;
+			size_t wordCount = size / 8;
+			for (size_t i = 0; i < wordCount; i++) {
+				uint64_t word;
+				memcpy(&word, data + 8 * i, 8);
+				hash = (hash ^ word) * 1099511628211ull;
+			}
+			for (size_t i = wordCount * 8; i < size; i++) {
+				hash = (hash ^ (unsigned char)data[i]) * 1099511628211ull;
+			}
+			return hash;
+		};
+
+		template <typename T>
+		void AddSection(std::vector<SectionSource>& sources, SectionType type, const std::vector<T>& data) {
+			if (!data.empty()) {
+				sources.push_back({ type, (uint32_t)sizeof(T), data.data(), data.size() });
+			}
+		};
+
+		// Point at a section's array inside the mapping. Returns nullptr if the section is missing, or isn't the type or number of elements expected.
+		template <typename T>
+		const T* FindSection(const SnapshotSection* sections, uint32_t sectionCount, SectionType type, uint64_t expectedCount, const char* base) {
+			for (uint32_t i = 0; i < sectionCount; i++) {
+				if (sections[i].type == type) {
+					return sections[i].elementSize == sizeof(T) && sections[i].count == expectedCount ? (const T*)(base + sections[i].offset) : nullptr;
+				}
+			}
+			return nullptr;
+		};
+
+		bool HasSection(const SnapshotSection* sections, uint32_t sectionCount, SectionType type) {
+			for (uint32_t i = 0; i < sectionCount; i++) {
+				if (sections[i].type == type) {
+					return true;
+				}
+			}
+			return false;
+		};
+
+		bool Fail(std::string* error, const std::string& message) {
+			if (error != nullptr) {
+				*error = message;
+			}
+			return false;
+		};
+	}
+
+	bool MapSnapshot::Save(const char* fileName, const NodeMap& map, const JumpPointSearch* jumpPointSearch) {
+		std::vector<SectionSource> sources;
+		AddSection(sources, WalkableBits, map.m_walkable);
+		AddSection(sources, EdgeOffsets, map.m_edgeOffsets);
+		AddSection(sources, EdgeCounts, map.m_edgeCounts);
+		AddSection(sources, EdgeTargets, map.m_edgeTargets);
+		AddSection(sources, EdgeCosts, map.m_edgeCosts);
+		AddSection(sources, Positions, map.m_positions);
+		AddSection(sources, TileCosts, map.m_tileCosts);
+		if (jumpPointSearch != nullptr && jumpPointSearch->HasJumpTables()) {
+			AddSection(sources, JumpDistances, jumpPointSearch->m_jumpDistances);
+		}
+
+		// Lay the sections out one after another after the table, each starting on an 8-byte boundary
+		std::vector<SnapshotSection> sections;
+		size_t fileSize = sizeof(SnapshotHeader) + sources.size() * sizeof(SnapshotSection);
+		for (const SectionSource& source : sources) {
+			sections.push_back({ source.type, source.elementSize, fileSize, source.count });
+			fileSize = AlignUp(fileSize + (size_t)source.count * source.elementSize);
+		}
+
+		// The whole file is put together in memory first, so the checksum can go in the header
+		std::vector<char> buffer(fileSize, 0);
+		SnapshotHeader header = SnapshotHeader();
+		memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+		header.version = snapshotVersion;
+		header.sectionCount = (uint32_t)sections.size();
+		header.width = map.m_width;
+		header.height = map.m_height;
+		header.cellSize = map.m_cellSize;
+		header.graph = (uint32_t)map.m_graph;
+		header.weightedCells = map.m_weightedCells;
+
+		if (!sections.empty()) {
+			memcpy(&buffer[sizeof(SnapshotHeader)], sections.data(), sections.size() * sizeof(SnapshotSection));
+		}
+		for (size_t i = 0; i < sources.size(); i++) {
+			memcpy(&buffer[(size_t)sections[i].offset], sources[i].data, (size_t)sources[i].count * sources[i].elementSize);
+		}
+		header.checksum = Checksum(buffer.data() + sizeof(SnapshotHeader), fileSize - sizeof(SnapshotHeader));
+		memcpy(buffer.data(), &header, sizeof(header));
+
+		std::ofstream file(fileName, std::ios::binary);
+		if (!file) {
+			return false;
+		}
+		file.write(buffer.data(), buffer.size());
+		return (bool)file;
+	};
+
+	bool MapSnapshot::Load(const char* fileName, NodeMap& map, JumpPointSearch* jumpPointSearch, std::string* error) {
+		MappedFile file;
+		if (!file.Open(fileName)) {
+			return Fail(error, std::string("Could not open ") + fileName);
+		}
+
+		// 1: Check the header, the section table and the checksum before touching the map
+		const char* base = file.GetData();
+		const size_t fileSize = file.GetSize();
+		SnapshotHeader header;
+		if (fileSize < sizeof(SnapshotHeader)) {
+			return Fail(error, "The file is too small to be a snapshot");
+		}
+		memcpy(&header, base, sizeof(header));
+		if (memcmp(header.magic, snapshotMagic, sizeof(snapshotMagic)) != 0) {
+			return Fail(error, "The file isn't a map snapshot");
+		}
+		if (header.version != snapshotVersion) {
+			return Fail(error, "The snapshot is format version " + std::to_string(header.version) + ", but this build reads version " + std::to_string(snapshotVersion));
+		}
+		if (header.sectionCount > 64 || fileSize < sizeof(SnapshotHeader) + header.sectionCount * sizeof(SnapshotSection)) {
+			return Fail(error, "The snapshot's section table is cut off");
+		}
+		if (Checksum(base + sizeof(SnapshotHeader), fileSize - sizeof(SnapshotHeader)) != header.checksum) {
+			return Fail(error, "The snapshot fails its checksum");
+		}
+
+		const SnapshotSection* sections = (const SnapshotSection*)(base + sizeof(SnapshotHeader));
+		for (uint32_t i = 0; i < header.sectionCount; i++) {
+			if (sections[i].offset % 8 != 0 || sections[i].offset > fileSize || sections[i].count > (fileSize - sections[i].offset) / (sections[i].elementSize > 0 ? sections[i].elementSize : 1)) {
+				return Fail(error, "A section runs past the end of the snapshot");
+			}
+		}
+
+		// 2: Find every array the map needs, checking each is exactly the size the map's dimensions say it should be
+		const long long width = header.width;
+		const long long height = header.height;
+		if (width <= 0 || height <= 0 || width * height > INT_MAX || header.graph > (uint32_t)GridGraph::Implicit8) {
+			return Fail(error, "The snapshot's map has an impossible size or graph mode");
+		}
+		const uint64_t nodeCount = (uint64_t)(width * height);
+		const GridGraph graph = (GridGraph)header.graph;
+
+		const unsigned long long* walkable = FindSection<unsigned long long>(sections, header.sectionCount, WalkableBits, (nodeCount + 63) / 64, base);
+		const unsigned int* edgeOffsets = nullptr;
+		const unsigned char* edgeCounts = nullptr;
+		const unsigned int* edgeTargets = nullptr;
+		const float* edgeCosts = nullptr;
+		const glm::vec2* positions = nullptr;
+		bool missing = walkable == nullptr;
+		if (graph == GridGraph::Explicit && !missing) {
+			edgeOffsets = FindSection<unsigned int>(sections, header.sectionCount, EdgeOffsets, nodeCount + 1, base);
+			edgeCounts = FindSection<unsigned char>(sections, header.sectionCount, EdgeCounts, nodeCount, base);
+			positions = FindSection<glm::vec2>(sections, header.sectionCount, Positions, nodeCount, base);
+			if (edgeOffsets != nullptr) {
+				edgeTargets = FindSection<unsigned int>(sections, header.sectionCount, EdgeTargets, edgeOffsets[nodeCount], base);
+				edgeCosts = FindSection<float>(sections, header.sectionCount, EdgeCosts, edgeOffsets[nodeCount], base);
+			}
+			missing = edgeOffsets == nullptr || edgeCounts == nullptr || positions == nullptr || edgeTargets == nullptr || edgeCosts == nullptr;
+		}
+		const float* tileCosts = FindSection<float>(sections, header.sectionCount, TileCosts, nodeCount, base);
+		const int* jumpDistances = FindSection<int>(sections, header.sectionCount, JumpDistances, nodeCount * 4, base);
+		if (missing || (tileCosts == nullptr && HasSection(sections, header.sectionCount, TileCosts)) || (jumpDistances == nullptr && HasSection(sections, header.sectionCount, JumpDistances))) {
+			return Fail(error, "The snapshot is missing part of the map, or has a part the wrong size");
+		}
+
+		// 3: Everything checks out, so replace the map. Each array is a single copy out of the mapping.
+		map.Clear();
+		map.m_width = (int)width;
+		map.m_height = (int)height;
+		map.m_cellSize = header.cellSize;
+		map.m_graph = graph;
+		map.m_version++;
+		map.m_weightedCells = header.weightedCells;
+		map.m_walkable.assign(walkable, walkable + (nodeCount + 63) / 64);
+		if (tileCosts != nullptr) {
+			map.m_tileCosts.assign(tileCosts, tileCosts + nodeCount);
+		}
+
+		if (graph == GridGraph::Explicit) {
+			map.m_edgeOffsets.assign(edgeOffsets, edgeOffsets + nodeCount + 1);
+			map.m_edgeCounts.assign(edgeCounts, edgeCounts + nodeCount);
+			map.m_edgeTargets.assign(edgeTargets, edgeTargets + edgeOffsets[nodeCount]);
+			map.m_edgeCosts.assign(edgeCosts, edgeCosts + edgeOffsets[nodeCount]);
+			map.m_positions.assign(positions, positions + nodeCount);
+
+			// The Nodes themselves hold addresses, so they're made fresh for every walkable cell instead of being saved
+			map.m_nodes = new Node * [nodeCount]();
+			map.CreateNodes();
+			map.BuildNearestWalkable();
+			map.BuildComponents();
+		}
+
+		if (jumpPointSearch != nullptr && jumpDistances != nullptr) {
+			jumpPointSearch->m_jumpDistances.assign(jumpDistances, jumpDistances + nodeCount * 4);
+			jumpPointSearch->m_tableVersion = map.GetVersion();
+		}
+		return true;
+	};
+}
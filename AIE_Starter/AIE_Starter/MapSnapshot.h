@@ -0,0 +1,25 @@
+#pragma once
+#include "NodeMap.h"
+#include <string>
+
+namespace AIForGames {
+	class JumpPointSearch;
+
+	// A binary snapshot of a fully built NodeMap: its walkable bits, the compressed sparse row edges, the cell centres, any tile costs,
+	// and optionally a JumpPointSearch's precomputed tables, so none of it has to be worked out again when the program starts.
+	//
+	// The file is a fixed header (magic, format version, checksum and the map's size), a table of sections, then each section's raw array,
+	// 8-byte aligned. Loading maps the file, checks the checksum, turns each section's offset into a pointer into the mapping, and copies
+	// the array straight into the map with no parsing at all. Only an explicit map's Nodes are made afresh, all in one block, from the saved centres.
+	// Snapshots are written in the machine's own byte order, so they're meant to be loaded on the same kind of machine that saved them.
+	class MapSnapshot
+	{
+	public:
+		// Write the map (and the search's jump tables, if it has up to date ones) to the file. Returns false if the file can't be written.
+		static bool Save(const char* fileName, const NodeMap& map, const JumpPointSearch* jumpPointSearch = nullptr);
+
+		// Replace the map with the one in the file, and give the search the saved jump tables if there are any.
+		// Returns false (leaving the map as it was, and with the error saying why) if the file is missing, from another format version, or fails its checksum.
+		static bool Load(const char* fileName, NodeMap& map, JumpPointSearch* jumpPointSearch = nullptr, std::string* error = nullptr);
+	};
+}
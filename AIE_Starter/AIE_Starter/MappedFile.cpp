@@ -0,0 +1,141 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace AIForGames {
+	MappedFile::MappedFile() {
+		m_data = nullptr;
+		m_size = 0;
+#ifdef _WIN32
+		m_file = INVALID_HANDLE_VALUE;
+		m_mapping = nullptr;
+#else
+		m_descriptor = -1;
+#endif
+	};
+
+	MappedFile::~MappedFile() {
+		Close();
+	};
+
+#ifdef _WIN32
+	bool MappedFile::Open(const std::string& fileName) {
+		Close();
+
+		m_file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (m_file == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(m_file, &size)) {
+			Close();
+			return false;
+		}
+		m_size = (size_t)size.QuadPart;
+
+		// A file with nothing in it can't be mapped, but there's nothing to read either
+		if (m_size == 0) {
+			return true;
+		}
+
+		m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mapping == nullptr) {
+			Close();
+			return false;
+		}
+
+		m_data = (const char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+		if (m_data == nullptr) {
+			Close();
+			return false;
+		}
+		return true;
+	};
+
+	void MappedFile::Close() {
+		if (m_data != nullptr) {
+			UnmapViewOfFile(m_data);
+		}
+		if (m_mapping != nullptr) {
+			CloseHandle(m_mapping);
+		}
+		if (m_file != INVALID_HANDLE_VALUE) {
+			CloseHandle(m_file);
+		}
+		m_data = nullptr;
+		m_size = 0;
+		m_mapping = nullptr;
+		m_file = INVALID_HANDLE_VALUE;
+	};
+
+	bool MappedFile::IsOpen() const {
+		return m_file != INVALID_HANDLE_VALUE;
+	};
+#else
+	bool MappedFile::Open(const std::string& fileName) {
+		Close();
+
+		m_descriptor = open(fileName.c_str(), O_RDONLY);
+		if (m_descriptor < 0) {
+			return false;
+		}
+
+		struct stat status;
+		if (fstat(m_descriptor, &status) != 0) {
+			Close();
+			return false;
+		}
+		m_size = (size_t)status.st_size;
+
+		// A file with nothing in it can't be mapped, but there's nothing to read either
+		if (m_size == 0) {
+			return true;
+		}
+
+		void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_descriptor, 0);
+		if (data == MAP_FAILED) {
+			Close();
+			return false;
+		}
+		m_data = (const char*)data;
+
+		// The file is read front to back, so ask for the pages ahead to be read in early
+		madvise(data, m_size, MADV_SEQUENTIAL);
+		return true;
+	};
+
+	void MappedFile::Close() {
+		if (m_data != nullptr) {
+			munmap((void*)m_data, m_size);
+		}
+		if (m_descriptor >= 0) {
+			close(m_descriptor);
+		}
+		m_data = nullptr;
+		m_size = 0;
+		m_descriptor = -1;
+	};
+
+	bool MappedFile::IsOpen() const {
+		return m_descriptor >= 0;
+	};
+#endif
+
+	const char* MappedFile::GetData() const {
+		return m_data;
+	};
+
+	size_t MappedFile::GetSize() const {
+		return m_size;
+	};
+}
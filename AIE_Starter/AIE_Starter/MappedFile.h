@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace AIForGames {
+	// A file mapped into memory read-only, so it can be read straight out of the page cache without copying it into a buffer first.
+	// Uses CreateFileMapping / MapViewOfFile on Windows and mmap everywhere else. The file is unmapped when the object is destroyed.
+	class MappedFile
+	{
+		const char* m_data;
+		size_t m_size;
+
+#ifdef _WIN32
+		void* m_file;
+		void* m_mapping;
+#else
+		int m_descriptor;
+#endif
+
+	public:
+		MappedFile();
+		~MappedFile();
+
+		// The mapping belongs to one object only
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// Map the whole file. Returns false if it can't be opened or mapped. An empty file opens with no data.
+		bool Open(const std::string& fileName);
+		void Close();
+
+		bool IsOpen() const;
+		const char* GetData() const;
+		size_t GetSize() const;
+	};
+}
@@ -0,0 +1,62 @@
+#include "NodeArena.h"
+#include <algorithm>
+
+namespace AIForGames {
+	NodeArena::NodeArena(int blockSize) {
+		m_blockCapacity = 0;
+		m_blockUsed = 0;
+		m_blockSize = blockSize > 0 ? blockSize : 1;
+		m_nodeCount = 0;
+		m_capacity = 0;
+	};
+
+	NodeArena::~NodeArena() {
+		Clear();
+	};
+
+	void NodeArena::AddBlock(int capacity) {
+		// Whatever was left in the old block is simply never used, so the Nodes already handed out stay where they are
+		m_blocks.emplace_back(new Node[capacity]);
+		m_blockCapacity = capacity;
+		m_blockUsed = 0;
+		m_capacity += capacity;
+	};
+
+	void NodeArena::Reserve(int count) {
+		if (count > m_blockCapacity - m_blockUsed) {
+			AddBlock(std::max(count, m_blockSize));
+		}
+	};
+
+	Node* NodeArena::Create(float x, float y, int id) {
+		if (m_blockUsed == m_blockCapacity) {
+			AddBlock(m_blockSize);
+		}
+		Node* node = &m_blocks.back()[m_blockUsed++];
+		node->position.x = x;
+		node->position.y = y;
+		node->id = id;
+		m_nodeCount++;
+		return node;
+	};
+
+	void NodeArena::Clear() {
+		m_blocks.clear();
+		m_blockCapacity = 0;
+		m_blockUsed = 0;
+		m_nodeCount = 0;
+		m_capacity = 0;
+	};
+
+	int NodeArena::GetNodeCount() const {
+		return m_nodeCount;
+	};
+
+	int NodeArena::GetBlockCount() const {
+		return (int)m_blocks.size();
+	};
+
+	size_t NodeArena::GetMemoryUsage() const {
+		return m_capacity * sizeof(Node) + m_blocks.capacity() * sizeof(std::unique_ptr<Node[]>);
+	};
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "Pathfinding.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace AIForGames {
+	// Hands out Nodes from a few big blocks instead of allocating each one on its own, so a map's Nodes sit next to each other in memory,
+	// and building or clearing a map costs a handful of allocations however many Nodes it has.
+	// A Node never moves once it has been made, and they're only ever freed all together, by Clear.
+	class NodeArena
+	{
+		std::vector<std::unique_ptr<Node[]>> m_blocks;
+
+		// The size of the newest block, and how much of it has been handed out
+		int m_blockCapacity;
+		int m_blockUsed;
+
+		// The size of the blocks made when a Node doesn't fit in the newest one
+		int m_blockSize;
+
+		int m_nodeCount;
+		size_t m_capacity;
+
+		// Start a new block with room for at least the given number of Nodes
+		void AddBlock(int capacity);
+
+	public:
+		NodeArena(int blockSize = 1024);
+		~NodeArena();
+
+		NodeArena(const NodeArena&) = delete;
+		NodeArena& operator=(const NodeArena&) = delete;
+
+		// Make sure the next count Nodes made all fit in the newest block, so a map that knows how many Nodes it needs gets them in one allocation
+		void Reserve(int count);
+
+		// A new Node at the given position, with the given node id
+		Node* Create(float x, float y, int id);
+
+		// Free every Node at once
+		void Clear();
+
+		int GetNodeCount() const;
+		int GetBlockCount() const;
+
+		// The bytes held by the blocks, including any room not handed out yet
+		size_t GetMemoryUsage() const;
+	};
+}
@@ -1,20 +1,89 @@
 #include "NodeMap.h"
+#include "SearchContext.h"
+#ifndef AIFG_HEADLESS
+#include "MapGeometry.h"
 #include "raylib.h"
+#endif
+#include <chrono>
+#include <cmath>
 #include <iostream>
 #include <vector>
 #include <algorithm>
 #include <string>
+// Last, so only this file's own allocations are tagged with their call sites
+#include "memory.h"
 
 using namespace std;
 
 namespace AIForGames {
+	namespace {
+		// How many tile edits the map remembers for GetEditsSince. Anything further behind than this rebuilds from scratch instead.
+		const size_t maxEditLogLength = 4096;
+
+		// The four neighbours of a cell on the 4-connected grid, in the order the explicit graph stores its edges
+		const int neighbourX[4] = { -1, 0, 1, 0 };
+		const int neighbourY[4] = { 0, -1, 0, 1 };
+
+#ifndef AIFG_HEADLESS
+		// Maps bigger than this many pixels across are drawn straight from their geometry every frame, as a texture that size may not be supported
+		const int maxTextureSize = 4096;
+
+		void DrawMapGeometry(const MapGeometry& geometry) {
+			// A Raylib color object for the ascii maze node objects (red)
+			Color cellColour;
+			cellColour.a = 255;
+			cellColour.r = 255;
+			cellColour.g = 0;
+			cellColour.b = 0;
+
+			// A Raylib color object for the ascii maze edge objects (grey)
+			Color lineColour;
+			lineColour.a = 64;
+			lineColour.r = 128;
+			lineColour.g = 128;
+			lineColour.b = 128;
+
+			for (const MapRectangle& wall : geometry.GetWalls()) {
+				DrawRectangle(wall.x, wall.y, wall.width, wall.height, cellColour);
+			}
+			for (const MapLabel& label : geometry.GetLabels()) {
+				DrawText(label.text.c_str(), label.x, label.y, 2, WHITE);
+			}
+			for (const MapLine& line : geometry.GetLines()) {
+				DrawLine(line.startX, line.startY, line.endX, line.endY, lineColour);
+			}
+		};
+#endif
+	}
+
+#ifndef AIFG_HEADLESS
+	struct NodeMap::DrawCache {
+		MapGeometry geometry;
+
+		// The map drawn from the geometry, if it fits in a texture
+		RenderTexture2D texture;
+		bool hasTexture = false;
+
+		// The path length DrawPath last wrote its label for, and the label
+		int labelledPathLength = -1;
+		string pathLabel;
+
+		~DrawCache() {
+			// main closes the window before deleting the map, and the texture went with the window's graphics context
+			if (hasTexture && IsWindowReady()) {
+				UnloadRenderTexture(texture);
+			}
+		};
+	};
+#endif
+
 	// This is a global namespace function for the AIForGames namespace which will print the node path from back to front for a completed Dijkstra search.
-	void NodeMap::Print(vector<Node*> path) {
+	void NodeMap::Print(vector<Node*> path, const SearchContext& context) {
 		int counter = path.size();
 
 		while (counter != 0) {
 			for (Node* n : path) {
-				cout << "Node [" << counter << "]: g score [" << n->gScore << "]." << endl;
+				cout << "Node [" << counter << "]: g score [" << context.GetGScore(n->id) << "]." << endl;
 				counter--;
 				//cout << "Node [" << counter << "] has [" << n->connections.size() << "] connections." << endl;
 			};
@@ -23,40 +92,188 @@ namespace AIForGames {
 
 
 	// Default constructor
-	NodeMap::NodeMap() {};
+	NodeMap::NodeMap() {
+		m_width = 0;
+		m_height = 0;
+		m_cellSize = 0.0f;
+		m_graph = GridGraph::Explicit;
+		m_version = 0;
+		m_nodes = nullptr;
+		m_weightedCells = 0;
+	};
 
 	// Destructor
 	NodeMap::~NodeMap() {
-		for (int i = 0; i < (m_width * m_height); i++) {
-			delete m_nodes[i];
-			m_nodes[i] = nullptr;
-		}
+		Clear();
+	};
 
+	void NodeMap::Clear() {
+		// The Nodes all live in the arena, so there's no need to delete them one by one
 		delete[] m_nodes;
 		m_nodes = nullptr;
+		m_nodeArena.Clear();
+		m_nearestWalkable.clear();
+		m_components.clear();
+		m_componentSizes.clear();
+		m_freeComponents.clear();
+
+		m_lazyNodes.clear();
+		m_walkable.clear();
+		m_edgeOffsets.clear();
+		m_edgeCounts.clear();
+		m_edgeTargets.clear();
+		m_edgeCosts.clear();
+		m_positions.clear();
+		m_tileCosts.clear();
+		m_weightedCells = 0;
+		m_editLog.clear();
 	};
 
 	void NodeMap::GetMapSize() {
-		std::cout << sizeof(m_nodes[0]) << std::endl;
+		if (m_graph == GridGraph::Explicit) {
+			int edgeCount = 0;
+			for (unsigned char count : m_edgeCounts) {
+				edgeCount += count;
+			}
+			std::cout << "Map of " << m_width << "x" << m_height << " cells with " << edgeCount << " edges, using " << GetMemoryUsage() << " bytes." << std::endl;
+		}
+		else {
+			std::cout << "Implicit map of " << m_width << "x" << m_height << " cells, using " << GetMemoryUsage() << " bytes." << std::endl;
+		}
+	};
+
+	size_t NodeMap::GetMemoryUsage() const {
+		size_t bytes = m_walkable.capacity() * sizeof(unsigned long long);
+
+		if (m_nodes != nullptr) {
+			bytes += sizeof(Node*) * m_width * m_height;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_lazyNodesLock);
+			bytes += m_nodeArena.GetMemoryUsage();
+			bytes += m_lazyNodes.size() * sizeof(std::pair<const int, Node*>);
+		}
+
+		bytes += m_edgeOffsets.capacity() * sizeof(unsigned int);
+		bytes += m_edgeCounts.capacity() * sizeof(unsigned char);
+		bytes += m_edgeTargets.capacity() * sizeof(unsigned int);
+		bytes += m_edgeCosts.capacity() * sizeof(float);
+		bytes += m_positions.capacity() * sizeof(glm::vec2);
+		bytes += m_tileCosts.capacity() * sizeof(float);
+		bytes += m_nearestWalkable.capacity() * sizeof(int);
+		bytes += (m_components.capacity() + m_componentSizes.capacity() + m_freeComponents.capacity()) * sizeof(int);
+		return bytes;
 	};
 
 
 	Node* NodeMap::GetClosestNode(glm::vec2 worldPos) {
-		int i = (int)(worldPos.x / m_cellSize);
-		if (i < 0 || i > m_width) return nullptr;
+		if (m_width <= 0 || m_height <= 0) {
+			return nullptr;
+		}
 
-		int j = (int)(worldPos.y / m_cellSize);
-		if (j < 0 || j > m_height) return nullptr;
+		// The cell under the position, or the nearest cell on the edge of the map for a position off it
+		int i = (int)std::floor(worldPos.x / m_cellSize);
+		i = i < 0 ? 0 : (i >= m_width ? m_width - 1 : i);
 
-		return GetNode(i, j);
-	}
+		int j = (int)std::floor(worldPos.y / m_cellSize);
+		j = j < 0 ? 0 : (j >= m_height ? m_height - 1 : j);
+
+		if (!m_nearestWalkable.empty()) {
+			int nearest = m_nearestWalkable[i + m_width * j];
+			return nearest >= 0 ? GetNodeById(nearest) : nullptr;
+		}
+
+		// Without a table, check the cells in growing diamonds around this one (every cell in a diamond is the same number of steps away), and stop at the first walkable one
+		for (int distance = 0; distance < m_width + m_height; distance++) {
+			for (int dx = -distance; dx <= distance; dx++) {
+				int dy = distance - (dx < 0 ? -dx : dx);
+				if (IsWalkable(i + dx, j - dy)) {
+					return GetNode(i + dx, j - dy);
+				}
+				if (dy != 0 && IsWalkable(i + dx, j + dy)) {
+					return GetNode(i + dx, j + dy);
+				}
+			}
+		}
+		return nullptr;
+	};
 	
 
+	int NodeMap::GetNodeCount() const {
+		return m_width * m_height;
+	};
+
+	Node* NodeMap::GetNodeById(int id) const {
+		// A wall has no node (a cell closed by SetTileWalkable keeps its Node, but it isn't handed out while the cell is closed)
+		if (!((m_walkable[id >> 6] >> (id & 63)) & 1)) {
+			return nullptr;
+		}
+
+		// A node's id is its index in the map, so it can be looked up directly
+		if (m_graph == GridGraph::Explicit) {
+			return m_nodes[id];
+		}
+
+		// The implicit graphs make the node for a walkable cell the first time it's asked for
+
+		std::lock_guard<std::mutex> lock(m_lazyNodesLock);
+		Node*& node = m_lazyNodes[id];
+		if (node == nullptr) {
+			glm::vec2 position = GetPosition(id);
+			node = m_nodeArena.Create(position.x, position.y, id);
+		}
+		return node;
+	};
+
+	bool NodeMap::HasLineOfSight(int fromId, int toId) const {
+		int x = fromId % m_width;
+		int y = fromId / m_width;
+		const int endX = toId % m_width;
+		const int endY = toId / m_width;
+		const int stepX = endX > x ? 1 : -1;
+		const int stepY = endY > y ? 1 : -1;
+		const int dx = 2 * (endX > x ? endX - x : x - endX);
+		const int dy = 2 * (endY > y ? endY - y : y - endY);
+
+		// Walk the cells the line passes through in order. 'error' says which edge of the cell the line leaves by: positive for the side, negative for the top or bottom,
+		// and zero for the corner. It's kept in whole numbers by counting in half cells, since the line starts and ends at cell centres.
+		int error = (dx - dy) / 2;
+		if (!IsWalkable(x, y)) {
+			return false;
+		}
+		while (x != endX || y != endY) {
+			if (error > 0) {
+				x += stepX;
+				error -= dy;
+			}
+			else if (error < 0) {
+				y += stepY;
+				error += dx;
+			}
+			else {
+				// Squeezing between two walls that only touch at the corner isn't allowed
+				if (!IsWalkable(x + stepX, y) || !IsWalkable(x, y + stepY)) {
+					return false;
+				}
+				x += stepX;
+				y += stepY;
+				error += dx - dy;
+			}
+
+			if (!IsWalkable(x, y)) {
+				return false;
+			}
+		}
+		return true;
+	};
+
 	Node* NodeMap::GetNode(int x, int y) {
 		// Return the node which is x nodes from the left and on the yth row
-		return m_nodes[x + m_width * y];
+		return GetNodeById(x + m_width * y);
 	};
 
+#ifndef AIFG_HEADLESS
 	// A function for drawing the best path calculated by a Dijkstra search
 	void NodeMap::DrawPath(std::vector<Node*> path) {
 		// A Raylib color object for the shortest path through the ascii maze edge objects (blue)
@@ -66,139 +283,136 @@ namespace AIForGames {
 		lineColour.g = 0;
 		lineColour.b = 255;
 
-		// For every node with a non-null 'previous' pointer, draw a pathing line between itself and the previous node
-		for (Node* node : path) {
-			Node* other = node->previousNode;
-			if (other != nullptr) {
-				DrawLine(
-					(int)other->position.x,
-					(int)other->position.y,
-					(int)node->position.x,
-					(int)node->position.y,
-					lineColour);
-			}			
+		// The path runs in order from start to end, so draw a pathing line between each node and the one before it
+		for (int i = 1; i < (int)path.size(); i++) {
+			Node* other = path[i - 1];
+			Node* node = path[i];
+			DrawLine(
+				(int)other->position.x,
+				(int)other->position.y,
+				(int)node->position.x,
+				(int)node->position.y,
+				lineColour);
 		}
 
-		// Debugging / informational printouts to the screen
-		string noPath = "No path from start to end";
-		string numberOfNodes = to_string(path.size());
-		string numNodes = "Number of nodes in the path: " + numberOfNodes;
-
-		if (path.size() == 0) {
-			const char* nNodes = noPath.c_str();
-			DrawText(nNodes, 50, 420, 15, WHITE);
+		// Debugging / informational printouts to the screen (the text only changes when the number of nodes does, so it's kept from frame to frame)
+		if (m_drawCache == nullptr) {
+			m_drawCache.reset(new DrawCache());
 		}
-
-		else {
-			const char* nNodes = numNodes.c_str();
-			DrawText(nNodes, 50, 420, 15, WHITE);
-		}	
-
-
+		if (m_drawCache->labelledPathLength != (int)path.size()) {
+			m_drawCache->labelledPathLength = (int)path.size();
+			m_drawCache->pathLabel = path.empty() ? "No path from start to end" : "Number of nodes in the path: " + to_string(path.size());
+		}
+		DrawText(m_drawCache->pathLabel.c_str(), 50, 420, 15, WHITE);
 	};
 
 	void NodeMap::Draw() {
-		// A Raylib color object for the ascii maze node objects (red)
-		Color cellColour;
-		cellColour.a = 255;
-		cellColour.r = 255;
-		cellColour.g = 0;
-		cellColour.b = 0;
-
-		// A Raylib color object for the ascii maze edge objects (grey)
-		Color lineColour;
-		lineColour.a = 64;
-		lineColour.r = 128;
-		lineColour.g = 128;
-		lineColour.b = 128;
-
-			// Loop over the cells in a nested loop for width and height
-			// For each row element...
-			for (int y = 0; y < m_height; y++) {
-				// Look to each column element...
-				for (int x = 0; x < m_width; x++) {
-					// Create a temporary node which is a duplicate of the one whose coordinates are being examined
-					Node* node = GetNode(x, y);
-					// First, if the node is empty / doesn't exist...
-					if (node == nullptr) {
-						// draw a solid block in the empty space without a node
-						DrawRectangle(
-							(int)(x * m_cellSize),		// x
-							(int)(y * m_cellSize),		// y
-							(int)m_cellSize - 1,		// width (minus 1 pixel to separate blocks)
-							(int)m_cellSize - 1,		// height (minus 1 pixel to separate blocks)
-							cellColour);				// colour
-
-						// Debug print the map coordinates of each empty cell (too visually busy with pathed cells included)
-						string coordinateX = to_string(x);
-						string coordinateY = to_string(y);
-						string coordsYX = "(" + coordinateY + ", " + coordinateX + ")";
-						const char* coords = coordsYX.c_str();
-						DrawText(coords, (x * m_cellSize) + 2, (y * m_cellSize) + 2, 2, WHITE);
-					}
+		if (m_drawCache == nullptr) {
+			m_drawCache.reset(new DrawCache());
+		}
+		DrawCache& cache = *m_drawCache;
+		const int pixelWidth = m_width * (int)m_cellSize;
+		const int pixelHeight = m_height * (int)m_cellSize;
+		const bool useTexture = pixelWidth > 0 && pixelHeight > 0 && pixelWidth <= maxTextureSize && pixelHeight <= maxTextureSize;
+
+		// Only work the map out again (and draw it into the texture) when it has been edited or initialised again since last time
+		if (!cache.geometry.IsUpToDate(*this)) {
+			cache.geometry.Build(*this);
+
+			if (useTexture) {
+				if (cache.hasTexture && (cache.texture.texture.width != pixelWidth || cache.texture.texture.height != pixelHeight)) {
+					UnloadRenderTexture(cache.texture);
+					cache.hasTexture = false;
+				}
+				if (!cache.hasTexture) {
+					cache.texture = LoadRenderTexture(pixelWidth, pixelHeight);
+					cache.hasTexture = true;
+				}
+
+				// The texture starts out black, the same as the window is cleared to, so the see-through grey edges blend the same as they would on screen
+				BeginTextureMode(cache.texture);
+				ClearBackground(BLACK);
+				DrawMapGeometry(cache.geometry);
+				EndTextureMode();
+			}
+		}
 
-					// When there is a Node, we want to draw lines between it and its connections on its edges.
-					else {
-						// Draw the connections between the node and its neighbours, for every edge of this node
-						for (int i = 0; i < node->connections.size(); i++) {
-							// Create a temporary node pointer that points to each of the nodes connected to this one by an edge
-							Node* other = node->connections[i].targetNode;
-							// Draw a line from the centre of this node to the centre of the other node (not their top-right {0,0} origins)
-							DrawLine(
-								(int)node->position.x,		// line start x
-								(int)node->position.y,		// line start y
-								(int)other->position.x,		// line end x
-								(int)other->position.y,		// line end y
-								lineColour);				// colour
-						};
-					};
-				};
-			};
+		if (useTexture) {
+			// Render textures are stored upside down, so the source rectangle has a negative height to flip it back
+			Rectangle source = { 0.0f, 0.0f, (float)pixelWidth, -(float)pixelHeight };
+			DrawTextureRec(cache.texture.texture, source, { 0.0f, 0.0f }, WHITE);
+		}
+		else {
+			DrawMapGeometry(cache.geometry);
+		}
 	};
+#endif
 
-	void NodeMap::Initialise(std::vector<std::string> asciiMap, int cellSize) {
-		// Set the map's cell size equal to the cell size passed in
-		m_cellSize = cellSize;
-
-		// Set the code for empty cells equal to nothing (0)
+	void NodeMap::Initialise(const std::vector<std::string>& asciiMap, int cellSize, GridGraph graph) {
+		// Set the code for empty cells equal to nothing (0); every other character is navigable
 		const char emptySquare = '0';
+		bool walkableCodes[256];
+		std::fill(walkableCodes, walkableCodes + 256, true);
+		walkableCodes[(unsigned char)emptySquare] = false;
 
 		// We will assume all strings are the same length, so we'll size the map according to the number of strings and the length of the first one
-		// Height = total size
-		m_height = asciiMap.size();
-		// Width = size of first element
-		m_width = asciiMap[0].size();
-
-		// Dynamically allocate the size of the one-dimensional array of Node pointers equal to the dimensions of the map
-		// "Make me a Node pointer which points to the starting memory position of (width * height) contiguous new Node pointers"?
-		// "Make me one new Node pointer which will point to an address that has enough contiguous memory to allocate the whole map (width * height)"?
-		m_nodes = new Node * [m_width * m_height];
+		// Height = total size, width = size of first element
+		BeginRows((int)asciiMap[0].size(), (int)asciiMap.size(), cellSize, graph);
 
 		// loop over the strings entered in AIE_Starter.cpp, creating nodes for each string character
 		for (int y = 0; y < m_height; y++) {
 			// Each row of the ascii map is an increment 'line', staring with the first element (index 0)
-			std::string& line = asciiMap[y];
+			const std::string& line = asciiMap[y];
 			// report to the user that you have a mis-matched string length if some row is of a different length than index 0
 			if (line.size() != m_width) {
 				std::cout << "Mismatched line #" << y << " in ASCII map (" << line.size() << " instead of " << m_width << ")" << std::endl;
 			}
+			AddRow(y, line.data(), (int)line.size(), walkableCodes);
+		}
 
-			for (int x = 0; x < m_width; x++) {
-				// get the x-th character of the y-th row, or else return an empty node if the string isn't long enough
-				char tile = x			// if this (the target tile of this row)...
-					< line.size()		// resolves this as true (true that this cell has yet to be calculated)...
-					? line[x]			// do this (return the x-th character of the y-th row)
-					: emptySquare;		// else do this (leave the target tile empty if we're at the end of the y-th row)
+		EndRows();
+	};
+
+	void NodeMap::BeginRows(int width, int height, int cellSize, GridGraph graph) {
+		// Throw away anything left from an earlier Initialise
+		Clear();
+
+		// Set the map's cell size equal to the cell size passed in
+		m_cellSize = cellSize;
+		m_graph = graph;
+		m_version++;
+		m_width = width;
+		m_height = height;
 
-				// create a node for anything other than a period character '.'
-				m_nodes[x + m_width * y] = tile		// if this (the target tile)...
-					== emptySquare					// resolves this as true (the target tile is empty [a '0'])...
-					? nullptr						// do this (don't create a node)
-					: new Node(((float)x + 0.5f) * m_cellSize, ((float)y + 0.5f) * m_cellSize);		// else do this (create a node with x & y coordinates of where we have iterated up to in the ascii art map rows and columns, in the middle of its 'cell' [hence the halving of cell size for height and width])
-				std::cout << "Created node at position:\tColumn (" << x << ")\tRow (" << y << ")." << std::endl;
+		// Dynamically allocate the size of the one-dimensional array of Node pointers equal to the dimensions of the map
+		// "Make me a Node pointer which points to the starting memory position of (width * height) contiguous new Node pointers"?
+		// "Make me one new Node pointer which will point to an address that has enough contiguous memory to allocate the whole map (width * height)"?
+		// The implicit graphs skip this array (on a 10000 x 10000 map it alone would be 800 MB) and only keep the walkable bits.
+		// Every pointer starts out null, so any row that never gets added is left as walls.
+		if (m_graph == GridGraph::Explicit) {
+			m_nodes = new Node * [(size_t)m_width * m_height]();
+		}
+		m_walkable.assign(((size_t)m_width * m_height + 63) / 64, 0);
+	};
+
+	void NodeMap::AddRow(int y, const char* row, int length, const bool* walkableCodes) {
+		// get the x-th character of the row, or else leave the cell empty if the row isn't long enough (extra characters are never read)
+		const int rowStart = m_width * y;
+		const int readLength = length < m_width ? length : m_width;
+
+		// mark each walkable cell's bit. The bits are gathered up a whole 64-bit word at a time and written once per word, instead of once per cell.
+		unsigned long long word = 0;
+		for (int x = 0; x < readLength; x++) {
+			int id = rowStart + x;
+			word |= (unsigned long long)walkableCodes[(unsigned char)row[x]] << (id & 63);
+			if ((id & 63) == 63 || x == readLength - 1) {
+				m_walkable[id >> 6] |= word;
+				word = 0;
 			}
 		}
+	};
 
+	void NodeMap::EndRows() {
 		/* From the tute:
 		"Were using the length of the first string to calculate the width of the rectangular node map. We put in a debug warning if any of the strings are a different length but fail gracefully if they dont match. Extra characters will never be read. Any missing characters on the end are assumed to be not navigable, so we wont create a node for them.
 
@@ -209,209 +423,582 @@ namespace AIForGames {
 		Loop over each of the nodes, creating connections between each node and its neightbout to the west and south on the grid. This will link up all nodes."
 		*/
 
-		// For each row element...
+		// The implicit graphs are done: their edges are worked out from the walkable bits whenever a search asks for them
+		if (m_graph != GridGraph::Explicit) {
+			return;
+		}
+
+		// The edges go straight into one compressed sparse row block for the whole map instead of a vector per node.
+		// First pass: give every cell room for an edge to each neighbour it has on the grid (walls too, so they can be opened later),
+		// and add the room up so each cell knows where its block of edges starts
+		const int nodeCount = m_width * m_height;
+		m_edgeOffsets.assign(nodeCount + 1, 0);
 		for (int y = 0; y < m_height; y++) {
-			// Look to each column element...
 			for (int x = 0; x < m_width; x++) {
-				// Create a temporary node pointer which points to the address of the one whose coordinates are being examined
-				Node* node = GetNode(x, y);
-				// If the node exists...
-				if (node) {
-					// Create another temporary node pointer to check whether there is a node to the west, including a check for array over-runs if this is the west-most column
-					Node* nodeWest = x			// if this...
-						== 0					// resolves this as true ("the node to the west is empty")...
-						? nullptr				// do this (make nodeWest a nullptr)
-						: GetNode(x - 1, y);	// else do this (return the node to the west)
-
-					// If it is true that there IS a node to the west (nodeWest is not a nullptr)...
-					if (nodeWest) {
-						// Connect this node to the western node and give it a distance of 1
-						node->ConnectTo(nodeWest, 1);
-						// Connect the western node to this node and give it a distance of 1
-						nodeWest->ConnectTo(node, 1);
-					};
-
-					// Create another temporary node pointer to check whether there is a node to the south, including a check for array over-runs if this is the south-most row
-					Node* nodeSouth = y			// if this...
-						== 0					// resolves this as true ("the node to the south is empty")...
-						? nullptr				// do this (make nodeSouth a nullptr)
-						: GetNode(x, y - 1);	// else do this (return the node to the south)
-
-					// If it is true that there IS a node to the south (nodeSouth is not a nullptr)...
-					if (nodeSouth) {
-						// Connect this node to the southern node and give it a distance of 1
-						node->ConnectTo(nodeSouth, 1);
-						// Connect the southern node to this node and give it a distance of 1
-						nodeSouth->ConnectTo(node, 1);
-					};
-				};
-			};
+				int room = (x > 0) + (y > 0) + (x + 1 < m_width) + (y + 1 < m_height);
+				m_edgeOffsets[x + m_width * y + 1] = m_edgeOffsets[x + m_width * y] + room;
+			}
+		}
+
+		// Second pass: fill in each node's block. For this exercise, we'll assume that all edges are of equal cost of 1 to navigate (until SetTileCost says otherwise).
+		m_edgeCounts.assign(nodeCount, 0);
+		m_edgeTargets.resize(m_edgeOffsets[nodeCount]);
+		m_edgeCosts.resize(m_edgeOffsets[nodeCount]);
+		m_positions.resize(nodeCount);
+		for (int y = 0; y < m_height; y++) {
+			for (int x = 0; x < m_width; x++) {
+				m_positions[x + m_width * y] = glm::vec2(((float)x + 0.5f) * m_cellSize, ((float)y + 0.5f) * m_cellSize);
+				BuildEdges(x, y);
+			}
+		}
+
+		CreateNodes();
+		BuildNearestWalkable();
+		BuildComponents();
+	};
+
+	namespace {
+		// The number of steps along the grid between two cells
+		int GridDistance(int fromId, int toId, int width) {
+			int dx = fromId % width - toId % width;
+			int dy = fromId / width - toId / width;
+			return (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
 		};
+	}
+
+	void NodeMap::BuildNearestWalkable() {
+		// Every walkable cell is its own nearest, and starts the search. Each cell the search reaches takes the answer from the cell it was reached from,
+		// which (because a breadth first search reaches cells in order of distance) is the nearest walkable cell to it too.
+		const int nodeCount = m_width * m_height;
+		m_nearestWalkable.assign(nodeCount, -1);
+		std::vector<int> queue;
+		queue.reserve(nodeCount);
+		for (int id = 0; id < nodeCount; id++) {
+			if ((m_walkable[id >> 6] >> (id & 63)) & 1) {
+				m_nearestWalkable[id] = id;
+				queue.push_back(id);
+			}
+		}
+
+		// The search crosses walls as well, since a click can land anywhere
+		for (size_t next = 0; next < queue.size(); next++) {
+			int id = queue[next];
+			int x = id % m_width;
+			int y = id / m_width;
+			for (int direction = 0; direction < 4; direction++) {
+				int nx = x + neighbourX[direction];
+				int ny = y + neighbourY[direction];
+				if (nx >= 0 && nx < m_width && ny >= 0 && ny < m_height && m_nearestWalkable[nx + m_width * ny] < 0) {
+					m_nearestWalkable[nx + m_width * ny] = m_nearestWalkable[id];
+					queue.push_back(nx + m_width * ny);
+				}
+			}
+		}
 	};
 
+	void NodeMap::PatchNearestWalkable(int id, bool walkable) {
+		std::vector<int> queue;
 
-	// This is a function for calculating a series of Node Pointers that go from a start node to an end node.
-	vector<Node*> NodeMap::DijkstraSearch(Node* startNode, Node* endNode) {
-		// A lambda expression to be used as a function object for returning whether one node has a larger g score than another, inside a sort algorithm. I'm not searching by a property, always run the body of the expression based on the node's respective g scores.
-		auto lambdaNodeSort = [](Node* const& lhs, Node* const& rhs) -> bool {
-			// Return true if the left hand side integer is less than the right hand side integer, otherwise return false
-			return lhs->gScore < rhs->gScore;
-		};
+		if (walkable) {
+			// An opened cell is the new nearest for itself and for the cells around it that are now closer to it than to their old answer
+			m_nearestWalkable[id] = id;
+			queue.push_back(id);
+		}
+		else {
+			// A closed cell leaves the cells that had it as their nearest without an answer. Those cells all join up around it, so find them by spreading out from it,
+			// then start again from the cells just outside them, whose answers haven't changed.
+			std::vector<int> orphans(1, id);
+			m_nearestWalkable[id] = -1;
+			for (size_t next = 0; next < orphans.size(); next++) {
+				int x = orphans[next] % m_width;
+				int y = orphans[next] / m_width;
+				for (int direction = 0; direction < 4; direction++) {
+					int nx = x + neighbourX[direction];
+					int ny = y + neighbourY[direction];
+					if (nx >= 0 && nx < m_width && ny >= 0 && ny < m_height) {
+						int neighbour = nx + m_width * ny;
+						if (m_nearestWalkable[neighbour] == id) {
+							m_nearestWalkable[neighbour] = -1;
+							orphans.push_back(neighbour);
+						}
+						else if (m_nearestWalkable[neighbour] >= 0) {
+							queue.push_back(neighbour);
+						}
+					}
+				}
+			}
+		}
+
+		// Spread answers out from the queued cells, for as long as they make some cell's answer closer
+		for (size_t next = 0; next < queue.size(); next++) {
+			int cell = queue[next];
+			int nearest = m_nearestWalkable[cell];
+			int x = cell % m_width;
+			int y = cell / m_width;
+			for (int direction = 0; direction < 4; direction++) {
+				int nx = x + neighbourX[direction];
+				int ny = y + neighbourY[direction];
+				if (nx >= 0 && nx < m_width && ny >= 0 && ny < m_height) {
+					int neighbour = nx + m_width * ny;
+					int current = m_nearestWalkable[neighbour];
+					if (current < 0 || GridDistance(neighbour, nearest, m_width) < GridDistance(neighbour, current, m_width)) {
+						m_nearestWalkable[neighbour] = nearest;
+						queue.push_back(neighbour);
+					}
+				}
+			}
+		}
+	};
 
+	void NodeMap::BuildComponents() {
+		const int nodeCount = m_width * m_height;
+		m_components.assign(nodeCount, -1);
+		m_componentSizes.clear();
+		m_freeComponents.clear();
+
+		// Each walkable cell that isn't labelled yet starts a new component, and a flood fill from it labels everything it can reach
+		std::vector<int> queue;
+		for (int id = 0; id < nodeCount; id++) {
+			if (m_components[id] >= 0 || !((m_walkable[id >> 6] >> (id & 63)) & 1)) {
+				continue;
+			}
 
-		//	DIJKSTRA SEARCH FUNCTION -------------------------------------------------------------------------------
-		//	1	----------------------------------------------------------------------------------------------------
-		cout << "Step 1: Check the starting and ending node positions for existence on the map." << endl;
-		startNode == nullptr || endNode == nullptr												// If this is true
-			? cout << "Error - start or end, or both, do not exist." << endl	// Do this (add functionality)
-			: cout << "Start and end both exist. Continue." << endl;			// Else do this (add functionality)
-
-		startNode == endNode																		// If this is true
-			? cout << "Start and end are same - path is complete." << endl		// Do this (add functionality)
-			: cout << "Start node and end node are different. Continue.\n" << endl;	// Else do this (add functionality)
-
-
-		//	2	----------------------------------------------------------------------------------------------------
-		cout << "Step 2: Initialise the starting node." << endl;
-		// Set distance from the starting node = 0.
-		startNode->gScore = 0;
-		cout << "Distance from starting node to itself: " << startNode->gScore << "." << endl;
-		// Set no previous node for the origin.
-		startNode->previousNode = nullptr;
-		cout << "Origin has no previous node.\n" << endl;
-
-
-		//	3	----------------------------------------------------------------------------------------------------
-		cout << "Step 3: Add the starting node to the list of open nodes.\n" << endl;
-		// Create a collection (here the list is a vector) of nodes/vertices not yet processed
-		vector<Node*> openList;
-
-		// Create a collection (here the list is a vector) of nodes/vertices finished being processed
-		vector<Node*> closedList;
-
-		// A pointer to a Node that is the current node being processed
-		Node* currentNode;
-
-		openList.push_back(startNode);
-
-
-		//	4	----------------------------------------------------------------------------------------------------
-		// debug counter
-		int counter = 0;
-
-		std::cout << "Step 4: While the open list is not empty, run the Dijkstra search for the end node.\nBegin while loop\t----------" << endl;
-		while (openList.size() != 0) {
-			//	4.1	----------------------------------------------------------------------------------------------------
-			/* Sort the open list so that the smallest g value (Dijkstra) or f value (A*) is at the front.
-			I'm using the "Compare" container template version of the sort() function from the <algorithm> header file, together with a lambda expression which accepts two nodes and sorts them according to a comparison between their g scores, returning true/false based on the comparison. */
-			sort(
-				openList.begin(),
-				openList.end(),
-				lambdaNodeSort);
-			cout << "Step 4.1: The open list has been sorted by ascending node g score." << endl;
-			cout << "Step 4.1.1: Begin processing node " << counter << "." << endl;
-			counter++;
-
-			//	4.2	----------------------------------------------------------------------------------------------------
-			currentNode = *openList.begin();
-			cout << "Step 4.2: First node in the open list (g score of " << currentNode->gScore << ") has been set as the current node." << endl;
-
-			//	4.3	----------------------------------------------------------------------------------------------------
-			cout << "Step 4.3: Check if the end node has been reached." << endl;
-			if (currentNode == endNode) {
-				std::cout << "Step 4.3a: The end node has been reached - while loop will end.\n" << endl;
-				break;
-			}
-			cout << "Step 4.3b: The end node has not been reached - while loop will continue." << endl;
-
-			//	4.4	----------------------------------------------------------------------------------------------------
-			// 4.4.1: Create an iterator to find the location of the current node in the open list
-			vector<Node*>::iterator itr_00 = find(openList.begin(), openList.end(), currentNode);
-			// Save the position in the list where the current node was found
-			int index_00 = 0;
-			index_00 = distance(openList.begin(), itr_00);
-			// Erase the found node from the list
-			openList.erase(openList.begin() + index_00);
-			cout << "Step 4.4: The current node has been removed from the open list." << endl;
-
-			//	4.5	----------------------------------------------------------------------------------------------------
-			closedList.push_back(currentNode);
-			cout << "Step 4.5: The current node has been added to the closed list (it has finished being processed)." << endl;
-
-			//	4.6	----------------------------------------------------------------------------------------------------
-			cout << "Step 4.6: Determine whether the target Nodes of the current Node's Edges have already been processed or not." << endl;
-			// For all edges of the currentNode...
-			for (Edge targetEdge : currentNode->connections) {
-				// 4.6.1: Create iterators to look at the target node of the edge and see whether it is in the closed list or open list
-				vector<Node*>::iterator itr_01 = find(closedList.begin(), closedList.end(), targetEdge.targetNode);
-				vector<Node*>::iterator itr_02 = find(openList.begin(), openList.end(), targetEdge.targetNode);
-				cout << "Step 4.6.1: An Edge was found and its target Node has been searched for in the closed and open lists." << endl;
-
-				// Save the position in the closed and open lists where this edge's target node was found
-				int index_01 = 0;
-				index_01 = distance(closedList.begin(), itr_01);
-				int index_02 = 0;
-				index_02 = distance(openList.begin(), itr_02);
-
-				// 4.6.2: If the iterator did not find the target node in the closed list (if it reached the end of the closed list) Then the target node of this edge needs to be processed.
-				if (itr_01 == closedList.end()) {
-					cout << "Step 4.6.2: This Edge was not found in the closed list (its processing has started but not yet finished)." << endl;
-
-					// 4.6.2.1: Calculate a hypothetical g score (for comparison against the pre-existing g score)
-					int calcdG = currentNode->gScore + targetEdge.cost;
-					cout << "Step 4.6.2.1: This Edge has a target Node with a calculated g score of [" << calcdG << "]." << endl;
-
-					// 4.6.2.2a: Then, if this node is not already in the open list...
-					if (itr_02 == openList.end()) {
-						cout << "Step 4.6.2.2a: The target Node of this Edge was not found in the open list (its processing has not yet started)." << endl;
-
-						// Make the g score of the target node equal to the g score of the current node plus the cost of this edge
-						targetEdge.targetNode->gScore = calcdG;
-						cout
-							<< "Step 4.6.2.2a(i): The target Node of this Edge has had its g score set to ["
-							<< targetEdge.targetNode->gScore
-							<< "]." << endl;
-
-						// Make the current node be the 'previous' node of the target
-						targetEdge.targetNode->previousNode = currentNode;
-						cout << "Step 4.6.2.2a(ii): The current Node is now the parent of the target Node on this Edge." << endl;
-
-						// Add to the open list for processing
-						openList.push_back(targetEdge.targetNode);
-						cout << "Step 4.6.2.2a(iii): The target Node of this Edge has been added to the open list (its processing has started).\n" << endl;
+			int label = (int)m_componentSizes.size();
+			m_components[id] = label;
+			queue.assign(1, id);
+			for (size_t next = 0; next < queue.size(); next++) {
+				int x = queue[next] % m_width;
+				int y = queue[next] / m_width;
+				for (int direction = 0; direction < 4; direction++) {
+					int nx = x + neighbourX[direction];
+					int ny = y + neighbourY[direction];
+					if (IsWalkable(nx, ny) && m_components[nx + m_width * ny] < 0) {
+						m_components[nx + m_width * ny] = label;
+						queue.push_back(nx + m_width * ny);
 					}
+				}
+			}
+			m_componentSizes.push_back((int)queue.size());
+		}
+	};
 
-					// 4.6.2.2b: Otherwise if this node is already in the openList AND if its calculated g score is lower than its existing g score...
-					else if (calcdG < targetEdge.targetNode->gScore) {
-						cout << "Step 4.6.2.2b: This edge was found in the open list (its processing has started but not yet finished) and its g score through this Edge is lower than its existing g score through some other path (this path is shorter)." << endl;
+	int NodeMap::NewComponent(int size) {
+		if (m_freeComponents.empty()) {
+			m_componentSizes.push_back(size);
+			return (int)m_componentSizes.size() - 1;
+		}
+		int label = m_freeComponents.back();
+		m_freeComponents.pop_back();
+		m_componentSizes[label] = size;
+		return label;
+	};
 
-						targetEdge.targetNode->gScore = calcdG;
-						cout << "Step 4.6.2.2b(i): The target Node of this Edge has had its g score set to ["
-							<< targetEdge.targetNode->gScore
-							<< "]." << endl;
+	void NodeMap::JoinComponents(int id) {
+		// The opened cell joins the biggest of the components around it, and every smaller one is relabelled to match,
+		// so each cell is only relabelled when its component at least doubles in size
+		int x = id % m_width;
+		int y = id / m_width;
+		int label = -1;
+		for (int direction = 0; direction < 4; direction++) {
+			int nx = x + neighbourX[direction];
+			int ny = y + neighbourY[direction];
+			if (IsWalkable(nx, ny)) {
+				int neighbourLabel = m_components[nx + m_width * ny];
+				if (label < 0 || m_componentSizes[neighbourLabel] > m_componentSizes[label]) {
+					label = neighbourLabel;
+				}
+			}
+		}
 
-						targetEdge.targetNode->previousNode = currentNode;
-						cout << "Step 4.6.2.2b(ii): The current Node is now the parent of the target Node on this Edge.\n" << endl;
-					};
-				};
-			};
+		// A cell opened with walls all round is a component of its own
+		if (label < 0) {
+			m_components[id] = NewComponent(1);
+			return;
+		}
+		m_components[id] = label;
+		m_componentSizes[label]++;
+
+		std::vector<int> queue;
+		for (int direction = 0; direction < 4; direction++) {
+			int nx = x + neighbourX[direction];
+			int ny = y + neighbourY[direction];
+			if (!IsWalkable(nx, ny) || m_components[nx + m_width * ny] == label) {
+				continue;
+			}
+
+			int oldLabel = m_components[nx + m_width * ny];
+			m_components[nx + m_width * ny] = label;
+			queue.assign(1, nx + m_width * ny);
+			for (size_t next = 0; next < queue.size(); next++) {
+				int cellX = queue[next] % m_width;
+				int cellY = queue[next] / m_width;
+				for (int step = 0; step < 4; step++) {
+					int cell = cellX + neighbourX[step] + m_width * (cellY + neighbourY[step]);
+					if (IsWalkable(cellX + neighbourX[step], cellY + neighbourY[step]) && m_components[cell] == oldLabel) {
+						m_components[cell] = label;
+						queue.push_back(cell);
+					}
+				}
+			}
+			m_componentSizes[label] += m_componentSizes[oldLabel];
+			m_componentSizes[oldLabel] = 0;
+			m_freeComponents.push_back(oldLabel);
+		}
+	};
+
+	void NodeMap::SplitComponent(int id, int label) {
+		m_components[id] = -1;
+		m_componentSizes[label]--;
+
+		// Closing the cell can only split its component between the (up to four) open cells around it
+		int x = id % m_width;
+		int y = id / m_width;
+		int fronts = 0;
+		int starts[4];
+		for (int direction = 0; direction < 4; direction++) {
+			if (IsWalkable(x + neighbourX[direction], y + neighbourY[direction])) {
+				starts[fronts++] = x + neighbourX[direction] + m_width * (y + neighbourY[direction]);
+			}
+		}
+		if (fronts == 0) {
+			m_componentSizes[label] = 0;
+			m_freeComponents.push_back(label);
+			return;
+		}
+		if (fronts == 1) {
+			return;
+		}
+
+		// Flood out from every one of them at once, a cell at a time each. Fronts that run into each other are joined up into one group.
+		// A group that runs out of cells before meeting the others has been cut off, and becomes a component of its own; the search stops when
+		// only one group is left, which keeps the old label. So the work done is about the size of the smaller pieces, not the whole component,
+		// and a wall that doesn't cut anything off costs no more than the walk around it.
+		std::unordered_map<int, int> visitedBy;
+		std::vector<int> queues[4];
+		size_t heads[4] = {};
+		int groups[4];
+		bool cutOff[4] = {};
+		for (int front = 0; front < fronts; front++) {
+			queues[front].push_back(starts[front]);
+			visitedBy[starts[front]] = front;
+			groups[front] = front;
+		}
+		auto group = [&](int front) {
+			while (groups[front] != front) {
+				front = groups[front];
+			}
+			return front;
 		};
 
-		
+		int liveGroups = fronts;
+		while (liveGroups > 1) {
+			for (int front = 0; front < fronts && liveGroups > 1; front++) {
+				if (cutOff[group(front)] || heads[front] == queues[front].size()) {
+					continue;
+				}
+
+				int cell = queues[front][heads[front]++];
+				int cellX = cell % m_width;
+				int cellY = cell / m_width;
+				for (int direction = 0; direction < 4; direction++) {
+					if (!IsWalkable(cellX + neighbourX[direction], cellY + neighbourY[direction])) {
+						continue;
+					}
+					int neighbour = cell + neighbourX[direction] + m_width * neighbourY[direction];
+					std::unordered_map<int, int>::iterator found = visitedBy.find(neighbour);
+					if (found == visitedBy.end()) {
+						visitedBy[neighbour] = front;
+						queues[front].push_back(neighbour);
+					}
+					else if (group(found->second) != group(front)) {
+						groups[group(found->second)] = group(front);
+						liveGroups--;
+					}
+				}
+			}
+
+			// Any group whose fronts have all run dry is walled off from the rest
+			for (int root = 0; root < fronts && liveGroups > 1; root++) {
+				if (group(root) != root || cutOff[root]) {
+					continue;
+				}
+				bool exhausted = true;
+				for (int front = 0; front < fronts; front++) {
+					exhausted = exhausted && (group(front) != root || heads[front] == queues[front].size());
+				}
+				if (!exhausted) {
+					continue;
+				}
+
+				int size = 0;
+				for (int front = 0; front < fronts; front++) {
+					if (group(front) == root) {
+						size += (int)queues[front].size();
+					}
+				}
+				int newLabel = NewComponent(size);
+				for (int front = 0; front < fronts; front++) {
+					if (group(front) == root) {
+						for (int cell : queues[front]) {
+							m_components[cell] = newLabel;
+						}
+					}
+				}
+				m_componentSizes[label] -= size;
+				cutOff[root] = true;
+				liveGroups--;
+			}
+		}
+	};
+
+	void NodeMap::CreateNodes() {
+		// Count the walkable cells first, so the arena can make room for all of their Nodes in one block
+		int walkableCount = 0;
+		for (unsigned long long word : m_walkable) {
+			for (; word != 0; word &= word - 1) {
+				walkableCount++;
+			}
+		}
+		m_nodeArena.Reserve(walkableCount);
+
+		// create a node with x & y coordinates at the middle of each walkable 'cell' [hence the halving of cell size for height and width]
+		// and give it its index on the map, which is where searches keep its scratch data
+		const int nodeCount = m_width * m_height;
+		for (int id = 0; id < nodeCount; id++) {
+			if ((m_walkable[id >> 6] >> (id & 63)) & 1) {
+				m_nodes[id] = m_nodeArena.Create(m_positions[id].x, m_positions[id].y, id);
+			}
+		}
+	};
 
-		std::cout << "End while loop\t--------\n" << endl;
+	void NodeMap::BuildEdges(int x, int y) {
+		// Each node's edges are stored in the order the tutorial's west/south pass used to create them (west, y - 1, east, y + 1), so searches still break ties the same way.
+		// A cell has an edge to a neighbour if both of them are walkable, costing whatever it costs to step into the neighbour.
+		int id = x + m_width * y;
+		unsigned int edge = m_edgeOffsets[id];
+		unsigned char count = 0;
+		if (IsWalkable(x, y)) {
+			for (int direction = 0; direction < 4; direction++) {
+				int nx = x + neighbourX[direction];
+				int ny = y + neighbourY[direction];
+				if (IsWalkable(nx, ny)) {
+					m_edgeTargets[edge + count] = (unsigned int)(nx + m_width * ny);
+					m_edgeCosts[edge + count] = GetTileCost(nx + m_width * ny);
+					count++;
+				}
+			}
+		}
+		m_edgeCounts[id] = count;
+	};
 
-		//	5	----------------------------------------------------------------------------------------------------
-		cout << "Step 5: Create a path in reverse from the end node to the start node." << endl;
-		vector<Node*> path;
-		cout << "A vector of Nodes (the 'path') has been created." << endl;
+	void NodeMap::RecordEdit(int id) {
+		m_version++;
+		m_editLog.push_back(id);
+		if (m_editLog.size() > maxEditLogLength) {
+			m_editLog.pop_front();
+		}
+	};
+
+	void NodeMap::SetTileWalkable(int x, int y, bool walkable) {
+		if (x < 0 || x >= m_width || y < 0 || y >= m_height || IsWalkable(x, y) == walkable) {
+			return;
+		}
+
+		int id = x + m_width * y;
+		if (walkable) {
+			m_walkable[id >> 6] |= 1ull << (id & 63);
+		}
+		else {
+			m_walkable[id >> 6] &= ~(1ull << (id & 63));
+		}
+
+		if (m_graph == GridGraph::Explicit) {
+			// A cell opened for the first time gets its Node now; one that was open before still has the Node it had then
+			if (walkable && m_nodes[id] == nullptr) {
+				m_nodes[id] = m_nodeArena.Create(m_positions[id].x, m_positions[id].y, id);
+			}
+			PatchNearestWalkable(id, walkable);
+			if (walkable) {
+				JoinComponents(id);
+			}
+			else {
+				SplitComponent(id, m_components[id]);
+			}
+
+			// The cell's own edges, and each neighbour's edge back to it
+			BuildEdges(x, y);
+			for (int direction = 0; direction < 4; direction++) {
+				if (IsWalkable(x + neighbourX[direction], y + neighbourY[direction])) {
+					BuildEdges(x + neighbourX[direction], y + neighbourY[direction]);
+				}
+			}
+		}
 
-		currentNode = endNode;
-		while (currentNode != nullptr) {
-			path.insert(path.begin(), currentNode);
-			currentNode = currentNode->previousNode;
+		RecordEdit(id);
+	};
+
+	void NodeMap::SetTileCost(int x, int y, float cost) {
+		if (x < 0 || x >= m_width || y < 0 || y >= m_height) {
+			return;
+		}
+
+		int id = x + m_width * y;
+		cost = cost > 1.0f ? cost : 1.0f;
+		if (cost == GetTileCost(id)) {
+			return;
+		}
+
+		if (m_tileCosts.empty()) {
+			m_tileCosts.assign(GetNodeCount(), 1.0f);
+		}
+		m_weightedCells += (cost != 1.0f) - (m_tileCosts[id] != 1.0f);
+		m_tileCosts[id] = cost;
+
+		// Only the edges stepping into the cell change, and those belong to its neighbours
+		if (m_graph == GridGraph::Explicit) {
+			for (int direction = 0; direction < 4; direction++) {
+				if (IsWalkable(x + neighbourX[direction], y + neighbourY[direction])) {
+					BuildEdges(x + neighbourX[direction], y + neighbourY[direction]);
+				}
+			}
 		}
 
+		RecordEdit(id);
+	};
+
+	bool NodeMap::GetEditsSince(unsigned int version, vector<int>& cells) const {
+		unsigned int editCount = m_version - version;
+		if (editCount > m_editLog.size()) {
+			return false;
+		}
+		cells.insert(cells.end(), m_editLog.end() - editCount, m_editLog.end());
+		return true;
+	};
+
+
+	vector<Node*> NodeMap::ToNodePath(const vector<int>& ids) const {
+		vector<Node*> path;
+		path.reserve(ids.size());
+		for (int id : ids) {
+			path.push_back(GetNodeById(id));
+		}
 		return path;
 	};
-};
\ No newline at end of file
+
+	// This is a function for calculating a series of Node Pointers that go from a start node to an end node.
+	// This version creates its own scratch data for the one search; pass a SearchContext to reuse one between searches.
+	vector<Node*> NodeMap::DijkstraSearch(Node* startNode, Node* endNode) const {
+		SearchContext context(GetNodeCount());
+		return DijkstraSearch(startNode, endNode, context);
+	};
+
+	void NodeMap::BuildShortestPathTree(Node* startNode, SearchContext& context) const {
+		AStarSearch<ZeroHeuristic>(startNode, nullptr, context);
+	};
+
+	// The same search as DijkstraSearch, except that the open list starts with every source in it at a g score of 0, and it only stops once enough targets have come off the open list.
+	int NodeMap::MultiSourceSearch(const vector<Node*>& sources, const vector<Node*>& targets, SearchContext& context, int targetsNeeded) const {
+		chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+		SearchStats stats = SearchStats();
+		context.Begin(GetNodeCount());
+		NodeQueue& openList = context.OpenList();
+
+		// The components the sources are in. A target in any other component can never come off the open list, and counting it as needed would
+		// keep the search going until everything the sources can reach had been expanded.
+		vector<int> sourceComponents;
+		for (Node* source : sources) {
+			if (source != nullptr) {
+				sourceComponents.push_back(GetComponent(source->id));
+			}
+		}
+		sort(sourceComponents.begin(), sourceComponents.end());
+
+		// The targets are kept as a sorted list of ids, so checking each node taken off the open list is a binary search however many targets there are.
+		// Walls, repeated targets and targets no source can reach are dropped.
+		vector<int> targetIds;
+		targetIds.reserve(targets.size());
+		for (Node* target : targets) {
+			if (target != nullptr && binary_search(sourceComponents.begin(), sourceComponents.end(), GetComponent(target->id))) {
+				targetIds.push_back(target->id);
+			}
+		}
+		sort(targetIds.begin(), targetIds.end());
+		targetIds.erase(unique(targetIds.begin(), targetIds.end()), targetIds.end());
+		if (targetsNeeded < 0 || targetsNeeded > (int)targetIds.size()) {
+			targetsNeeded = (int)targetIds.size();
+		}
+
+		// Every source starts the search at once, with no previous node, so each path leads back to whichever source is nearest
+		for (Node* source : sources) {
+			if (source != nullptr && context.GetListState(source->id) == SearchContext::Unvisited) {
+				AIFG_TRACE_NODE(Begin, source->id, 0.0f);
+				context.SetScore(source->id, 0.0f, -1);
+				context.SetListState(source->id, SearchContext::Open);
+				openList.Push(source->id, 0.0f);
+				stats.nodesOpened++;
+				AIFG_TRACE_EDGE(Push, source->id, 0.0f);
+			}
+		}
+
+		// A target has its shortest distance once it comes off the open list, the same as the end node of a single search
+		int targetsReached = 0;
+		while (!openList.Empty() && targetsReached < targetsNeeded) {
+			int currentNode = openList.Pop();
+			float currentG = context.GetGScore(currentNode);
+			AIFG_TRACE_NODE(Expand, currentNode, currentG);
+			context.SetListState(currentNode, SearchContext::Closed);
+
+			if (binary_search(targetIds.begin(), targetIds.end(), currentNode)) {
+				AIFG_TRACE_NODE(Found, currentNode, currentG);
+				targetsReached++;
+				if (targetsReached == targetsNeeded) {
+					break;
+				}
+			}
+
+			stats.nodesExpanded++;
+			AIFG_TRACE_NODE(Close, currentNode, currentG);
+			ForEachNeighbour(currentNode, [&](int targetNode, float cost) {
+				SearchContext::ListState targetState = context.GetListState(targetNode);
+				if (targetState == SearchContext::Closed) {
+					return;
+				}
+
+				float calcdG = currentG + cost;
+				if (targetState == SearchContext::Unvisited) {
+					context.SetScore(targetNode, calcdG, currentNode);
+					context.SetListState(targetNode, SearchContext::Open);
+					openList.Push(targetNode, calcdG);
+					stats.nodesOpened++;
+					AIFG_TRACE_EDGE(Push, targetNode, calcdG);
+				}
+				else if (calcdG < context.GetGScore(targetNode)) {
+					context.SetScore(targetNode, calcdG, currentNode);
+					openList.DecreaseKey(targetNode, calcdG);
+					AIFG_TRACE_EDGE(Relax, targetNode, calcdG);
+				}
+			});
+		}
+
+		// The search stopped early, so the targets still on the open list only have a first guess at their distance. Take them back to unreached.
+		while (!openList.Empty()) {
+			int openNode = openList.Pop();
+			context.SetScore(openNode, numeric_limits<float>::infinity(), -1);
+			context.SetListState(openNode, SearchContext::Unvisited);
+		}
+
+		stats.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count();
+		context.SetStats(stats);
+		return targetsReached;
+	};
+
+	vector<Node*> NodeMap::GetSearchPath(Node* endNode, const SearchContext& context) const {
+		return endNode != nullptr ? ToNodePath(context.BuildPath(endNode->id)) : vector<Node*>();
+	};
+
+	// This version keeps all of its scratch data in the given context, so the map itself is only ever read.
+	// Dijkstra's algorithm is A* with an estimate of zero, so the search itself (and its step-by-step narrative) lives in AStarSearch.
+	vector<Node*> NodeMap::DijkstraSearch(Node* startNode, Node* endNode, SearchContext& context) const {
+		return AStarSearch<ZeroHeuristic>(startNode, endNode, context);
+	};
+};
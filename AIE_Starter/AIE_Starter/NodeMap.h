@@ -1,13 +1,36 @@
 #pragma once
 #include "Pathfinding.h"
+#include "NodeArena.h"
+#include "SearchContext.h"
+#include "Heuristics.h"
+#include "SearchTrace.h"
+#include <chrono>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 
 // Use the same namespace as the one set up by the tutorial
 namespace AIForGames {
+	// How a NodeMap keeps the connections between its cells
+	enum class GridGraph {
+		// Every edge is built into compressed sparse row arrays, and every walkable cell gets a Node up front
+		Explicit,
+		// No edges are stored at all: a cell's neighbours are worked out from the walkable bits of the four cells around it, at a cost of 1 each (or the tile cost of the cell stepped into, see SetTileCost)
+		Implicit4,
+		// As Implicit4, plus diagonal steps costing sqrt(2) times as much wherever both of the cells beside the diagonal are walkable too
+		Implicit8
+	};
+
 	// Create a new class within the namespace to hold the map of nodes
 	class NodeMap
 	{
+		// Saves and restores the map's arrays as they are
+		friend class MapSnapshot;
+
 		// Map variables
 		int m_width;
 		int m_height;
@@ -15,9 +38,89 @@ namespace AIForGames {
 		// The size of every separate 'cell' within the map
 		float m_cellSize;
 
+		GridGraph m_graph;
+		unsigned int m_version;
+
+		// One bit per cell, set where the cell is walkable (bit id % 64 of word id / 64). This is built in every mode, and is the whole graph in the implicit ones.
+		std::vector<unsigned long long> m_walkable;
+
 		// From the tute: "The Node** variable nodes is essentially a dynamically allocated one dimensional array of Node pointers."
+		// Only the explicit graph has this array (it's nullptr otherwise).
 		Node** m_nodes;
 
+		// Where every Node on the map lives. The explicit graph's Nodes are made together in one block, and are freed together with it.
+		mutable NodeArena m_nodeArena;
+
+		// The implicit graphs only create a Node the first time somebody asks for it (GetNode, or a search returning a path through it).
+		// The lock lets searches on several threads create Nodes at the same time.
+		mutable std::unordered_map<int, Node*> m_lazyNodes;
+		mutable std::mutex m_lazyNodesLock;
+
+		// The map's edges, in compressed sparse row form.
+		// The edges leaving node id start at m_edgeOffsets[id] in m_edgeTargets (32-bit node ids) and m_edgeCosts, and there are m_edgeCounts[id] of them,
+		// so scanning a node's neighbours is one streaming read instead of a hop to each Node and then to its own vector of edges.
+		// Every cell has room for an edge to each of its neighbours on the grid, walls or not, so opening or closing a cell only rewrites the blocks of the cells around it.
+		std::vector<unsigned int> m_edgeOffsets;
+		std::vector<unsigned char> m_edgeCounts;
+		std::vector<unsigned int> m_edgeTargets;
+		std::vector<float> m_edgeCosts;
+
+		// The cost of stepping into each cell, indexed by node id. It stays empty (every cell costs 1) until SetTileCost gives a cell some other cost.
+		std::vector<float> m_tileCosts;
+		int m_weightedCells;
+
+		// The cells changed by the most recent edits, oldest first. Every edit adds one to the version, so the last entry was made at the current version.
+		std::deque<int> m_editLog;
+
+		// The centre of every cell, indexed by node id, kept apart from the edges so the searches can read them without touching the Nodes.
+		// The implicit graphs work the centres out from the id instead.
+		std::vector<glm::vec2> m_positions;
+
+		// Free every node and edge, ready for the map to be initialised again
+		void Clear();
+
+		// Give every walkable cell of the explicit graph its Node, at the centre in m_positions, all out of one block of the arena
+		void CreateNodes();
+
+		// For every cell of the explicit graph, the id of the nearest walkable cell counting steps along the grid (-1 if nothing is walkable), for GetClosestNode
+		std::vector<int> m_nearestWalkable;
+
+		// Fill m_nearestWalkable with a breadth first search from every walkable cell at once
+		void BuildNearestWalkable();
+
+		// Bring m_nearestWalkable up to date after the cell with the given id opened or closed, touching only the cells whose answer changes
+		void PatchNearestWalkable(int id, bool walkable);
+
+		// For every cell of the explicit graph, the connected component it belongs to (-1 for a wall): two cells have a path between them exactly when their labels match.
+		// Diagonal steps are only allowed where both cells beside them are open, so the 4-connected regions are the same for every graph mode.
+		std::vector<int> m_components;
+
+		// How many cells each component label has (0 for a label that's free to be handed out again), and the free labels
+		std::vector<int> m_componentSizes;
+		std::vector<int> m_freeComponents;
+
+		// Label every walkable cell of the explicit graph with a flood fill from each cell not labelled yet
+		void BuildComponents();
+
+		// Hand out a label for a new component of the given size, reusing a free one if there is one
+		int NewComponent(int size);
+
+		// Bring the labels up to date after the cell with the given id opened (joining the components around it) or closed (perhaps splitting its component in pieces)
+		void JoinComponents(int id);
+		void SplitComponent(int id, int label);
+
+		// Rewrite the block of edges leaving the cell at (x, y) from the walkable bits and tile costs around it (explicit graph only)
+		void BuildEdges(int x, int y);
+
+		// Bump the version and remember which cell changed
+		void RecordEdit(int id);
+
+#ifndef AIFG_HEADLESS
+		// What Draw and DrawPath keep from one frame to the next (defined in NodeMap.cpp, where raylib is included)
+		struct DrawCache;
+		std::unique_ptr<DrawCache> m_drawCache;
+#endif
+
 	public:
 		// Default constructor
 		NodeMap();
@@ -25,26 +128,456 @@ namespace AIForGames {
 		// Destructor
 		~NodeMap();
 
+		// A function to print the size of the map and the memory its graph takes up
 		void GetMapSize();
 
-		// A function to set the start/end position of the node map depending on which mouse button is pressed
+		// The bytes used by the nodes, edges and positions of the graph (not counting allocator overhead)
+		size_t GetMemoryUsage() const;
+
+		// A function to set the start/end position of the node map depending on which mouse button is pressed.
+		// Returns the walkable node nearest to the position (in steps along the grid), even for a click on a wall or off the edge of the map,
+		// and only returns nullptr if the map has no walkable cells at all. The explicit graph looks the answer up in a table kept up to date as tiles change;
+		// the implicit graphs keep no tables, so they search outwards from the cell instead.
 		Node* GetClosestNode(glm::vec2 worldPos);
 
 		// A function for the purposes of setting up a node map according to a vector of strings, called 'asciiMap', and a given size for each node to be
 		// From the tute: "In the Initialise function we will allocate this array to match the width and height of the map (determined by the vector of strings passed in) and fill it with either newly allocated Nodes or null pointers for each square on the grid."
-		void Initialise(std::vector<std::string> asciiMap, int cellSize);
+		// The graph mode picks between building every edge (Explicit) and storing nothing but a bit per cell (Implicit4 / Implicit8) for very large maps.
+		void Initialise(const std::vector<std::string>& asciiMap, int cellSize, GridGraph graph = GridGraph::Explicit);
+
+		// Setting up a node map one row at a time, for loaders that read the rows straight out of a file without making a string of each one (see MapLoader).
+		// BeginRows throws away the old map and sizes the new one, then each row from 0 to height - 1 is added (any row left out stays all walls), and EndRows builds the edges and the Nodes.
+		// A cell is walkable where walkableCodes[its character] is true. A row shorter than the width is padded with walls, and a longer one is cut off.
+		void BeginRows(int width, int height, int cellSize, GridGraph graph = GridGraph::Explicit);
+		void AddRow(int y, const char* row, int length, const bool* walkableCodes);
+		void EndRows();
+
+		GridGraph GetGraph() const {
+			return m_graph;
+		};
+
+		int GetWidth() const {
+			return m_width;
+		};
+
+		int GetHeight() const {
+			return m_height;
+		};
+
+		float GetCellSize() const {
+			return m_cellSize;
+		};
+
+		// Open or close the cell at (x, y) while the game runs, for doors and destructible walls. Only the edges to and from the cell are rewritten.
+		// Nodes are never freed until the map is initialised again, so a closed cell's Node stays valid for anyone still holding it (GetNode returns nullptr for it meanwhile).
+		// Neither this nor SetTileCost may be called while a search is running on another thread.
+		void SetTileWalkable(int x, int y, bool walkable);
+
+		// Set the cost of stepping into the cell at (x, y), which starts at 1 (a diagonal step costs sqrt(2) times as much).
+		// Costs below 1 are raised to 1, so the heuristics never overestimate.
+		void SetTileCost(int x, int y, float cost);
+
+		// The cost of stepping into the cell with the given node id
+		float GetTileCost(int id) const {
+			return m_tileCosts.empty() ? 1.0f : m_tileCosts[id];
+		};
+
+		// True while every cell still costs 1 to step into (Jump Point Search relies on this)
+		bool HasUniformCosts() const {
+			return m_weightedCells == 0;
+		};
+
+		// The cost of the edge from one cell to a neighbouring one it's joined to: the cost of stepping into the 'to' cell, times sqrt(2) for a diagonal step.
+		// Edges cost different amounts in each direction once tile costs differ, so searches that run backwards from the end (D* Lite, flow fields) use this to price the edge into a cell.
+		float GetStepCost(int fromId, int toId) const {
+			const bool diagonal = fromId % m_width != toId % m_width && fromId / m_width != toId / m_width;
+			return diagonal ? GetTileCost(toId) * 1.41421356f : GetTileCost(toId);
+		};
+
+		// Add the ids of the cells edited since the given version to the list, oldest first, so something built from the map can update just those.
+		// Returns false if that version is older than the edit log goes back (the map was initialised since, or there have been too many edits), and everything has to be rebuilt.
+		bool GetEditsSince(unsigned int version, std::vector<int>& cells) const;
+
+		// True if the cell is on the map and isn't a wall
+		bool IsWalkable(int x, int y) const {
+			if (x < 0 || x >= m_width || y < 0 || y >= m_height) {
+				return false;
+			}
+			int id = x + m_width * y;
+			return (m_walkable[id >> 6] >> (id & 63)) & 1;
+		};
+
+		// The connected component the cell with the given node id is in (-1 for a wall). Only the explicit graph keeps these labels, and everywhere else it's 0,
+		// as a label for every cell of a map too big for Nodes would cost four bytes for every bit the map keeps now.
+		int GetComponent(int id) const {
+			return m_components.empty() ? 0 : m_components[id];
+		};
+
+		// False when there's certainly no path between the two nodes, which the searches check before they start, rather than finding out by running out of nodes.
+		// Always true on the implicit graphs, where the searches still find out the slow way.
+		bool AreConnected(const Node* a, const Node* b) const {
+			return a != nullptr && b != nullptr && GetComponent(a->id) == GetComponent(b->id);
+		};
+
+		// How many separate walkable regions the map is in (0 for the implicit graphs, which don't keep count)
+		int GetComponentCount() const {
+			return (int)(m_componentSizes.size() - m_freeComponents.size());
+		};
+
+		// True if an agent can walk in a straight line from the centre of one cell to the centre of the other: every cell the line passes through is walkable,
+		// and where it passes exactly through the corner where four cells meet, both cells beside it are too (the same rule as a diagonal step on the 8-connected graph).
+		bool HasLineOfSight(int fromId, int toId) const;
 
 		// A function to return the Node* for a given pair of coordinates
 		Node* GetNode(int x, int y);
 
+		// A function to return the Node* with a given id (nullptr for a wall)
+		Node* GetNodeById(int id) const;
+
+		// The number of node ids on this map (every cell has one, walls included), for sizing a SearchContext
+		int GetNodeCount() const;
+
+#ifndef AIFG_HEADLESS
 		// A function for drawing the best path calculated by a Dijkstra search
 		void DrawPath(std::vector<Node*> dijkstraPath);
 
-		// A function to draw the map to the screen
+		// A function to draw the map to the screen.
+		// The walls, labels and edges are drawn into a texture the first time and again only when the map changes, so each frame just draws the texture.
 		void Draw();
+#endif
+
+		// A function to print the g scores of a path found by a search using the given context
+		void Print(std::vector<Node*> path, const SearchContext& context);
+
+		// The centre of the cell with the given node id
+		glm::vec2 GetPosition(int id) const {
+			if (m_graph == GridGraph::Explicit) {
+				return m_positions[id];
+			}
+			return glm::vec2(((float)(id % m_width) + 0.5f) * m_cellSize, ((float)(id / m_width) + 0.5f) * m_cellSize);
+		};
+
+		// Call visit(targetId, cost) for every edge leaving the given node
+		template<typename Visitor>
+		void ForEachNeighbour(int id, Visitor&& visit) const {
+			if (m_graph == GridGraph::Explicit) {
+				for (unsigned int edge = m_edgeOffsets[id], last = edge + m_edgeCounts[id]; edge < last; edge++) {
+					visit((int)m_edgeTargets[edge], m_edgeCosts[edge]);
+				}
+				return;
+			}
+
+			// The implicit graphs visit the neighbours in the same order as the explicit one stores them (x - 1, y - 1, x + 1, y + 1), so all three find the same 4-connected paths
+			int x = id % m_width;
+			int y = id / m_width;
+			bool left = IsWalkable(x - 1, y);
+			bool up = IsWalkable(x, y - 1);
+			bool right = IsWalkable(x + 1, y);
+			bool down = IsWalkable(x, y + 1);
+
+			if (left) visit(id - 1, GetTileCost(id - 1));
+			if (up) visit(id - m_width, GetTileCost(id - m_width));
+			if (right) visit(id + 1, GetTileCost(id + 1));
+			if (down) visit(id + m_width, GetTileCost(id + m_width));
+
+			if (m_graph == GridGraph::Implicit8) {
+				// A diagonal step needs both cells beside it to be open, so paths never cut across the corner of a wall
+				const float diagonalCost = 1.41421356f;
+				if (left && up && IsWalkable(x - 1, y - 1)) visit(id - m_width - 1, diagonalCost * GetTileCost(id - m_width - 1));
+				if (right && up && IsWalkable(x + 1, y - 1)) visit(id - m_width + 1, diagonalCost * GetTileCost(id - m_width + 1));
+				if (left && down && IsWalkable(x - 1, y + 1)) visit(id + m_width - 1, diagonalCost * GetTileCost(id + m_width - 1));
+				if (right && down && IsWalkable(x + 1, y + 1)) visit(id + m_width + 1, diagonalCost * GetTileCost(id + m_width + 1));
+			}
+		};
+
+		// Find the shortest path from the start node to the end node (empty if there isn't one).
+		// The map is never written to, so any number of searches can run over it at once as long as each has its own SearchContext.
+		std::vector<Node*> DijkstraSearch(Node* startNode, Node* endNode) const;
+		std::vector<Node*> DijkstraSearch(Node* startNode, Node* endNode, SearchContext& context) const;
+
+		// Run Dijkstra's algorithm from the start node until the open list runs out, leaving the shortest path tree in the context:
+		// context.GetPreviousNode(id) then leads back from any reachable node to the start.
+		void BuildShortestPathTree(Node* startNode, SearchContext& context) const;
+
+		// Run one Dijkstra search from every source node at once, for questions like "the nearest of these health packs" or "how far is every enemy",
+		// which would otherwise take one search per target over the same ground. It stops as soon as targetsNeeded of the targets have their
+		// shortest distance (every target if it's -1, the nearest one if it's 1), or when the open list runs out. Returns how many targets were reached.
+		// Afterwards context.GetGScore(target->id) is each reached target's distance from the nearest source (infinity for the rest),
+		// and GetSearchPath(target, context) builds its path from that source only for the targets that are wanted.
+		int MultiSourceSearch(const std::vector<Node*>& sources, const std::vector<Node*>& targets, SearchContext& context, int targetsNeeded = -1) const;
+
+		// The path the last search in the context found to the given node, from the source it was reached from (empty if it wasn't reached)
+		std::vector<Node*> GetSearchPath(Node* endNode, const SearchContext& context) const;
+
+		// Changes every time the map's cells change (each Initialise, and each tile edit), so anything built from the map can tell when it's out of date
+		unsigned int GetVersion() const {
+			return m_version;
+		};
+
+		// Turn a path of node ids into the Node pointers PathAgent follows
+		std::vector<Node*> ToNodePath(const std::vector<int>& ids) const;
+
+		// Find the shortest path with A*, using the Heuristic policy (see Heuristics.h) to guide the search towards the end node.
+		// DijkstraSearch is AStarSearch<ZeroHeuristic>. The work done is left in context.GetStats().
+		template<typename Heuristic>
+		std::vector<Node*> AStarSearch(Node* startNode, Node* endNode, SearchContext& context) const;
+
+		// Find the shortest path by searching forwards from the start node and backwards from the end node at the same time, which on a long query
+		// explores two small discs instead of one big one. Each half keeps its own scratch data, so it needs two contexts; the returned path is
+		// both halves joined where they meet, from start to end, ready for PathAgent::SetPath. The work done by both halves is left in forward.GetStats().
+		// BidirectionalSearch<ZeroHeuristic> is a bidirectional Dijkstra search. With a heuristic, each half is guided by the average of the
+		// estimates to its own goal and away from the other half's, so the two halves agree on when the shortest path has been found.
+		template<typename Heuristic>
+		std::vector<Node*> BidirectionalSearch(Node* startNode, Node* endNode, SearchContext& forward, SearchContext& backward) const;
+	};
+
+
+	template<typename Heuristic>
+	std::vector<Node*> NodeMap::AStarSearch(Node* startNode, Node* endNode, SearchContext& context) const {
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		SearchStats stats = SearchStats();
+
+		//	1	----------------------------------------------------------------------------------------------------
+		// Check the starting node position for existence on the map.
+		// A null end node means there's nothing to stop at, so the search runs until every reachable node has its shortest path (see BuildShortestPathTree).
+		if (startNode == nullptr) {
+			context.SetStats(stats);
+			return std::vector<Node*>();
+		}
+		const int startId = startNode->id;
+		const int endId = endNode != nullptr ? endNode->id : -1;
+		AIFG_TRACE_NODE(Begin, startId, 0.0f);
+
+		// An end node in another component can't be reached, and the search would only find that out after taking every node it can reach off the open list.
+		// The context still starts a new generation, so nothing is left reachable from the last search.
+		if (endNode != nullptr && !AreConnected(startNode, endNode)) {
+			context.Begin(GetNodeCount());
+			AIFG_TRACE_NODE(Exhausted, endId, 0.0f);
+			stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+			context.SetStats(stats);
+			return std::vector<Node*>();
+		}
+
+		//	2	----------------------------------------------------------------------------------------------------
+		// Start a new search generation, so nothing left in the context by an earlier search counts any more,
+		// then set the distance from the starting node to 0, with no previous node for the origin.
+		context.Begin(GetNodeCount());
+		context.SetScore(startId, 0.0f, -1);
+
+		// Edge costs count cells while the heuristics measure positions, so scale the estimates down by the cell size
+		const float heuristicScale = 1.0f / m_cellSize;
+		const glm::vec2 goal = GetPosition(endId >= 0 ? endId : startId);
+
+		//	3	----------------------------------------------------------------------------------------------------
+		// The open list is a priority queue (a heap) ordered by f score (g score plus the estimate of the distance still to go), so it never needs sorting.
+		// Membership of the open and closed lists is a flag in the context, so checking it costs the same however big the lists grow.
+		NodeQueue& openList = context.OpenList();
+		context.SetListState(startId, SearchContext::Open);
+		openList.Push(startId, Heuristic::Estimate(GetPosition(startId), goal) * heuristicScale);
+		stats.nodesOpened++;
+		AIFG_TRACE_EDGE(Push, startId, 0.0f);
+
+		//	4	----------------------------------------------------------------------------------------------------
+		// While the open list is not empty, search for the end node.
+		while (!openList.Empty()) {
+			//	4.1 - 4.4	----------------------------------------------------------------------------------------
+			// The front of the heap has the smallest f score, with ties going to whichever node was opened first. Take it off as the current node.
+			int currentNode = openList.Pop();
+			float currentG = context.GetGScore(currentNode);
+			AIFG_TRACE_NODE(Expand, currentNode, currentG);
+
+			// Check if the end node has been reached.
+			if (currentNode == endId) {
+				AIFG_TRACE_NODE(Found, currentNode, currentG);
+				break;
+			}
+
+			//	4.5	----------------------------------------------------------------------------------------------------
+			// Add the current node to the closed list (it has finished being processed)
+			context.SetListState(currentNode, SearchContext::Closed);
+			stats.nodesExpanded++;
+			AIFG_TRACE_NODE(Close, currentNode, currentG);
+
+			//	4.6	----------------------------------------------------------------------------------------------------
+			// Determine whether the targets of the current node's edges have already been processed or not.
+			ForEachNeighbour(currentNode, [&](int targetNode, float cost) {
+				SearchContext::ListState targetState = context.GetListState(targetNode);
+
+				// With a consistent heuristic a closed node already has its best g score, so it never needs reopening
+				if (targetState == SearchContext::Closed) {
+					return;
+				}
+
+				// Calculate a hypothetical g score (for comparison against the pre-existing g score)
+				float calcdG = currentG + cost;
+
+				// If this node is not already in the open list, give it this g score with the current node as its 'previous' node and add it for processing
+				if (targetState == SearchContext::Unvisited) {
+					context.SetScore(targetNode, calcdG, currentNode);
+					context.SetListState(targetNode, SearchContext::Open);
+					openList.Push(targetNode, calcdG + Heuristic::Estimate(GetPosition(targetNode), goal) * heuristicScale);
+					stats.nodesOpened++;
+					AIFG_TRACE_EDGE(Push, targetNode, calcdG);
+				}
+
+				// Otherwise if it is already open and this path to it is shorter, move it forward in the heap to match its new, lower score
+				else if (calcdG < context.GetGScore(targetNode)) {
+					context.SetScore(targetNode, calcdG, currentNode);
+					openList.DecreaseKey(targetNode, calcdG + Heuristic::Estimate(GetPosition(targetNode), goal) * heuristicScale);
+					AIFG_TRACE_EDGE(Relax, targetNode, calcdG);
+				}
+			});
+		}
+
+		//	5	----------------------------------------------------------------------------------------------------
+		// Create the path by following the previous nodes back from the end node (empty if the open list ran out first)
+		std::vector<Node*> path = ToNodePath(context.BuildPath(endId));
+		if (path.empty() && endNode != nullptr) {
+			AIFG_TRACE_NODE(Exhausted, endId, 0.0f);
+		}
+
+		stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		context.SetStats(stats);
+		return path;
+	};
+
+
+	template<typename Heuristic>
+	std::vector<Node*> NodeMap::BidirectionalSearch(Node* startNode, Node* endNode, SearchContext& forward, SearchContext& backward) const {
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		SearchStats stats = SearchStats();
+
+		//	1	----------------------------------------------------------------------------------------------------
+		// Both ends are needed, since the backward half starts from the end node
+		if (startNode == nullptr || endNode == nullptr) {
+			forward.SetStats(stats);
+			return std::vector<Node*>();
+		}
+		const int startId = startNode->id;
+		const int endId = endNode->id;
+		AIFG_TRACE_NODE(Begin, startId, 0.0f);
+
+		// Two halves in different components would never meet, however far each of them got
+		if (!AreConnected(startNode, endNode)) {
+			forward.Begin(GetNodeCount());
+			backward.Begin(GetNodeCount());
+			AIFG_TRACE_NODE(Exhausted, endId, 0.0f);
+			stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+			forward.SetStats(stats);
+			return std::vector<Node*>();
+		}
+
+		//	2	----------------------------------------------------------------------------------------------------
+		// Start a new generation in both contexts. The forward half's g scores count from the start node, and the backward half's count to the end node,
+		// so a node both halves have reached lies on a path of cost forward g + backward g.
+		forward.Begin(GetNodeCount());
+		backward.Begin(GetNodeCount());
+		forward.SetScore(startId, 0.0f, -1);
+		backward.SetScore(endId, 0.0f, -1);
+
+		// The forward half's estimate for a node is half of (distance to the end - distance to the start), and the backward half's is the same negated.
+		// Neither ever overestimates what an edge can save, and with them the search can stop as soon as the two smallest f scores add up to the best path found.
+		const float heuristicScale = 0.5f / m_cellSize;
+		const glm::vec2 startPosition = GetPosition(startId);
+		const glm::vec2 endPosition = GetPosition(endId);
+		auto forwardEstimate = [&](int id) {
+			const glm::vec2 position = GetPosition(id);
+			return (Heuristic::Estimate(position, endPosition) - Heuristic::Estimate(position, startPosition)) * heuristicScale;
+		};
+
+		//	3	----------------------------------------------------------------------------------------------------
+		// Each half has its own open list, seeded with its own starting node
+		NodeQueue& forwardOpenList = forward.OpenList();
+		NodeQueue& backwardOpenList = backward.OpenList();
+		forward.SetListState(startId, SearchContext::Open);
+		backward.SetListState(endId, SearchContext::Open);
+		forwardOpenList.Push(startId, forwardEstimate(startId));
+		backwardOpenList.Push(endId, -forwardEstimate(endId));
+		stats.nodesOpened += 2;
+		AIFG_TRACE_EDGE(Push, startId, 0.0f);
+		AIFG_TRACE_EDGE(Push, endId, 0.0f);
+
+		// The cheapest path found so far, and the node where its two halves meet
+		float bestCost = startId == endId ? 0.0f : std::numeric_limits<float>::infinity();
+		int meetingNode = startId == endId ? startId : -1;
+
+		//	4	----------------------------------------------------------------------------------------------------
+		// Expand one node at a time from whichever half has the smaller open list, until the halves can't find anything cheaper between them.
+		// If either open list runs out, every node on its side has its final g score, so any meeting there is to find has been found.
+		while (!forwardOpenList.Empty() && !backwardOpenList.Empty()) {
+			//	4.1	----------------------------------------------------------------------------------------------------
+			// Any path not yet found has to pass through a node still open in both halves, and so costs at least the two smallest f scores added together
+			if (forwardOpenList.TopKey() + backwardOpenList.TopKey() >= bestCost) {
+				break;
+			}
+
+			//	4.2	----------------------------------------------------------------------------------------------------
+			// Take the front node of the chosen half's open list, and add it to that half's closed list
+			const bool forwards = forwardOpenList.Size() <= backwardOpenList.Size();
+			SearchContext& side = forwards ? forward : backward;
+			const SearchContext& otherSide = forwards ? backward : forward;
+			NodeQueue& openList = side.OpenList();
+			const float estimateSign = forwards ? 1.0f : -1.0f;
+
+			int currentNode = openList.Pop();
+			float currentG = side.GetGScore(currentNode);
+			AIFG_TRACE_NODE(Expand, currentNode, currentG);
+			side.SetListState(currentNode, SearchContext::Closed);
+			stats.nodesExpanded++;
+			AIFG_TRACE_NODE(Close, currentNode, currentG);
+
+			//	4.3	----------------------------------------------------------------------------------------------------
+			// Relax the current node's edges exactly as AStarSearch does. The backward half walks the edges the wrong way round,
+			// so it prices each one as the step from the neighbour into the current node.
+			ForEachNeighbour(currentNode, [&](int targetNode, float cost) {
+				SearchContext::ListState targetState = side.GetListState(targetNode);
+				if (targetState == SearchContext::Closed) {
+					return;
+				}
+
+				float calcdG = currentG + (forwards ? cost : GetStepCost(targetNode, currentNode));
+				if (targetState == SearchContext::Unvisited) {
+					side.SetScore(targetNode, calcdG, currentNode);
+					side.SetListState(targetNode, SearchContext::Open);
+					openList.Push(targetNode, calcdG + estimateSign * forwardEstimate(targetNode));
+					stats.nodesOpened++;
+					AIFG_TRACE_EDGE(Push, targetNode, calcdG);
+				}
+				else if (calcdG < side.GetGScore(targetNode)) {
+					side.SetScore(targetNode, calcdG, currentNode);
+					openList.DecreaseKey(targetNode, calcdG + estimateSign * forwardEstimate(targetNode));
+					AIFG_TRACE_EDGE(Relax, targetNode, calcdG);
+				}
+				else {
+					return;
+				}
+
+				//	4.4	----------------------------------------------------------------------------------------------------
+				// If the other half has reached this node too, the two halves join here. Keep the join if it makes the cheapest path so far.
+				if (otherSide.GetListState(targetNode) != SearchContext::Unvisited && calcdG + otherSide.GetGScore(targetNode) < bestCost) {
+					bestCost = calcdG + otherSide.GetGScore(targetNode);
+					meetingNode = targetNode;
+				}
+			});
+		}
 
-		void Print(std::vector<Node*> path);
+		//	5	----------------------------------------------------------------------------------------------------
+		// Stitch the path together: the forward half's previous nodes lead back from the meeting node to the start,
+		// and the backward half's lead on from the meeting node to the end.
+		std::vector<int> ids;
+		if (meetingNode >= 0) {
+			ids = forward.BuildPath(meetingNode);
+			for (int id = backward.GetPreviousNode(meetingNode); id != -1; id = backward.GetPreviousNode(id)) {
+				ids.push_back(id);
+			}
+			AIFG_TRACE_NODE(Found, meetingNode, bestCost);
+		}
+		else {
+			AIFG_TRACE_NODE(Exhausted, endId, 0.0f);
+		}
 
-		static std::vector<Node*> DijkstraSearch(Node* startNode, Node* endNode);
+		stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		forward.SetStats(stats);
+		return ToNodePath(ids);
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,124 @@
+#include "NodeQueue.h"
+
+namespace AIForGames {
+	NodeQueue::NodeQueue() : m_pushCount(0) {};
+
+	NodeQueue::~NodeQueue() {};
+
+	bool NodeQueue::Before(const Entry& a, const Entry& b) {
+		// Lowest key first, then whichever node joined the queue first
+		if (a.key != b.key) {
+			return a.key < b.key;
+		}
+		return a.order < b.order;
+	};
+
+	void NodeQueue::Place(int index, const Entry& entry) {
+		m_heap[index] = entry;
+		m_slots[entry.id] = index;
+	};
+
+	void NodeQueue::SiftUp(int index) {
+		Entry entry = m_heap[index];
+
+		// Walk up the tree, pulling each parent that should come out later down into the hole
+		while (index > 0) {
+			int parent = (index - 1) / Arity;
+			if (!Before(entry, m_heap[parent])) {
+				break;
+			}
+			Place(index, m_heap[parent]);
+			index = parent;
+		}
+
+		Place(index, entry);
+	};
+
+	void NodeQueue::SiftDown(int index) {
+		Entry entry = m_heap[index];
+		int size = (int)m_heap.size();
+
+		while (true) {
+			// Find the child that should come out first
+			int firstChild = index * Arity + 1;
+			if (firstChild >= size) {
+				break;
+			}
+
+			int lastChild = firstChild + Arity < size ? firstChild + Arity : size;
+			int best = firstChild;
+			for (int child = firstChild + 1; child < lastChild; child++) {
+				if (Before(m_heap[child], m_heap[best])) {
+					best = child;
+				}
+			}
+
+			// Stop once the entry comes out before all of its children
+			if (!Before(m_heap[best], entry)) {
+				break;
+			}
+			Place(index, m_heap[best]);
+			index = best;
+		}
+
+		Place(index, entry);
+	};
+
+	bool NodeQueue::Empty() const {
+		return m_heap.empty();
+	};
+
+	int NodeQueue::Size() const {
+		return (int)m_heap.size();
+	};
+
+	void NodeQueue::Clear() {
+		m_heap.clear();
+		m_pushCount = 0;
+	};
+
+	void NodeQueue::Reserve(int nodeCount) {
+		if (nodeCount > (int)m_slots.size()) {
+			m_slots.resize(nodeCount);
+		}
+	};
+
+	void NodeQueue::Push(int id, float key) {
+		Entry entry;
+		entry.key = key;
+		entry.order = m_pushCount++;
+		entry.id = id;
+
+		m_heap.push_back(entry);
+		SiftUp((int)m_heap.size() - 1);
+	};
+
+	int NodeQueue::Top() const {
+		return m_heap.front().id;
+	};
+
+	float NodeQueue::TopKey() const {
+		return m_heap.front().key;
+	};
+
+	int NodeQueue::Pop() {
+		int top = m_heap.front().id;
+
+		// Move the last entry into the root and let it sink back to its place
+		Entry last = m_heap.back();
+		m_heap.pop_back();
+		if (!m_heap.empty()) {
+			Place(0, last);
+			SiftDown(0);
+		}
+
+		return top;
+	};
+
+	void NodeQueue::DecreaseKey(int id, float key) {
+		// The node keeps its original push order so ties still resolve the way they did when it was first queued
+		int index = m_slots[id];
+		m_heap[index].key = key;
+		SiftUp(index);
+	};
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <vector>
+
+namespace AIForGames {
+	// An indexed d-ary min-heap of node ids, used as the open list of a search.
+	// The queue remembers which heap slot every queued id sits in, so finding, removing and re-prioritising a node never needs a linear search.
+	// Nodes with equal keys come out in the order they were first pushed, which matches the order the old sorted vector gave them.
+	class NodeQueue
+	{
+		// The number of children per heap entry. Four keeps the tree shallow and the children of one entry on the same cache line.
+		static const int Arity = 4;
+
+		// A heap entry keeps a copy of its key so that sifting never has to look anything up by id
+		struct Entry {
+			float key;
+			unsigned int order;
+			int id;
+		};
+
+		std::vector<Entry> m_heap;
+
+		// The heap slot of each queued id (indexed by id, only meaningful while that id is in the queue)
+		std::vector<int> m_slots;
+
+		// Incremented on every push to give each node its place in the tie-break order
+		unsigned int m_pushCount;
+
+		// Returns true if entry a should come out of the queue before entry b
+		static bool Before(const Entry& a, const Entry& b);
+
+		// Move the entry at the given slot towards the root / the leaves until the heap order holds again
+		void SiftUp(int index);
+		void SiftDown(int index);
+
+		// Write an entry into a slot and remember where its id now lives
+		void Place(int index, const Entry& entry);
+
+	public:
+		NodeQueue();
+		~NodeQueue();
+
+		bool Empty() const;
+		int Size() const;
+
+		// Remove every entry, keeping the allocated memory for the next search
+		void Clear();
+
+		// Make room for ids up to nodeCount - 1, so pushes never have to grow the slot array
+		void Reserve(int nodeCount);
+
+		// Add an id to the queue with the given priority (lowest comes out first)
+		void Push(int id, float key);
+
+		// Return the id with the lowest key without removing it
+		int Top() const;
+
+		// The lowest key in the queue
+		float TopKey() const;
+
+		// Remove and return the id with the lowest key
+		int Pop();
+
+		// Re-position a queued id after its key has been lowered
+		void DecreaseKey(int id, float key);
+	};
+}
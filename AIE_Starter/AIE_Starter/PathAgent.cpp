@@ -1,27 +1,85 @@
 #include "PathAgent.h"
 #include "NodeMap.h"
+#include "HierarchicalMap.h"
+#include "AnyAngleSearch.h"
+#include "PathScheduler.h"
+#include "FlowFieldCache.h"
 #include <cmath>
+#ifndef AIFG_HEADLESS
 #include "raylib.h"
+#endif
 #include <iostream>
 
 namespace AIForGames {
-	PathAgent::PathAgent() {};
+	PathAgent::PathAgent() {
+		m_currentIndex = 0;
+		m_currentNode = nullptr;
+		m_map = nullptr;
+		m_hierarchy = nullptr;
+		m_waypointIndex = 0;
+		m_flowFields = nullptr;
+		m_flowGoal = nullptr;
+	};
 	PathAgent::~PathAgent() {};
 
 	std::vector<Node*> PathAgent::GetPath() {
 		return m_path;
 	}
 
+	void PathAgent::SetPath(const std::vector<Node*>& path) {
+		m_path = path;
+		m_currentIndex = 0;
+		m_hierarchy = nullptr;
+		m_waypoints.clear();
+		m_flowFields = nullptr;
+	};
+
+	void PathAgent::JoinPath(const std::vector<Node*>& path) {
+		// Idle, or still on the node the search started from: the path can be taken as it is
+		std::vector<Node*> joined;
+		for (size_t i = 0; i < path.size() && joined.empty(); i++) {
+			if (path[i] == m_currentNode) {
+				joined.assign(path.begin() + i, path.end());
+			}
+		}
+
+		// Otherwise the new path starts somewhere behind the agent on its old path, so retrace the old path back to it first
+		if (joined.empty() && !path.empty()) {
+			for (int i = m_currentIndex; i >= 0 && i < (int)m_path.size() && joined.empty(); i--) {
+				if (m_path[i] == path.front()) {
+					for (int j = m_currentIndex; j > i; j--) {
+						joined.push_back(m_path[j]);
+					}
+					joined.insert(joined.end(), path.begin(), path.end());
+				}
+			}
+		}
+
+		SetPath(joined.empty() ? path : joined);
+	};
+
+	bool PathAgent::IsMoving() {
+		return !m_path.empty();
+	};
+
 	void PathAgent::SetNode(Node* node) {
 		m_currentNode = node;
 		m_position.x = node->position.x;
 		m_position.y = node->position.y;
 	};
 
+	Node* PathAgent::GetCurrentNode() {
+		return m_currentNode;
+	};
+
 	void PathAgent::SetSpeed(int spd) {
 		m_speed = spd;
 	};
 
+	void PathAgent::SetMap(NodeMap* map) {
+		m_map = map;
+	};
+
 	void PathAgent::Update(float deltaTime) {
 		// 1: If the path is empty, Don't go anywhere, and empty the path so future updates do nothing.
 		if (m_path.empty()) {
@@ -35,8 +93,8 @@ namespace AIForGames {
 		// Distance to the next node = magnitude of the vector between the two nodes (they are both points)
 		// 2.a.i: Calculate the vector between the next node and current node
 
-		int xDistance = 0;
-		int yDistance = 0;
+		float xDistance = 0.0f;
+		float yDistance = 0.0f;
 
 		// If there's only one node traversal, then add the origin node to the queue so that the agent will traverse back to it in the circumstance where it has left its origin, and then needs to navigate back to it (otherwise its node destination and origin will be identical and it will just stop wherever it currently is, or produce other, weirder behaviour)
 		if (m_path.size() == 1) {
@@ -49,18 +107,20 @@ namespace AIForGames {
 		glm::vec2 directionVector = {xDistance, yDistance};
 
 		// 2.a.ii: Calculate the distance (the vector's magnitude [square root of its coordinates squared])
-		int distance = sqrt(
+		float distance = sqrt(
 			(directionVector.x * directionVector.x) +
 			(directionVector.y * directionVector.y));
 
 		// 2.b: UNIT VECTOR TO NEXT NODE
-		// 2.b.i: Calculate a unit vector by dividing the vector with its own magnitude
-		glm::vec2 unitVector;
-		unitVector.x = directionVector.x / distance;
-		unitVector.y = directionVector.y / distance;
+		// 2.b.i: Calculate a unit vector by dividing the vector with its own magnitude (an agent already standing on the node has no direction to go in)
+		glm::vec2 unitVector = { 0.0f, 0.0f };
+		if (distance > 0.0f) {
+			unitVector.x = directionVector.x / distance;
+			unitVector.y = directionVector.y / distance;
+		}
 		
 		// 2.b.ii: Subtract speed * deltaTime from the distance (how much we're going to move this frame)
-		int frameMoveTick = distance - (m_speed * deltaTime);
+		float frameMoveTick = distance - (m_speed * deltaTime);
 
 		// 2.b.iii: If distance is greater than zero, then this frame we're just moving towards the target node; add speed * deltaTime * unit vector to our position
 		if (frameMoveTick > 0) {
@@ -73,33 +133,35 @@ namespace AIForGames {
 			// 3.a.i: Add one to currentIndex.
 			m_currentIndex += 1;
 
-			std::vector<Node*>::iterator itr = find(m_path.begin(), m_path.end(), m_path[m_currentIndex]);
 			std::cout << "Passed node " << m_currentIndex << std::endl;
 
 
 			// 3.a.ii: If we've reached the end of our path...
-			if (*itr == m_path.back()) {
+			// (This goes by index rather than searching the path for the node, which was slow and got it wrong if a path ever visited a node twice)
+			if (m_currentIndex == (int)m_path.size() - 1) {
 				std::cout << "Path end reached." << std::endl;
 
 				// Snap to the final node...
 				SetNode(m_path.back());
-				// ... and empty the path so future updates do nothing.
+				// ... and empty the path so future updates do nothing (unless a hierarchical route has another segment to go, or a flow field has another step).
 				m_path.clear();
+				RefineNextSegment();
+				NextFlowStep();
 				return;
 			};
 
 			// 3.a.iii: If we have a next node...
-			if (itr != m_path.end()) {
+			if (m_currentIndex < (int)m_path.size() - 1) {
 				std::cout << "Path end not yet reached, continuing." << std::endl;
 				// Update the 'current' node
 				SetNode(m_path[m_currentIndex]);
 
-				// Then distance with the subtracted speed * deltaTime tells us how far we've overshot the node if we invert it.
-				int overshoot = (distance - (m_speed * deltaTime));
+				// Then speed * deltaTime with the distance subtracted tells us how far we've overshot the node.
+				float overshoot = (m_speed * deltaTime) - distance;
 
-				// Find the unit vector from our previous node to the new next node...
-				xDistance = m_path[m_currentIndex + 1]->position.x - m_path[m_currentIndex - 1]->position.x;
-				yDistance = m_path[m_currentIndex + 1]->position.y - m_path[m_currentIndex - 1]->position.y;
+				// Find the unit vector from the node we've just reached (where SetNode put us) to the new next node...
+				xDistance = m_path[m_currentIndex + 1]->position.x - m_path[m_currentIndex]->position.x;
+				yDistance = m_path[m_currentIndex + 1]->position.y - m_path[m_currentIndex]->position.y;
 
 				// Refresh vector
 				directionVector = { xDistance, yDistance };
@@ -110,8 +172,11 @@ namespace AIForGames {
 					(directionVector.y * directionVector.y));
 
 				// Refresh unit vector 
-				unitVector.x = directionVector.x / distance;
-				unitVector.y = directionVector.y / distance;
+				unitVector = { 0.0f, 0.0f };
+				if (distance > 0.0f) {
+					unitVector.x = directionVector.x / distance;
+					unitVector.y = directionVector.y / distance;
+				}
 
 				// ... and move along this vector by the overshoot distance from the previous next node.
 				m_position.x += overshoot * unitVector.x;
@@ -121,12 +186,80 @@ namespace AIForGames {
 	};
 
 	void PathAgent::GoToNode(Node* node) {
-		// Call the pathfinding function to make and store a path from the current node to the given destination
-		m_path = NodeMap::DijkstraSearch(m_currentNode, node);
+		GoToNode(node, m_searchContext);
+	};
+
+	void PathAgent::GoToNode(Node* node, SearchContext& context) {
+		// Call the pathfinding function to make and store a path from the current node to the given destination.
+		// A search with no end node would run over the whole map, so a missing destination just stops the agent.
+		m_path = node != nullptr ? m_map->DijkstraSearch(m_currentNode, node, context) : std::vector<Node*>();
 		// When we recalculate the path our next node is always the first one along the path, so we reset currentIndex to 0.
 		m_currentIndex = 0;
+		// A new path replaces any hierarchical route or flow field the agent was following
+		m_hierarchy = nullptr;
+		m_waypoints.clear();
+		m_flowFields = nullptr;
+	};
+
+	void PathAgent::GoToNode(Node* node, const AnyAngleSearch& search) {
+		// SetPath starts the agent at the front of the path and drops any route or flow field it was following
+		SetPath(search.FindPath(m_currentNode, node, m_searchContext));
+	};
+
+	void PathAgent::GoToNode(Node* node, PathScheduler& scheduler) {
+		scheduler.Submit(this, node);
+	};
+
+	void PathAgent::GoToNode(Node* node, const HierarchicalMap& hierarchy) {
+		m_flowFields = nullptr;
+		m_hierarchy = &hierarchy;
+		m_waypoints = hierarchy.FindAbstractPath(m_currentNode, node, m_searchContext);
+		m_waypointIndex = 0;
+		RefineNextSegment();
+	};
+
+	void PathAgent::RefineNextSegment() {
+		if (m_hierarchy == nullptr || m_waypointIndex + 1 >= (int)m_waypoints.size()) {
+			m_hierarchy = nullptr;
+			m_waypoints.clear();
+			m_path.clear();
+			return;
+		}
+
+		m_path = m_hierarchy->RefineSegment(m_waypoints[m_waypointIndex], m_waypoints[m_waypointIndex + 1], m_searchContext);
+		m_waypointIndex++;
+		m_currentIndex = 0;
+	};
+
+	void PathAgent::FollowFlowField(Node* node, FlowFieldCache& flowFields) {
+		m_hierarchy = nullptr;
+		m_waypoints.clear();
+		m_flowFields = &flowFields;
+		m_flowGoal = node;
+		NextFlowStep();
+	};
+
+	void PathAgent::NextFlowStep() {
+		if (m_flowFields == nullptr) {
+			return;
+		}
+
+		// One lookup in the shared field gives the next cell; the cache repairs the field first if the map has been edited
+		Node* next = m_flowFields->GetNextNode(m_currentNode, m_flowGoal);
+		if (next == nullptr) {
+			m_flowFields = nullptr;
+			m_flowGoal = nullptr;
+			m_path.clear();
+			return;
+		}
+
+		m_path.clear();
+		m_path.push_back(m_currentNode);
+		m_path.push_back(next);
+		m_currentIndex = 0;
 	};
 
+#ifndef AIFG_HEADLESS
 	void PathAgent::Draw() {
 		Color agentColour;
 
@@ -137,6 +270,7 @@ namespace AIForGames {
 		
 		DrawCircle((int)m_position.x, (int)m_position.y, 8, agentColour);
 	};
+#endif
 
 	void PathAgent::SetAgentCurrentNode(Node* node) {
 		m_currentNode = node;
@@ -2,8 +2,15 @@
 #include <glm/glm.hpp>
 //#include <vector>
 #include "Pathfinding.h"
+#include "SearchContext.h"
 
 namespace AIForGames {
+	class NodeMap;
+	class HierarchicalMap;
+	class FlowFieldCache;
+	class AnyAngleSearch;
+	class PathScheduler;
+
 	class PathAgent
 	{
 	private:
@@ -13,16 +20,59 @@ namespace AIForGames {
 		Node* m_currentNode;
 		float m_speed;
 
+		// The map the agent searches for its paths on
+		NodeMap* m_map;
+
+		// The agent's own search scratch data, reused by every GoToNode call that isn't handed a context
+		SearchContext m_searchContext;
+
+		// When following a hierarchical route, the waypoints still to come (m_path only holds the segment up to the next one)
+		const HierarchicalMap* m_hierarchy;
+		std::vector<int> m_waypoints;
+		int m_waypointIndex;
+
+		// Replace the path with the cell-by-cell path to the next waypoint, or drop the route if there are no waypoints left
+		void RefineNextSegment();
+
+		// When following a flow field, the cache holding it and the goal it leads to (m_path only holds the step to the next cell)
+		FlowFieldCache* m_flowFields;
+		Node* m_flowGoal;
+
+		// Replace the path with the flow field's next step from the current node, or stop following the field at the goal (or if the goal can't be reached)
+		void NextFlowStep();
+
 	public:
 		PathAgent();
 		~PathAgent();
 		
 		std::vector<Node*> GetPath();
+		// True while the agent has a path it hasn't reached the end of (without copying the path like GetPath does)
+		bool IsMoving();
+		// Follow a path found somewhere else (e.g. by a BatchPathSolver), starting from its first node
+		void SetPath(const std::vector<Node*>& path);
+		// Take over a path that was searched for while the agent carried on along its old one (e.g. by a PathScheduler), so the agent may be past its first node by now.
+		// The agent joins the new path at the node it last reached if the path goes through it, and otherwise goes back along its old path to where the new one starts.
+		void JoinPath(const std::vector<Node*>& path);
 		void SetNode(Node* node);
+		// The node the agent last reached (it's somewhere between this node and the next one on its path)
+		Node* GetCurrentNode();
 		void SetSpeed(int spd);
+		void SetMap(NodeMap* map);
 		void Update(float deltaTime);
 		void GoToNode(Node* node);
+		// Path to the node using a caller-owned search context (e.g. one shared by several agents on the same thread)
+		void GoToNode(Node* node, SearchContext& context);
+		// Path to the node with an any-angle search, which gives a path of just the corners, so the agent turns once per corner instead of at every cell
+		void GoToNode(Node* node, const AnyAngleSearch& search);
+		// Ask the scheduler for the path, a little of the search at a time over the next few frames, and keep following the old path until it's ready
+		void GoToNode(Node* node, PathScheduler& scheduler);
+		// Plan the route over a hierarchical map, and only find the cell-by-cell path for one segment of it at a time
+		void GoToNode(Node* node, const HierarchicalMap& hierarchy);
+		// Head for the node by following its flow field, one cell at a time, without a search of the agent's own. Agents sharing a goal share the field.
+		void FollowFlowField(Node* node, FlowFieldCache& flowFields);
+#ifndef AIFG_HEADLESS
 		void Draw();
+#endif
 		glm::vec2 GetAgentPosition();
 		void SetAgentCurrentNode(Node* node);
 	};
@@ -0,0 +1,173 @@
+#include "PathCache.h"
+#include <algorithm>
+
+namespace AIForGames {
+	PathCache::PathCache(const NodeMap& map, size_t maxPaths, size_t maxTrees, int treeThreshold) : m_map(map) {
+		m_maxPaths = maxPaths;
+		m_maxTrees = maxTrees;
+		m_treeThreshold = treeThreshold;
+		m_version = map.GetVersion();
+		m_stats = PathCacheStats();
+	};
+
+	PathCache::~PathCache() {};
+
+	void PathCache::CheckVersion() {
+		if (m_version != m_map.GetVersion()) {
+			m_paths.clear();
+			m_pathIndex.clear();
+			m_trees.clear();
+			m_treeIndex.clear();
+			m_startMisses.clear();
+			m_version = m_map.GetVersion();
+			m_stats.invalidations++;
+		}
+	};
+
+	void PathCache::StorePath(PairKey key, const std::vector<int>& path) {
+		// Another thread may have stored the same pair while we were searching
+		if (m_pathIndex.find(key) != m_pathIndex.end() || m_maxPaths == 0) {
+			return;
+		}
+
+		m_paths.push_front({ key, path });
+		m_pathIndex[key] = m_paths.begin();
+
+		if (m_paths.size() > m_maxPaths) {
+			m_pathIndex.erase(m_paths.back().key);
+			m_paths.pop_back();
+			m_stats.evictions++;
+		}
+	};
+
+	void PathCache::StoreTree(int start, std::vector<int>& previousNodes) {
+		if (m_treeIndex.find(start) != m_treeIndex.end() || m_maxTrees == 0) {
+			return;
+		}
+
+		m_trees.push_front(CachedTree());
+		m_trees.front().start = start;
+		m_trees.front().previousNodes.swap(previousNodes);
+		m_treeIndex[start] = m_trees.begin();
+		m_startMisses.erase(start);
+
+		if (m_trees.size() > m_maxTrees) {
+			m_treeIndex.erase(m_trees.back().start);
+			m_trees.pop_back();
+			m_stats.evictions++;
+		}
+	};
+
+	std::vector<Node*> PathCache::FindPath(Node* startNode, Node* endNode, SearchContext& context) {
+		if (startNode == nullptr || endNode == nullptr) {
+			return std::vector<Node*>();
+		}
+
+		const int start = startNode->id;
+		const int end = endNode->id;
+		const PairKey key = ((PairKey)(unsigned int)start << 32) | (unsigned int)end;
+		bool buildTree = false;
+
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			CheckVersion();
+
+			// 1: The exact pair has been asked for before
+			std::unordered_map<PairKey, std::list<CachedPath>::iterator>::iterator foundPath = m_pathIndex.find(key);
+			if (foundPath != m_pathIndex.end()) {
+				m_paths.splice(m_paths.begin(), m_paths, foundPath->second);
+				m_stats.pathHits++;
+				return m_map.ToNodePath(foundPath->second->path);
+			}
+
+			// 2: There's a tree from this start, so follow it back from the end
+			std::unordered_map<int, std::list<CachedTree>::iterator>::iterator foundTree = m_treeIndex.find(start);
+			if (foundTree != m_treeIndex.end()) {
+				m_trees.splice(m_trees.begin(), m_trees, foundTree->second);
+				m_stats.treeHits++;
+
+				const std::vector<int>& previousNodes = foundTree->second->previousNodes;
+				std::vector<int> path;
+				if (end == start || previousNodes[end] != -1) {
+					for (int node = end; node != -1; node = previousNodes[node]) {
+						path.push_back(node);
+					}
+					std::reverse(path.begin(), path.end());
+				}
+
+				StorePath(key, path);
+				return m_map.ToNodePath(path);
+			}
+
+			// 3: A miss. Once a start has missed often enough it's worth searching the whole map from it.
+			m_stats.misses++;
+			if (m_startMisses.size() > m_maxPaths) {
+				m_startMisses.clear();
+			}
+			buildTree = m_maxTrees > 0 && ++m_startMisses[start] >= m_treeThreshold;
+		}
+
+		// Search without holding the lock, so other threads can use the cache meanwhile
+		std::vector<int> path;
+		std::vector<int> previousNodes;
+		if (buildTree) {
+			m_map.BuildShortestPathTree(startNode, context);
+			path = context.BuildPath(end);
+
+			previousNodes.resize(m_map.GetNodeCount());
+			for (int id = 0; id < m_map.GetNodeCount(); id++) {
+				previousNodes[id] = context.GetPreviousNode(id);
+			}
+		}
+		else {
+			m_map.DijkstraSearch(startNode, endNode, context);
+			path = context.BuildPath(end);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+
+			// Anything searched on a map that has since changed isn't worth keeping
+			if (m_version == m_map.GetVersion()) {
+				StorePath(key, path);
+				if (buildTree) {
+					m_stats.treesBuilt++;
+					StoreTree(start, previousNodes);
+				}
+			}
+		}
+
+		return m_map.ToNodePath(path);
+	};
+
+	void PathCache::Clear() {
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_paths.clear();
+		m_pathIndex.clear();
+		m_trees.clear();
+		m_treeIndex.clear();
+		m_startMisses.clear();
+	};
+
+	PathCacheStats PathCache::GetStats() const {
+		std::lock_guard<std::mutex> lock(m_lock);
+		return m_stats;
+	};
+
+	void PathCache::ResetStats() {
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_stats = PathCacheStats();
+	};
+
+	size_t PathCache::GetMemoryUsage() const {
+		std::lock_guard<std::mutex> lock(m_lock);
+		size_t bytes = 0;
+		for (const CachedPath& cached : m_paths) {
+			bytes += sizeof(CachedPath) + cached.path.capacity() * sizeof(int);
+		}
+		for (const CachedTree& cached : m_trees) {
+			bytes += sizeof(CachedTree) + cached.previousNodes.capacity() * sizeof(int);
+		}
+		return bytes;
+	};
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "NodeMap.h"
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace AIForGames {
+	// How well a PathCache has been doing since it was made (or since ResetStats)
+	struct PathCacheStats {
+		// Queries answered straight from a stored (start, end) path
+		int pathHits;
+		// Queries answered by walking back through a stored shortest path tree
+		int treeHits;
+		// Queries that needed a search
+		int misses;
+		// Shortest path trees built (a start is promoted to a tree once it has missed often enough)
+		int treesBuilt;
+		// Entries thrown out to stay within the limits
+		int evictions;
+		// Times everything was thrown out because the map changed
+		int invalidations;
+	};
+
+	// Remembers searches on a NodeMap so repeated queries don't have to search again. There are two levels:
+	//   - (start, end) pairs keep the path found for them
+	//   - busy starts (spawn points, say) keep the whole shortest path tree from a full Dijkstra search, which answers a query to any end by following the previous nodes back
+	// Both are least-recently-used caches with a fixed number of entries. Everything is thrown out when the map's version changes.
+	// The cache is locked internally, so it can be shared by several threads; the searches themselves run outside the lock.
+	class PathCache
+	{
+		// A key for a (start, end) pair
+		typedef unsigned long long PairKey;
+
+		struct CachedPath {
+			PairKey key;
+			std::vector<int> path;
+		};
+
+		struct CachedTree {
+			int start;
+			// The previous node of every node id on the way back to the start (-1 for the start itself and unreachable nodes)
+			std::vector<int> previousNodes;
+		};
+
+		const NodeMap& m_map;
+		size_t m_maxPaths;
+		size_t m_maxTrees;
+		int m_treeThreshold;
+		unsigned int m_version;
+
+		// Most recently used at the front. The maps point into the lists so a hit can be moved to the front without a search.
+		std::list<CachedPath> m_paths;
+		std::unordered_map<PairKey, std::list<CachedPath>::iterator> m_pathIndex;
+		std::list<CachedTree> m_trees;
+		std::unordered_map<int, std::list<CachedTree>::iterator> m_treeIndex;
+
+		// How many times each start without a tree has missed
+		std::unordered_map<int, int> m_startMisses;
+
+		PathCacheStats m_stats;
+		mutable std::mutex m_lock;
+
+		// Throw everything out if the map has changed since it was cached (call with the lock held)
+		void CheckVersion();
+
+		void StorePath(PairKey key, const std::vector<int>& path);
+		void StoreTree(int start, std::vector<int>& previousNodes);
+
+	public:
+		// The cache keeps a reference to the map, so the map has to outlive it.
+		// A start is given a shortest path tree after treeThreshold misses from it.
+		PathCache(const NodeMap& map, size_t maxPaths = 4096, size_t maxTrees = 8, int treeThreshold = 2);
+		~PathCache();
+
+		// The shortest path from the start node to the end node (empty if there isn't one), from the cache when possible.
+		// The context is only used when a search is needed.
+		std::vector<Node*> FindPath(Node* startNode, Node* endNode, SearchContext& context);
+
+		// Forget everything cached (the counters are kept)
+		void Clear();
+
+		PathCacheStats GetStats() const;
+		void ResetStats();
+
+		// The bytes held by the cached paths and trees
+		size_t GetMemoryUsage() const;
+	};
+}
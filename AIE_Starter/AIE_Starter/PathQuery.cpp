@@ -0,0 +1,144 @@
+#include "PathQuery.h"
+#include "SearchTrace.h"
+#include <chrono>
+
+namespace AIForGames {
+	namespace {
+		// Reading the clock costs about as much as expanding a node, so a time limit is only checked once every this many nodes (must be a power of two)
+		const int clockCheckInterval = 32;
+	}
+
+	PathQuery::PathQuery(const NodeMap& map) : m_map(map), m_context(map.GetNodeCount()) {
+		m_status = Status::Idle;
+		m_startId = -1;
+		m_endId = -1;
+		m_mapVersion = 0;
+		m_stats = SearchStats();
+		m_slices = 0;
+	};
+
+	PathQuery::~PathQuery() {};
+
+	void PathQuery::Start(Node* startNode, Node* endNode) {
+		m_stats = SearchStats();
+		m_slices = 0;
+		m_startId = startNode != nullptr ? startNode->id : -1;
+		m_endId = endNode != nullptr ? endNode->id : -1;
+		Restart();
+	};
+
+	void PathQuery::Restart() {
+		m_mapVersion = m_map.GetVersion();
+
+		// The start or end may have been closed by the edit that made the search start again
+		Node* startNode = m_startId >= 0 ? m_map.GetNodeById(m_startId) : nullptr;
+		Node* endNode = m_endId >= 0 ? m_map.GetNodeById(m_endId) : nullptr;
+		if (startNode == nullptr || endNode == nullptr || !m_map.AreConnected(startNode, endNode)) {
+			m_status = Status::NoPath;
+			return;
+		}
+		AIFG_TRACE_NODE(Begin, m_startId, 0.0f);
+
+		// The same first steps as AStarSearch: a new generation, then the start node on the open list with a g score of 0
+		m_context.Begin(m_map.GetNodeCount());
+		m_context.SetScore(m_startId, 0.0f, -1);
+		m_context.SetListState(m_startId, SearchContext::Open);
+		m_context.OpenList().Push(m_startId, 0.0f);
+		m_stats.nodesOpened++;
+		AIFG_TRACE_EDGE(Push, m_startId, 0.0f);
+		m_status = Status::Searching;
+	};
+
+	void PathQuery::Cancel() {
+		m_status = Status::Idle;
+	};
+
+	int PathQuery::Step(int maxExpansions, double maxMicroseconds) {
+		if (m_status != Status::Searching) {
+			return 0;
+		}
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		m_slices++;
+
+		if (m_map.GetVersion() != m_mapVersion) {
+			Restart();
+			if (m_status != Status::Searching) {
+				return 0;
+			}
+		}
+
+		// The loop of AStarSearch with no heuristic, except that it can stop between any two nodes and pick up again next time from the same open list
+		NodeQueue& openList = m_context.OpenList();
+		int expanded = 0;
+		while (expanded < maxExpansions) {
+			if (openList.Empty()) {
+				m_status = Status::NoPath;
+				AIFG_TRACE_NODE(Exhausted, m_endId, 0.0f);
+				break;
+			}
+			if (maxMicroseconds > 0.0 && expanded > 0 && (expanded & (clockCheckInterval - 1)) == 0
+				&& std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count() >= maxMicroseconds) {
+				break;
+			}
+
+			int currentNode = openList.Pop();
+			float currentG = m_context.GetGScore(currentNode);
+			AIFG_TRACE_NODE(Expand, currentNode, currentG);
+
+			if (currentNode == m_endId) {
+				m_status = Status::Found;
+				AIFG_TRACE_NODE(Found, currentNode, currentG);
+				break;
+			}
+
+			m_context.SetListState(currentNode, SearchContext::Closed);
+			expanded++;
+			AIFG_TRACE_NODE(Close, currentNode, currentG);
+
+			m_map.ForEachNeighbour(currentNode, [&](int targetNode, float cost) {
+				SearchContext::ListState targetState = m_context.GetListState(targetNode);
+				if (targetState == SearchContext::Closed) {
+					return;
+				}
+
+				float calcdG = currentG + cost;
+				if (targetState == SearchContext::Unvisited) {
+					m_context.SetScore(targetNode, calcdG, currentNode);
+					m_context.SetListState(targetNode, SearchContext::Open);
+					openList.Push(targetNode, calcdG);
+					m_stats.nodesOpened++;
+					AIFG_TRACE_EDGE(Push, targetNode, calcdG);
+				}
+				else if (calcdG < m_context.GetGScore(targetNode)) {
+					m_context.SetScore(targetNode, calcdG, currentNode);
+					openList.DecreaseKey(targetNode, calcdG);
+					AIFG_TRACE_EDGE(Relax, targetNode, calcdG);
+				}
+			});
+		}
+
+		m_stats.nodesExpanded += expanded;
+		m_stats.milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		return expanded;
+	};
+
+	PathQuery::Status PathQuery::GetStatus() const {
+		return m_status;
+	};
+
+	bool PathQuery::IsDone() const {
+		return m_status == Status::Found || m_status == Status::NoPath;
+	};
+
+	std::vector<Node*> PathQuery::GetPath() const {
+		return m_status == Status::Found ? m_map.ToNodePath(m_context.BuildPath(m_endId)) : std::vector<Node*>();
+	};
+
+	const SearchStats& PathQuery::GetStats() const {
+		return m_stats;
+	};
+
+	int PathQuery::GetSliceCount() const {
+		return m_slices;
+	};
+}
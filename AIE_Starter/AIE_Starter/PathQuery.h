@@ -0,0 +1,70 @@
+#pragma once
+#include "NodeMap.h"
+#include "SearchContext.h"
+#include <vector>
+
+namespace AIForGames {
+	// A Dijkstra search that can be stopped part way and carried on later, so a long search can be spread over several frames instead of holding one up.
+	// The open list and scores stay in the query's own SearchContext between calls to Step, and the search finds exactly the path DijkstraSearch would.
+	// If the map is edited while the query is still searching, the next Step starts it again from scratch, since the scores it has so far may no longer be right.
+	class PathQuery
+	{
+	public:
+		enum class Status {
+			// Never started (or cancelled)
+			Idle,
+			// Waiting for more calls to Step
+			Searching,
+			// Done: GetPath has the path
+			Found,
+			// Done: there's no path from the start to the end
+			NoPath
+		};
+
+	private:
+		const NodeMap& m_map;
+		SearchContext m_context;
+		Status m_status;
+		int m_startId;
+		int m_endId;
+
+		// The map's version when the search began, to tell when it has been edited since
+		unsigned int m_mapVersion;
+
+		// The work done over every Step so far, and how many calls to Step it took
+		SearchStats m_stats;
+		int m_slices;
+
+		// Start the search over from the start node, with empty lists
+		void Restart();
+
+	public:
+		// The query keeps a reference to the map, so the map has to outlive it. Its SearchContext is sized for the map here, rather than in the middle of a frame.
+		PathQuery(const NodeMap& map);
+		~PathQuery();
+
+		// Begin a new search, throwing away any search already under way. A null node, or an end in another component of the map, is NoPath straight away.
+		void Start(Node* startNode, Node* endNode);
+
+		// Stop searching and go back to Idle
+		void Cancel();
+
+		// Carry on with the search, expanding at most maxExpansions nodes, and stopping early once maxMicroseconds have passed if that's more than zero
+		// (the clock is only read every few nodes, so the time can run over by a little). Returns how many nodes were expanded.
+		int Step(int maxExpansions, double maxMicroseconds = 0.0);
+
+		Status GetStatus() const;
+
+		// True once the search has finished, either way
+		bool IsDone() const;
+
+		// The path from start to end once the status is Found (empty otherwise)
+		std::vector<Node*> GetPath() const;
+
+		// The work done by every Step since Start: nodes expanded and opened, and the time spent searching (not counting the frames in between)
+		const SearchStats& GetStats() const;
+
+		// How many calls to Step the search has taken so far
+		int GetSliceCount() const;
+	};
+}
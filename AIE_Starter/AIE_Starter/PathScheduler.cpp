@@ -0,0 +1,136 @@
+#include "PathScheduler.h"
+#include "PathAgent.h"
+#include <chrono>
+
+namespace AIForGames {
+	PathScheduler::PathScheduler(const NodeMap& map, int maxActive) : m_map(map) {
+		m_maxActive = maxActive > 1 ? maxActive : 1;
+		for (int i = 0; i < m_maxActive; i++) {
+			m_spareQueries.emplace_back(new PathQuery(map));
+		}
+		m_nodesExpanded = 0;
+		m_pathsDelivered = 0;
+	};
+
+	PathScheduler::~PathScheduler() {};
+
+	void PathScheduler::Submit(PathAgent* agent, Node* endNode) {
+		// A request already being searched starts again from where the agent is now
+		for (Request& request : m_active) {
+			if (request.agent == agent) {
+				request.endNode = endNode;
+				request.query->Start(agent->GetCurrentNode(), endNode);
+				return;
+			}
+		}
+		for (Request& request : m_waiting) {
+			if (request.agent == agent) {
+				request.endNode = endNode;
+				return;
+			}
+		}
+
+		Request request;
+		request.agent = agent;
+		request.endNode = endNode;
+		m_waiting.push_back(std::move(request));
+	};
+
+	void PathScheduler::Cancel(PathAgent* agent) {
+		for (std::deque<Request>::iterator request = m_active.begin(); request != m_active.end(); ++request) {
+			if (request->agent == agent) {
+				request->query->Cancel();
+				m_spareQueries.push_back(std::move(request->query));
+				m_active.erase(request);
+				return;
+			}
+		}
+		for (std::deque<Request>::iterator request = m_waiting.begin(); request != m_waiting.end(); ++request) {
+			if (request->agent == agent) {
+				m_waiting.erase(request);
+				return;
+			}
+		}
+	};
+
+	void PathScheduler::ActivateWaiting() {
+		while ((int)m_active.size() < m_maxActive && !m_waiting.empty()) {
+			Request request = std::move(m_waiting.front());
+			m_waiting.pop_front();
+			request.query = std::move(m_spareQueries.back());
+			m_spareQueries.pop_back();
+			request.query->Start(request.agent->GetCurrentNode(), request.endNode);
+			m_active.push_back(std::move(request));
+		}
+	};
+
+	int PathScheduler::Update(int expansionBudget, double microsecondBudget) {
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		auto microsecondsLeft = [&]() {
+			return microsecondBudget - std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+		};
+
+		// Go round the active requests giving each an even share of what's left, as many times as it takes to use the budget up.
+		// A request that finishes early leaves the rest of its share for the next round, and its place to the next one waiting.
+		int delivered = 0;
+		ActivateWaiting();
+		while (!m_active.empty() && expansionBudget > 0 && (microsecondBudget <= 0.0 || microsecondsLeft() > 0.0)) {
+			size_t toServe = m_active.size();
+			int share = expansionBudget / (int)toServe;
+			share = share > MinimumShare ? share : MinimumShare;
+			double timeShare = microsecondBudget > 0.0 ? microsecondsLeft() / (double)toServe : 0.0;
+
+			for (; toServe > 0 && expansionBudget > 0; toServe--) {
+				Request request = std::move(m_active.front());
+				m_active.pop_front();
+
+				int expanded = request.query->Step(share < expansionBudget ? share : expansionBudget, timeShare);
+				expansionBudget -= expanded;
+				m_nodesExpanded += expanded;
+
+				if (request.query->IsDone()) {
+					request.agent->JoinPath(request.query->GetPath());
+					m_spareQueries.push_back(std::move(request.query));
+					delivered++;
+				}
+				else {
+					m_active.push_back(std::move(request));
+				}
+
+				if (microsecondBudget > 0.0 && microsecondsLeft() <= 0.0) {
+					break;
+				}
+			}
+			ActivateWaiting();
+		}
+
+		m_pathsDelivered += delivered;
+		return delivered;
+	};
+
+	int PathScheduler::GetPendingCount() const {
+		return (int)(m_active.size() + m_waiting.size());
+	};
+
+	bool PathScheduler::IsPending(const PathAgent* agent) const {
+		for (const Request& request : m_active) {
+			if (request.agent == agent) {
+				return true;
+			}
+		}
+		for (const Request& request : m_waiting) {
+			if (request.agent == agent) {
+				return true;
+			}
+		}
+		return false;
+	};
+
+	long long PathScheduler::GetNodesExpanded() const {
+		return m_nodesExpanded;
+	};
+
+	int PathScheduler::GetPathsDelivered() const {
+		return m_pathsDelivered;
+	};
+}
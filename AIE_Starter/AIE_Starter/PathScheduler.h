@@ -0,0 +1,74 @@
+#pragma once
+#include "PathQuery.h"
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace AIForGames {
+	class PathAgent;
+
+	// Shares one budget of search work per frame between every agent waiting for a path, so no click (or crowd of clicks) can hold a frame up.
+	// Each agent's request is a PathQuery; Update gives every active query an even share of the budget in turn, carries on round the queue with
+	// whatever the finished ones didn't use, and hands each path to its agent as soon as it's found. Agents keep following their old paths until then.
+	// Only so many queries are searched at once, since each has a SearchContext sized for the whole map (up to 32 bytes a cell) and more of them
+	// only fight over the cache. The rest wait their turn, first come first served, and start from wherever their agent has got to by then.
+	// Everything happens on the thread that calls Update (the game loop), so agents need no locking.
+	class PathScheduler
+	{
+		const NodeMap& m_map;
+
+		struct Request {
+			PathAgent* agent;
+			Node* endNode;
+			std::unique_ptr<PathQuery> query;
+		};
+
+		// The requests being searched, in the order they're next served (a request that's had its share goes to the back),
+		// and the requests waiting for a query of their own, oldest first
+		std::deque<Request> m_active;
+		std::deque<Request> m_waiting;
+		int m_maxActive;
+
+		// Start searching for waiting requests until there are as many active ones as allowed
+		void ActivateWaiting();
+
+		// The queries not searching for anyone at the moment. They're all made up front and reused, since each one's SearchContext is sized for the whole map.
+		std::vector<std::unique_ptr<PathQuery>> m_spareQueries;
+
+		// The work done since the scheduler was made
+		long long m_nodesExpanded;
+		int m_pathsDelivered;
+
+	public:
+		// No share is smaller than this many nodes, however many requests are waiting, so each call to Step does enough work to be worth making.
+		// With more requests than the budget can give this much to, the ones left over are served first next frame.
+		static const int MinimumShare = 32;
+
+		// The scheduler keeps a reference to the map, so the map has to outlive it. At most maxActive requests are searched at once,
+		// and the queries for them are all made here, so Update never has to allocate one mid-frame. Each costs up to 32 bytes a cell:
+		// 20 made here for its node records and heap slots, and 12 more for every node its open list holds at once.
+		PathScheduler(const NodeMap& map, int maxActive = 8);
+		~PathScheduler();
+
+		// Ask for a path from the node the agent is at (when the search starts) to the end node. An agent that's still waiting on an earlier request has it replaced,
+		// and keeps its place in the queue.
+		// The agent has to stay alive until its path is delivered or the request is cancelled.
+		void Submit(PathAgent* agent, Node* endNode);
+
+		// Forget the agent's request, if it has one
+		void Cancel(PathAgent* agent);
+
+		// Spend up to expansionBudget node expansions, and up to microsecondBudget of time if that's more than zero, on the pending requests,
+		// and hand every path found to its agent (an agent whose end can't be reached is given an empty path, which stops it). Returns how many paths were handed over.
+		int Update(int expansionBudget, double microsecondBudget = 0.0);
+
+		// How many requests are still searching or waiting to
+		int GetPendingCount() const;
+
+		// True if the agent is still waiting for its path
+		bool IsPending(const PathAgent* agent) const;
+
+		long long GetNodesExpanded() const;
+		int GetPathsDelivered() const;
+	};
+}
@@ -2,30 +2,17 @@
 
 namespace AIForGames {
 	// 
-	Node::Node() {};
+	Node::Node() {
+		id = -1;
+	};
 
 	// Overloaded struct constructor
 	Node::Node(float x, float y) {
 		position.x = x;
 		position.y = y;
-		previousNode = nullptr;
-		gScore = 0;
+		id = -1;
 	};
 
 	// Default destructor
 	Node::~Node() {};
-
-	void Node::ConnectTo(Node* other, float cost) {
-		connections.push_back(Edge(other, cost));
-	};
-
-
-	// Default constructor
-	Edge::Edge() {
-		targetNode = nullptr;
-		cost = 0;
-	};
-
-	// Default destructor
-	Edge::~Edge() {};
 }
\ No newline at end of file
@@ -5,34 +5,14 @@
 
 namespace AIForGames
 {
-    // ZORA: Default struct
-    struct Node;
-
-    // ZORA: Default struct for an edge of a directed flow graph (target node and cost to get there)
-    struct Edge {
-        Node* targetNode;
-        float cost;
-
-        // Default constructor
-        Edge();
-
-        // Overloaded constructor
-        // "provide an explicit default constructor to replace the implicit one that gets created if you dont specify any constructors."
-        // Define an overloaded constructor with the arguments _target and _cost, and assign _target to 'target', and _cost' to cost
-        Edge(Node* _target, float _cost) : targetNode(_target), cost(_cost) {}
-
-        // Default destructor
-        ~Edge();
-    };
-
-
-    // ZORA: Overloaded struct wth 2D position and vector of connecting edges
+    // ZORA: Overloaded struct wth 2D position
+    // A node's connecting edges are kept by its NodeMap (see NodeMap::ForEachNeighbour), in one contiguous block for the whole map
     struct Node {
         // Node variables 
         glm::vec2 position;
-        std::vector<Edge> connections;
-        int gScore;
-        Node* previousNode;
+
+        // The node's index on its map (x + width * y), used to find its edges in the NodeMap and its scratch data in a SearchContext
+        int id;
 
         // Default constructor
         Node();
@@ -42,8 +22,5 @@ namespace AIForGames
 
         // Default destructor
         ~Node();
-
-        // A function to add an Edge connecting to a given Node with a given cost
-        void ConnectTo(Node* other, float cost);
     };
 }
@@ -0,0 +1,109 @@
+#include "SearchContext.h"
+#include <algorithm>
+#include <limits>
+
+namespace AIForGames {
+	SearchContext::SearchContext() : m_generation(1) {
+		m_stats = SearchStats();
+	};
+
+	SearchContext::SearchContext(int nodeCount) : m_generation(1) {
+		m_records.resize(nodeCount, NodeRecord());
+		m_openList.Reserve(nodeCount);
+		m_stats = SearchStats();
+	};
+
+	SearchContext::~SearchContext() {};
+
+	void SearchContext::Begin(int nodeCount) {
+		if (nodeCount > (int)m_records.size()) {
+			m_records.resize(nodeCount, NodeRecord());
+			m_openList.Reserve(nodeCount);
+		}
+
+		m_generation++;
+
+		// Once in four billion searches the counter wraps around, and only then do the stamps need clearing
+		if (m_generation == 0) {
+			for (NodeRecord& record : m_records) {
+				record.generation = 0;
+			}
+			m_generation = 1;
+		}
+
+		m_openList.Clear();
+	};
+
+	NodeQueue& SearchContext::OpenList() {
+		return m_openList;
+	};
+
+	SearchContext::NodeRecord& SearchContext::Touch(int id) {
+		NodeRecord& record = m_records[id];
+
+		// A record left over from an earlier search gets wiped the first time this search touches it
+		if (record.generation != m_generation) {
+			record.generation = m_generation;
+			record.listState = Unvisited;
+			record.gScore = std::numeric_limits<float>::infinity();
+			record.previousNode = -1;
+		}
+		return record;
+	};
+
+	SearchContext::ListState SearchContext::GetListState(int id) const {
+		if (m_records[id].generation != m_generation) {
+			return Unvisited;
+		}
+		return m_records[id].listState;
+	};
+
+	void SearchContext::SetListState(int id, ListState state) {
+		Touch(id).listState = state;
+	};
+
+	float SearchContext::GetGScore(int id) const {
+		if (m_records[id].generation != m_generation) {
+			return std::numeric_limits<float>::infinity();
+		}
+		return m_records[id].gScore;
+	};
+
+	int SearchContext::GetPreviousNode(int id) const {
+		if (m_records[id].generation != m_generation) {
+			return -1;
+		}
+		return m_records[id].previousNode;
+	};
+
+	void SearchContext::SetScore(int id, float gScore, int previousNode) {
+		NodeRecord& record = Touch(id);
+		record.gScore = gScore;
+		record.previousNode = previousNode;
+	};
+
+	const SearchStats& SearchContext::GetStats() const {
+		return m_stats;
+	};
+
+	void SearchContext::SetStats(const SearchStats& stats) {
+		m_stats = stats;
+	};
+
+	std::vector<int> SearchContext::BuildPath(int endNode) const {
+		std::vector<int> path;
+
+		// An end node with no score this generation was never reached, so there is no path to follow back
+		if (endNode < 0 || GetGScore(endNode) == std::numeric_limits<float>::infinity()) {
+			return path;
+		}
+
+		for (int node = endNode; node != -1; node = GetPreviousNode(node)) {
+			path.push_back(node);
+		}
+
+		// The nodes were collected from the end backwards, so flip them to run from start to end
+		std::reverse(path.begin(), path.end());
+		return path;
+	};
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "NodeQueue.h"
+#include <vector>
+
+namespace AIForGames {
+	// How much work the last search on a context did, for comparing algorithms against each other
+	struct SearchStats {
+		// Nodes taken off the open list and had their edges followed
+		int nodesExpanded;
+		// Nodes added to the open list
+		int nodesOpened;
+		// Wall time of the whole query, in milliseconds
+		double milliseconds;
+	};
+
+	// All of the scratch data one search needs (g scores, previous nodes, open/closed flags and the open list), kept out of the shared Nodes.
+	// The data lives in flat arrays indexed by node id (Node::id). Each entry is stamped with the search 'generation' that last wrote it, and starting a new search
+	// just moves on to the next generation, so the old entries read as unvisited without ever being cleared.
+	// A context can be reused for any number of searches; give each thread (or each agent) its own and they can search the same NodeMap at the same time.
+	class SearchContext
+	{
+	public:
+		enum ListState : unsigned char { Unvisited, Open, Closed };
+
+	private:
+		struct NodeRecord {
+			unsigned int generation;
+			ListState listState;
+			float gScore;
+			int previousNode;
+		};
+
+		std::vector<NodeRecord> m_records;
+		unsigned int m_generation;
+		NodeQueue m_openList;
+		SearchStats m_stats;
+
+		// Return the node's record, wiping it first if it was left over from an earlier search
+		NodeRecord& Touch(int id);
+
+	public:
+		SearchContext();
+
+		// Size the scratch arrays for a map up front (NodeMap::GetNodeCount()), instead of letting them grow during the first search
+		SearchContext(int nodeCount);
+
+		~SearchContext();
+
+		// Start a new search over a map with the given number of node ids: every node reads as unvisited again and the open list is emptied.
+		// The arrays only grow here, never during the search itself.
+		void Begin(int nodeCount);
+
+		// The open list (priority queue) for the current search, which queues nodes by id
+		NodeQueue& OpenList();
+
+		ListState GetListState(int id) const;
+		void SetListState(int id, ListState state);
+
+		// The g score a node reached in the current search (infinity if the search hasn't reached it)
+		float GetGScore(int id) const;
+
+		// The id of the node the current search reached this node from (-1 for the start node or unreached nodes)
+		int GetPreviousNode(int id) const;
+
+		// Record a node as reached with the given g score from the given previous node
+		void SetScore(int id, float gScore, int previousNode);
+
+		// The work done by the last search that used this context
+		const SearchStats& GetStats() const;
+		void SetStats(const SearchStats& stats);
+
+		// Follow the previous nodes back from the end node and return the ids on the path from start to end (empty if the search never reached the end)
+		std::vector<int> BuildPath(int endNode) const;
+	};
+}
@@ -0,0 +1,147 @@
+#include "SearchTrace.h"
+#include <cstring>
+#include <fstream>
+
+namespace AIForGames {
+	namespace {
+		// Written at the start of every trace file, followed by the file format version and the event count
+		const char traceFileMagic[8] = { 'A', 'I', 'F', 'G', 'T', 'R', 'C', 'E' };
+		const unsigned int traceFileVersion = 1;
+
+		// The header's size, and each event's (written field by field, so no struct padding ends up in the file)
+		const std::streamoff traceHeaderBytes = sizeof(traceFileMagic) + sizeof(unsigned int) * 2;
+		const std::streamoff traceEventBytes = sizeof(unsigned int) + sizeof(unsigned char) + sizeof(int) + sizeof(float);
+	}
+
+	SearchTrace::SearchTrace() : m_next(0) {
+		m_slots = new Slot[Capacity];
+		Clear();
+	};
+
+	SearchTrace::~SearchTrace() {
+		delete[] m_slots;
+		m_slots = nullptr;
+	};
+
+	SearchTrace& SearchTrace::Global() {
+		static SearchTrace trace;
+		return trace;
+	};
+
+	void SearchTrace::Record(TraceEventType type, int nodeId, float value) {
+		unsigned int sequence = m_next.fetch_add(1, std::memory_order_relaxed);
+		Slot& slot = m_slots[sequence & (Capacity - 1)];
+
+		unsigned int valueBits;
+		std::memcpy(&valueBits, &value, sizeof(valueBits));
+
+		// Mark the slot as being written before touching the payload, so a reader can never pair an old header with a new payload
+		slot.header.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.payload.store(((unsigned long long)(unsigned int)nodeId << 32) | valueBits, std::memory_order_relaxed);
+		slot.header.store(((unsigned long long)sequence + 1) << 8 | (unsigned long long)type, std::memory_order_release);
+	};
+
+	void SearchTrace::Clear() {
+		for (unsigned int i = 0; i < Capacity; i++) {
+			m_slots[i].header.store(0, std::memory_order_relaxed);
+			m_slots[i].payload.store(0, std::memory_order_relaxed);
+		}
+		m_next.store(0, std::memory_order_release);
+	};
+
+	std::vector<TraceEvent> SearchTrace::Snapshot() const {
+		std::vector<TraceEvent> events;
+
+		unsigned int next = m_next.load(std::memory_order_acquire);
+		unsigned int first = next > Capacity ? next - Capacity : 0;
+		events.reserve(next - first);
+
+		for (unsigned int sequence = first; sequence != next; sequence++) {
+			const Slot& slot = m_slots[sequence & (Capacity - 1)];
+
+			// Read the header either side of the payload; if it changed, or belongs to another lap of the ring, the event isn't usable
+			unsigned long long header = slot.header.load(std::memory_order_acquire);
+			unsigned long long payload = slot.payload.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (header != slot.header.load(std::memory_order_relaxed) || (header >> 8) != (unsigned long long)sequence + 1) {
+				continue;
+			}
+
+			TraceEvent event;
+			event.sequence = sequence;
+			event.type = (TraceEventType)(header & 0xff);
+			event.nodeId = (int)(unsigned int)(payload >> 32);
+			unsigned int valueBits = (unsigned int)payload;
+			std::memcpy(&event.value, &valueBits, sizeof(valueBits));
+			events.push_back(event);
+		}
+
+		return events;
+	};
+
+	bool SearchTrace::Save(const char* fileName, const std::vector<TraceEvent>& events) {
+		std::ofstream file(fileName, std::ios::binary);
+		if (!file) {
+			return false;
+		}
+
+		unsigned int count = (unsigned int)events.size();
+		file.write(traceFileMagic, sizeof(traceFileMagic));
+		file.write((const char*)&traceFileVersion, sizeof(traceFileVersion));
+		file.write((const char*)&count, sizeof(count));
+
+		// Each event is written field by field (traceEventBytes, 13 bytes)
+		for (const TraceEvent& event : events) {
+			unsigned char type = (unsigned char)event.type;
+			file.write((const char*)&event.sequence, sizeof(event.sequence));
+			file.write((const char*)&type, sizeof(type));
+			file.write((const char*)&event.nodeId, sizeof(event.nodeId));
+			file.write((const char*)&event.value, sizeof(event.value));
+		}
+
+		return (bool)file;
+	};
+
+	bool SearchTrace::Load(const char* fileName, std::vector<TraceEvent>& events) {
+		std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+		if (!file) {
+			return false;
+		}
+		const std::streamoff fileSize = file.tellg();
+		file.seekg(0);
+
+		char magic[sizeof(traceFileMagic)];
+		unsigned int version = 0;
+		unsigned int count = 0;
+		file.read(magic, sizeof(magic));
+		file.read((char*)&version, sizeof(version));
+		file.read((char*)&count, sizeof(count));
+		if (!file || std::memcmp(magic, traceFileMagic, sizeof(magic)) != 0 || version != traceFileVersion) {
+			return false;
+		}
+
+		// A truncated or corrupt file can claim more events than it holds, so the count is checked against the file's size before anything is reserved for them
+		if (fileSize < traceHeaderBytes || (std::streamoff)count > (fileSize - traceHeaderBytes) / traceEventBytes) {
+			return false;
+		}
+
+		events.clear();
+		events.reserve(count);
+		for (unsigned int i = 0; i < count; i++) {
+			TraceEvent event;
+			unsigned char type = 0;
+			file.read((char*)&event.sequence, sizeof(event.sequence));
+			file.read((char*)&type, sizeof(type));
+			file.read((char*)&event.nodeId, sizeof(event.nodeId));
+			file.read((char*)&event.value, sizeof(event.value));
+			if (!file) {
+				return false;
+			}
+			event.type = (TraceEventType)type;
+			events.push_back(event);
+		}
+
+		return true;
+	};
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <vector>
+
+// The search trace level is chosen at compile time (the Debug configurations define it in the project settings):
+//   0 - off: the AIFG_TRACE macros expand to nothing, so searches carry no tracing code at all
+//   1 - one event per node: search begin, node expanded, node closed, end found / open list exhausted
+//   2 - also one event per edge: node pushed onto the open list, open node relaxed to a lower g score
+#ifndef AIFG_TRACE_LEVEL
+#define AIFG_TRACE_LEVEL 0
+#endif
+
+namespace AIForGames {
+	// The steps of the search narrative, in the order a search produces them
+	enum class TraceEventType : unsigned char {
+		Begin,		// Steps 1-3: a search started at node (value is unused: a float can't hold every node id of a large map exactly)
+		Expand,		// Step 4.2: node taken off the front of the open list (value is its g score)
+		Close,		// Step 4.5: node added to the closed list
+		Push,		// Step 4.6.2.2a: node added to the open list (value is its g score)
+		Relax,		// Step 4.6.2.2b: open node reached by a shorter path (value is its new g score)
+		Found,		// Step 4.3a: the end node was reached (value is the path's g score)
+		Exhausted	// The open list ran out without reaching the end node (or the end node was in another component, so the search never started)
+	};
+
+	// One recorded event. 'sequence' counts every event ever recorded, so gaps show where the ring buffer overwrote older events.
+	struct TraceEvent {
+		unsigned int sequence;
+		TraceEventType type;
+		int nodeId;
+		float value;
+	};
+
+	// A fixed-size, lock-free ring buffer of search events, 16 bytes per event.
+	// Any number of threads can record at once: each claims a slot with one atomic add and publishes it by storing the slot's header last.
+	// When the buffer is full the oldest events are overwritten. Snapshot() copies out whatever complete events are left, oldest first.
+	class SearchTrace
+	{
+	public:
+		// Must be a power of two
+		static const unsigned int Capacity = 1u << 16;
+
+	private:
+		// The header packs (sequence + 1) above the event type, and is zero while the slot is being written.
+		// The payload packs the node id and the value's bits.
+		struct Slot {
+			std::atomic<unsigned long long> header;
+			std::atomic<unsigned long long> payload;
+		};
+
+		std::atomic<unsigned int> m_next;
+		Slot* m_slots;
+
+	public:
+		SearchTrace();
+		~SearchTrace();
+
+		// The buffer the AIFG_TRACE macros record into
+		static SearchTrace& Global();
+
+		void Record(TraceEventType type, int nodeId, float value);
+
+		// Forget every recorded event
+		void Clear();
+
+		// Copy out the recorded events, oldest first. Events still being written by another thread are skipped.
+		std::vector<TraceEvent> Snapshot() const;
+
+		// Write events to / read events from a binary trace file (a small header followed by the raw events)
+		static bool Save(const char* fileName, const std::vector<TraceEvent>& events);
+		static bool Load(const char* fileName, std::vector<TraceEvent>& events);
+	};
+}
+
+#if AIFG_TRACE_LEVEL >= 1
+#define AIFG_TRACE_NODE(type, nodeId, value) ::AIForGames::SearchTrace::Global().Record(::AIForGames::TraceEventType::type, (nodeId), (float)(value))
+#else
+#define AIFG_TRACE_NODE(type, nodeId, value) ((void)0)
+#endif
+
+#if AIFG_TRACE_LEVEL >= 2
+#define AIFG_TRACE_EDGE(type, nodeId, value) ::AIForGames::SearchTrace::Global().Record(::AIForGames::TraceEventType::type, (nodeId), (float)(value))
+#else
+#define AIFG_TRACE_EDGE(type, nodeId, value) ((void)0)
+#endif
@@ -0,0 +1,218 @@
+#include "Simulation.h"
+#include "Benchmark.h"
+#include "MapLoader.h"
+#include "NodeMap.h"
+#include "PathAgent.h"
+#include "SearchContext.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace AIForGames {
+	namespace {
+		typedef chrono::steady_clock Clock;
+
+		// Every tick is the same length, so a run never depends on how fast the machine is
+		const float tickLength = 1.0f / 60.0f;
+		const int cellSize = 50;
+
+		// Read scripted goals, one "x y" cell per line. Cells that are walls or off the map are left out.
+		bool LoadGoals(const string& fileName, NodeMap& map, vector<Node*>& goals) {
+			ifstream file(fileName);
+			if (!file) {
+				return false;
+			}
+
+			string line;
+			while (getline(file, line)) {
+				istringstream cell(line);
+				int x = 0;
+				int y = 0;
+				if (!(cell >> x >> y)) {
+					continue;
+				}
+				Node* node = x >= 0 && x < map.GetWidth() && y >= 0 && y < map.GetHeight() ? map.GetNode(x, y) : nullptr;
+				if (node != nullptr) {
+					goals.push_back(node);
+				}
+				else {
+					cout << "Skipping goal " << x << " " << y << ", which isn't an open cell on the map" << endl;
+				}
+			}
+			return true;
+		};
+
+		// FNV-1a over the exact bits of every position, so two runs only match if every agent ended up on exactly the same float
+		uint64_t Checksum(vector<PathAgent>& agents) {
+			uint64_t hash = 14695981039346656037ull;
+			for (PathAgent& agent : agents) {
+				glm::vec2 position = agent.GetAgentPosition();
+				uint32_t bits[2];
+				memcpy(&bits[0], &position.x, sizeof(float));
+				memcpy(&bits[1], &position.y, sizeof(float));
+				for (uint32_t word : bits) {
+					for (int byte = 0; byte < 4; byte++) {
+						hash ^= (word >> (8 * byte)) & 0xff;
+						hash *= 1099511628211ull;
+					}
+				}
+			}
+			return hash;
+		};
+
+		// The latency that the given fraction of queries came in under
+		double Percentile(const vector<double>& sortedLatencies, double fraction) {
+			if (sortedLatencies.empty()) {
+				return 0.0;
+			}
+			size_t index = (size_t)(fraction * sortedLatencies.size());
+			return sortedLatencies[index < sortedLatencies.size() ? index : sortedLatencies.size() - 1];
+		};
+	}
+
+	int RunSimulation(int argc, char* argv[]) {
+		string mapFile;
+		string goalFile;
+		int size = 256;
+		int agentCount = 1000;
+		int tickCount = 1000;
+		unsigned int seed = 1;
+
+		for (int i = 1; i < argc; i++) {
+			string option = argv[i];
+			bool hasValue = i + 1 < argc;
+			if (option == "--headless") {
+				continue;
+			}
+			else if (option == "--map" && hasValue) {
+				mapFile = argv[++i];
+			}
+			else if (option == "--goals" && hasValue) {
+				goalFile = argv[++i];
+			}
+			else if (option == "--size" && hasValue) {
+				size = atoi(argv[++i]);
+			}
+			else if (option == "--agents" && hasValue) {
+				agentCount = atoi(argv[++i]);
+			}
+			else if (option == "--ticks" && hasValue) {
+				tickCount = atoi(argv[++i]);
+			}
+			else if (option == "--seed" && hasValue) {
+				seed = (unsigned int)strtoul(argv[++i], nullptr, 10);
+			}
+			else {
+				cout << "Unknown option " << option << " (see Simulation.h for the options)" << endl;
+				return 1;
+			}
+		}
+		if (size < 2 || agentCount < 1 || tickCount < 0) {
+			cout << "The grid size needs to be at least 2, and there needs to be at least one agent" << endl;
+			return 1;
+		}
+
+		// 1: The map, loaded or generated
+		NodeMap map;
+		if (!mapFile.empty()) {
+			MapLoader loader;
+			if (!loader.Load(mapFile, map, cellSize)) {
+				cout << loader.GetError() << endl;
+				return 1;
+			}
+			if (loader.GetMalformedRowCount() > 0) {
+				cout << mapFile << " has " << loader.GetMalformedRowCount() << " malformed rows, starting at row " << loader.GetMalformedRows()[0] << " (their bad cells are walls)" << endl;
+			}
+		}
+		else {
+			map.Initialise(MakeOpenGrid(size, seed), cellSize);
+		}
+
+		vector<Node*> openNodes;
+		for (int id = 0; id < map.GetNodeCount(); id++) {
+			if (map.GetNodeById(id) != nullptr) {
+				openNodes.push_back(map.GetNodeById(id));
+			}
+		}
+		if (openNodes.empty()) {
+			cout << "The map has no open cells to put agents on" << endl;
+			return 1;
+		}
+
+		vector<Node*> scriptedGoals;
+		if (!goalFile.empty() && (!LoadGoals(goalFile, map, scriptedGoals) || scriptedGoals.empty())) {
+			cout << "Could not read any goals from " << goalFile << endl;
+			return 1;
+		}
+
+		// 2: The agents, on seeded-random open cells. Goals come from the script in order, or from the same random sequence.
+		mt19937 random(seed);
+		size_t nextScriptedGoal = 0;
+		auto nextGoal = [&]() {
+			if (!scriptedGoals.empty()) {
+				return scriptedGoals[nextScriptedGoal++ % scriptedGoals.size()];
+			}
+			return openNodes[random() % openNodes.size()];
+		};
+
+		vector<PathAgent> agents(agentCount);
+		for (PathAgent& agent : agents) {
+			agent.SetMap(&map);
+			agent.SetNode(openNodes[random() % openNodes.size()]);
+			agent.SetSpeed(2 * cellSize);
+		}
+
+		cout << "Headless simulation: " << map.GetWidth() << "x" << map.GetHeight() << (mapFile.empty() ? " generated" : " loaded") << " map, "
+			<< agentCount << " agents, " << tickCount << " ticks, " << (scriptedGoals.empty() ? "random" : "scripted") << " goals, seed " << seed << endl;
+
+		// 3: Step the fixed ticks. An agent with nowhere left to go asks for a path to its next goal before it moves, and each of those searches is timed on its own.
+		SearchContext context(map.GetNodeCount());
+		vector<double> latencies;
+		int failedQueries = 0;
+		double queryMs = 0.0;
+
+		Clock::time_point start = Clock::now();
+		{
+			// PathAgent narrates every node it passes
+			MuteConsole mute;
+			for (int tick = 0; tick < tickCount; tick++) {
+				for (PathAgent& agent : agents) {
+					if (!agent.IsMoving()) {
+						Node* goal = nextGoal();
+						Clock::time_point queryStart = Clock::now();
+						agent.GoToNode(goal, context);
+						double milliseconds = chrono::duration<double, milli>(Clock::now() - queryStart).count();
+
+						latencies.push_back(milliseconds);
+						queryMs += milliseconds;
+						failedQueries += !agent.IsMoving();
+					}
+					agent.Update(tickLength);
+				}
+			}
+		}
+		double totalMs = chrono::duration<double, milli>(Clock::now() - start).count();
+
+		// 4: Report
+		sort(latencies.begin(), latencies.end());
+		cout << fixed << setprecision(1);
+		cout << "Ticks per second:   " << (totalMs > 0.0 ? tickCount / (totalMs / 1000.0) : 0.0) << " (" << totalMs << " ms in total)" << endl;
+		cout << "Queries per second: " << (queryMs > 0.0 ? latencies.size() / (queryMs / 1000.0) : 0.0) << " (" << latencies.size() << " queries, " << failedQueries << " without a path)" << endl;
+		cout << setprecision(4);
+		cout << "Query latency:      p50 " << Percentile(latencies, 0.5) << " ms, p99 " << Percentile(latencies, 0.99) << " ms" << endl;
+		cout << "Position checksum:  " << hex << setw(16) << setfill('0') << Checksum(agents) << dec << setfill(' ') << endl;
+
+		return 0;
+	};
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+namespace AIForGames {
+	// A headless run of the same NodeMap and PathAgent code as the demo: no window, no drawing and no frame rate cap, so it can run on a build server.
+	// Run with "AIE_Starter.exe --headless [options]":
+	//   --map <file>     an ascii map in the same '0' / '1' format as main uses, a Moving AI .map file, or a MapSnapshot (otherwise a seeded open grid is generated)
+	//   --size <n>       the width and height of the generated grid (256)
+	//   --agents <n>     how many agents to spawn (1000)
+	//   --ticks <n>      how many fixed 1/60 second ticks to step (1000)
+	//   --seed <n>       seeds the generated grid, the spawn points and the random goals (1)
+	//   --goals <file>   scripted goals, one "x y" cell per line, handed out in order to each agent that needs a new goal (otherwise goals are seeded-random)
+	// Every agent heads for a goal, and is given the next one as soon as it arrives. At the end it prints ticks per second, queries per second,
+	// the p50 / p99 query latency, and a checksum of every agent's final position: the same options on the same build always give the same checksum.
+	//
+	// Defining AIFG_HEADLESS compiles every Draw function and the window out, so the project builds without raylib (glm is still needed), and main always runs this.
+	// On Linux, for example: g++ -std=c++14 -O2 -pthread -DAIFG_HEADLESS -I<path to glm> *.cpp -o aifg_headless
+	int RunSimulation(int argc, char* argv[]);
+}
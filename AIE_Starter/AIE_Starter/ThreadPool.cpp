@@ -0,0 +1,124 @@
+#include "ThreadPool.h"
+
+namespace AIForGames {
+	ThreadPool::ThreadPool(int threadCount) : m_queued(0), m_pending(0), m_nextQueue(0) {
+		if (threadCount <= 0) {
+			threadCount = (int)std::thread::hardware_concurrency();
+		}
+		if (threadCount <= 0) {
+			threadCount = 1;
+		}
+
+		m_stopping = false;
+		for (int i = 0; i < threadCount; i++) {
+			m_queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+		}
+		for (int i = 0; i < threadCount; i++) {
+			m_threads.push_back(std::thread(&ThreadPool::WorkerLoop, this, i));
+		}
+	};
+
+	ThreadPool::~ThreadPool() {
+		Wait();
+		{
+			std::lock_guard<std::mutex> lock(m_stateLock);
+			m_stopping = true;
+		}
+		m_workAvailable.notify_all();
+
+		for (std::thread& thread : m_threads) {
+			thread.join();
+		}
+	};
+
+	int ThreadPool::GetThreadCount() const {
+		return (int)m_threads.size();
+	};
+
+	void ThreadPool::Submit(Task task) {
+		// Count the task as pending before any worker can see it, so it can never finish before it has been counted.
+		// New tasks are dealt out to the workers in turn; stealing takes care of any imbalance after that.
+		m_pending++;
+		WorkerQueue& queue = *m_queues[m_nextQueue++ % m_queues.size()];
+		{
+			std::lock_guard<std::mutex> lock(queue.lock);
+			queue.tasks.push_back(std::move(task));
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_stateLock);
+			m_queued++;
+		}
+		m_workAvailable.notify_one();
+	};
+
+	void ThreadPool::Submit(std::vector<Task>& tasks) {
+		m_pending += (int)tasks.size();
+		for (size_t i = 0; i < tasks.size(); i++) {
+			WorkerQueue& queue = *m_queues[(m_nextQueue + i) % m_queues.size()];
+			std::lock_guard<std::mutex> lock(queue.lock);
+			queue.tasks.push_back(std::move(tasks[i]));
+		}
+		m_nextQueue += (unsigned int)tasks.size();
+		{
+			std::lock_guard<std::mutex> lock(m_stateLock);
+			m_queued += (int)tasks.size();
+		}
+		m_workAvailable.notify_all();
+		tasks.clear();
+	};
+
+	void ThreadPool::Wait() {
+		std::unique_lock<std::mutex> lock(m_stateLock);
+		m_idle.wait(lock, [this]() { return m_pending == 0; });
+	};
+
+	bool ThreadPool::TryTake(int worker, Task& task) {
+		// The newest task from our own queue first...
+		{
+			WorkerQueue& own = *m_queues[worker];
+			std::lock_guard<std::mutex> lock(own.lock);
+			if (!own.tasks.empty()) {
+				task = std::move(own.tasks.back());
+				own.tasks.pop_back();
+				m_queued--;
+				return true;
+			}
+		}
+
+		// ... then the oldest task from whichever other worker has one
+		int queueCount = (int)m_queues.size();
+		for (int i = 1; i < queueCount; i++) {
+			WorkerQueue& other = *m_queues[(worker + i) % queueCount];
+			std::lock_guard<std::mutex> lock(other.lock);
+			if (!other.tasks.empty()) {
+				task = std::move(other.tasks.front());
+				other.tasks.pop_front();
+				m_queued--;
+				return true;
+			}
+		}
+		return false;
+	};
+
+	void ThreadPool::WorkerLoop(int worker) {
+		while (true) {
+			Task task;
+			if (TryTake(worker, task)) {
+				task(worker);
+
+				// The last task to finish wakes anyone waiting for the pool to go idle
+				if (m_pending.fetch_sub(1) == 1) {
+					std::lock_guard<std::mutex> lock(m_stateLock);
+					m_idle.notify_all();
+				}
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(m_stateLock);
+			m_workAvailable.wait(lock, [this]() { return m_stopping || m_queued > 0; });
+			if (m_stopping && m_queued == 0) {
+				return;
+			}
+		}
+	};
+}
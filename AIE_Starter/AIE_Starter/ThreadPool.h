@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace AIForGames {
+	// A fixed set of worker threads with a task queue each. A worker takes the newest task from its own queue,
+	// and when that runs dry it steals the oldest task from another worker's queue, so the load evens itself out however uneven the tasks are.
+	// Tasks are told which worker is running them (0 to GetThreadCount() - 1), so they can use per-worker scratch data without locking.
+	class ThreadPool
+	{
+	public:
+		typedef std::function<void(int worker)> Task;
+
+	private:
+		struct WorkerQueue {
+			std::mutex lock;
+			std::deque<Task> tasks;
+		};
+
+		std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+		std::vector<std::thread> m_threads;
+
+		// Tasks sitting in the queues, and tasks either queued or running
+		std::atomic<int> m_queued;
+		std::atomic<int> m_pending;
+		std::atomic<unsigned int> m_nextQueue;
+
+		std::mutex m_stateLock;
+		std::condition_variable m_workAvailable;
+		std::condition_variable m_idle;
+		bool m_stopping;
+
+		bool TryTake(int worker, Task& task);
+		void WorkerLoop(int worker);
+
+	public:
+		// Zero threads means one per hardware thread
+		ThreadPool(int threadCount = 0);
+
+		// Finishes every task already submitted, then joins the workers
+		~ThreadPool();
+
+		int GetThreadCount() const;
+
+		void Submit(Task task);
+		void Submit(std::vector<Task>& tasks);
+
+		// Block until every submitted task has finished
+		void Wait();
+	};
+}
@@ -0,0 +1,115 @@
+#include "TraceReplay.h"
+#include "NodeMap.h"
+#ifndef AIFG_HEADLESS
+#include "raylib.h"
+#endif
+#include <string>
+
+namespace AIForGames {
+	TraceReplay::TraceReplay() {
+		m_cursor = 0;
+		m_eventsPerSecond = 60.0f;
+		m_pendingEvents = 0.0f;
+		m_currentNode = -1;
+		m_found = false;
+	};
+
+	TraceReplay::~TraceReplay() {};
+
+	void TraceReplay::Start(const std::vector<TraceEvent>& events, int nodeCount) {
+		Stop();
+
+		// Only the last search is replayed, so find where it began
+		size_t first = events.size();
+		for (size_t i = events.size(); i > 0; i--) {
+			if (events[i - 1].type == TraceEventType::Begin) {
+				first = i - 1;
+				break;
+			}
+		}
+		if (first == events.size()) {
+			return;
+		}
+
+		m_events.assign(events.begin() + first, events.end());
+		m_nodeStates.assign(nodeCount, Untouched);
+	};
+
+	void TraceReplay::Stop() {
+		m_events.clear();
+		m_nodeStates.clear();
+		m_cursor = 0;
+		m_pendingEvents = 0.0f;
+		m_currentNode = -1;
+		m_found = false;
+	};
+
+	bool TraceReplay::IsPlaying() const {
+		return !m_events.empty();
+	};
+
+	void TraceReplay::SetSpeed(float eventsPerSecond) {
+		m_eventsPerSecond = eventsPerSecond;
+	};
+
+	void TraceReplay::Apply(const TraceEvent& event) {
+		// Ignore anything that doesn't belong on this map (e.g. a trace file recorded on a bigger one)
+		if (event.nodeId < 0 || event.nodeId >= (int)m_nodeStates.size()) {
+			return;
+		}
+
+		switch (event.type) {
+		case TraceEventType::Expand:
+			m_currentNode = event.nodeId;
+			break;
+		case TraceEventType::Push:
+			m_nodeStates[event.nodeId] = Opened;
+			break;
+		case TraceEventType::Close:
+			m_nodeStates[event.nodeId] = Closed;
+			break;
+		case TraceEventType::Found:
+			m_found = true;
+			break;
+		default:
+			break;
+		}
+	};
+
+	void TraceReplay::Update(float deltaTime) {
+		m_pendingEvents += m_eventsPerSecond * deltaTime;
+		while (m_pendingEvents >= 1.0f && m_cursor < m_events.size()) {
+			Apply(m_events[m_cursor]);
+			m_cursor++;
+			m_pendingEvents -= 1.0f;
+		}
+	};
+
+#ifndef AIFG_HEADLESS
+	void TraceReplay::Draw(NodeMap& map) {
+		if (!IsPlaying()) {
+			return;
+		}
+
+		Color openColour = { 0, 200, 0, 255 };
+		Color closedColour = { 120, 120, 0, 255 };
+		Color currentColour = { 255, 255, 255, 255 };
+
+		for (int id = 0; id < (int)m_nodeStates.size(); id++) {
+			Node* node = map.GetNodeById(id);
+			if (node == nullptr || m_nodeStates[id] == Untouched) {
+				continue;
+			}
+			DrawCircle((int)node->position.x, (int)node->position.y, 5, m_nodeStates[id] == Opened ? openColour : closedColour);
+		}
+
+		Node* current = m_currentNode >= 0 ? map.GetNodeById(m_currentNode) : nullptr;
+		if (current != nullptr) {
+			DrawCircle((int)current->position.x, (int)current->position.y, 7, currentColour);
+		}
+
+		std::string progress = "Replaying search: event " + std::to_string(m_cursor) + " of " + std::to_string(m_events.size()) + (m_found ? " (end found)" : "");
+		DrawText(progress.c_str(), 50, 400, 15, WHITE);
+	};
+#endif
+}
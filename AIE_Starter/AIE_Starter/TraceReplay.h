@@ -0,0 +1,49 @@
+#pragma once
+#include "SearchTrace.h"
+#include <cstddef>
+#include <vector>
+
+namespace AIForGames {
+	class NodeMap;
+
+	// Plays a recorded search trace back over the map in the raylib window, a few events per frame, so the search can be watched step by step.
+	// The events can come straight from SearchTrace::Global().Snapshot() or from a trace file written by SearchTrace::Save.
+	class TraceReplay
+	{
+		// What the replay has shown happening to each node so far, indexed by node id
+		enum NodeState : unsigned char { Untouched, Opened, Closed };
+
+		std::vector<TraceEvent> m_events;
+		std::vector<NodeState> m_nodeStates;
+		size_t m_cursor;
+
+		// Playback speed, and the part of an event left over from the last frame
+		float m_eventsPerSecond;
+		float m_pendingEvents;
+
+		int m_currentNode;
+		bool m_found;
+
+		// Apply one event to the node states
+		void Apply(const TraceEvent& event);
+
+	public:
+		TraceReplay();
+		~TraceReplay();
+
+		// Start replaying the most recent search in the events (everything from the last Begin event on), over a map with the given node count
+		void Start(const std::vector<TraceEvent>& events, int nodeCount);
+		void Stop();
+		bool IsPlaying() const;
+
+		void SetSpeed(float eventsPerSecond);
+
+		// Advance the replay by however many events fit into this frame
+		void Update(float deltaTime);
+
+#ifndef AIFG_HEADLESS
+		// Draw the open, closed and current nodes on top of the map
+		void Draw(NodeMap& map);
+#endif
+	};
+}